@@ -14,13 +14,25 @@
 #include "esp_err.h"
 #include "esp_log.h"
 #include "esp_check.h"
+#include "esp_timer.h"
 #include "esp_lcd_panel_io.h"
 #include "esp_lcd_touch.h"
+#include "esp_lcd_touch_cst820.h"
 
 #define POINT_NUM_MAX       (5)
 
 #define DATA_START_REG      (0x00)//(0x02)
 #define CHIP_ID_REG         (0xA7)
+#define SLEEP_MODE_REG      (0xE5)
+#define AUTO_SLEEP_TIME_REG (0xF9)
+#define DIS_AUTO_SLEEP_REG  (0xFE)
+
+#define SLEEP_MODE_DEEP     (0x03)
+
+/* Reset pulse and boot time when waking from deep or low-power sleep */
+#define WAKE_RESET_MS       (5)
+#define WAKE_POLL_MS        (5)
+#define WAKE_TIMEOUT_MS     (300)
 
 static const char *TAG = "CST820";
 
@@ -29,6 +41,7 @@ static bool get_xy(esp_lcd_touch_handle_t tp, uint16_t *x, uint16_t *y, uint16_t
 static esp_err_t del(esp_lcd_touch_handle_t tp);
 
 static esp_err_t i2c_read_bytes(esp_lcd_touch_handle_t tp, uint16_t reg, uint8_t *data, uint8_t len);
+static esp_err_t i2c_write_byte(esp_lcd_touch_handle_t tp, uint16_t reg, uint8_t data);
 
 static esp_err_t reset(esp_lcd_touch_handle_t tp);
 static esp_err_t read_id(esp_lcd_touch_handle_t tp);
@@ -167,7 +180,7 @@ static esp_err_t read_data(esp_lcd_touch_handle_t tp)
     portEXIT_CRITICAL(&tp->data.lock);
 
 
-    ESP_LOGE(TAG, "HF-IIC-read gs_id:%x f_num:%d state1:%x x:%d y:%d",gesture_id,point.num ,point.num,x, y);
+    ESP_LOGD(TAG, "HF-IIC-read gs_id:%x f_num:%d state1:%x x:%d y:%d",gesture_id,point.num ,point.num,x, y);
 
     return ESP_OK;
 }
@@ -210,6 +223,53 @@ static esp_err_t del(esp_lcd_touch_handle_t tp)
     return ESP_OK;
 }
 
+esp_err_t esp_lcd_touch_cst820_set_power(esp_lcd_touch_handle_t tp, esp_lcd_touch_cst820_power_t mode, uint8_t auto_sleep_s)
+{
+    ESP_RETURN_ON_FALSE(tp, ESP_ERR_INVALID_ARG, TAG, "Invalid touch handle");
+
+    switch (mode) {
+    case ESP_LCD_TOUCH_CST820_ACTIVE:
+        return i2c_write_byte(tp, DIS_AUTO_SLEEP_REG, 1);
+    case ESP_LCD_TOUCH_CST820_AUTO_SLEEP:
+        ESP_RETURN_ON_FALSE(auto_sleep_s, ESP_ERR_INVALID_ARG, TAG, "Invalid auto sleep time");
+        break;
+    case ESP_LCD_TOUCH_CST820_STANDBY:
+        auto_sleep_s = 1;
+        break;
+    case ESP_LCD_TOUCH_CST820_DEEP_SLEEP:
+        return i2c_write_byte(tp, SLEEP_MODE_REG, SLEEP_MODE_DEEP);
+    default:
+        return ESP_ERR_INVALID_ARG;
+    }
+    ESP_RETURN_ON_ERROR(i2c_write_byte(tp, AUTO_SLEEP_TIME_REG, auto_sleep_s), TAG, "I2C write failed");
+    return i2c_write_byte(tp, DIS_AUTO_SLEEP_REG, 0);
+}
+
+esp_err_t esp_lcd_touch_cst820_wake(esp_lcd_touch_handle_t tp, uint32_t *wake_us)
+{
+    ESP_RETURN_ON_FALSE(tp, ESP_ERR_INVALID_ARG, TAG, "Invalid touch handle");
+
+    int64_t start = esp_timer_get_time();
+    uint8_t id = 0;
+    esp_err_t ret = i2c_read_bytes(tp, CHIP_ID_REG, &id, 1);
+    if (ret != ESP_OK) {
+        /* Neither deep sleep nor low-power scanning answers I2C, only a reset wakes it from here */
+        ESP_RETURN_ON_FALSE(tp->config.rst_gpio_num != GPIO_NUM_NC, ESP_ERR_INVALID_STATE, TAG, "No reset line");
+        ESP_RETURN_ON_ERROR(gpio_set_level(tp->config.rst_gpio_num, tp->config.levels.reset), TAG, "GPIO set level failed");
+        vTaskDelay(pdMS_TO_TICKS(WAKE_RESET_MS));
+        ESP_RETURN_ON_ERROR(gpio_set_level(tp->config.rst_gpio_num, !tp->config.levels.reset), TAG, "GPIO set level failed");
+        for (int waited = 0; ret != ESP_OK && waited < WAKE_TIMEOUT_MS; waited += WAKE_POLL_MS) {
+            vTaskDelay(pdMS_TO_TICKS(WAKE_POLL_MS));
+            ret = i2c_read_bytes(tp, CHIP_ID_REG, &id, 1);
+        }
+        ESP_RETURN_ON_FALSE(ret == ESP_OK, ESP_ERR_TIMEOUT, TAG, "No answer after reset");
+    }
+    if (wake_us) {
+        *wake_us = (uint32_t)(esp_timer_get_time() - start);
+    }
+    return ESP_OK;
+}
+
 static esp_err_t reset(esp_lcd_touch_handle_t tp)
 {
     if (tp->config.rst_gpio_num != GPIO_NUM_NC) {
@@ -237,3 +297,8 @@ static esp_err_t i2c_read_bytes(esp_lcd_touch_handle_t tp, uint16_t reg, uint8_t
 
     return esp_lcd_panel_io_rx_param(tp->io, reg, data, len);
 }
+
+static esp_err_t i2c_write_byte(esp_lcd_touch_handle_t tp, uint16_t reg, uint8_t data)
+{
+    return esp_lcd_panel_io_tx_param(tp->io, reg, &data, 1);
+}
@@ -34,6 +34,51 @@ extern "C" {
  */
 esp_err_t esp_lcd_touch_new_i2c_cst820(const esp_lcd_panel_io_handle_t io, const esp_lcd_touch_config_t *config, esp_lcd_touch_handle_t *tp);
 
+/**
+ * @brief Power modes of the CST820
+ *
+ * In low-power scanning the controller samples the panel slowly and does not
+ * answer I2C; a touch brings it back to full-rate scanning and raises INT, so
+ * that touch is still reported. In deep sleep it neither scans nor drives INT.
+ */
+typedef enum {
+    ESP_LCD_TOUCH_CST820_ACTIVE = 0,    /*!< Scan at full rate, never drop to low-power scanning */
+    ESP_LCD_TOUCH_CST820_AUTO_SLEEP,    /*!< Low-power scanning after auto_sleep_s without a touch */
+    ESP_LCD_TOUCH_CST820_STANDBY,       /*!< Low-power scanning after the shortest delay the chip has, 1 s */
+    ESP_LCD_TOUCH_CST820_DEEP_SLEEP,    /*!< No scanning and no INT until esp_lcd_touch_cst820_wake() */
+} esp_lcd_touch_cst820_power_t;
+
+/**
+ * @brief Set the power mode
+ *
+ * @note  The controller must be answering I2C: call esp_lcd_touch_cst820_wake() first unless it is known to be
+ *        scanning at full rate.
+ *
+ * @param tp Touch panel handle
+ * @param mode Power mode
+ * @param auto_sleep_s Seconds without a touch before low-power scanning, 1 to 255; ESP_LCD_TOUCH_CST820_AUTO_SLEEP only
+ * @return
+ *      - ESP_OK: on success
+ *      - ESP_ERR_INVALID_ARG: auto_sleep_s out of range
+ *      - Otherwise: the I2C write failed
+ */
+esp_err_t esp_lcd_touch_cst820_set_power(esp_lcd_touch_handle_t tp, esp_lcd_touch_cst820_power_t mode, uint8_t auto_sleep_s);
+
+/**
+ * @brief Make sure the controller answers I2C again
+ *
+ * Returns at once when it already answers, e.g. because a touch woke it, so that touch is not lost. Otherwise pulses
+ * the reset line and waits until the controller answers; registers are back at their defaults then.
+ *
+ * @param tp Touch panel handle
+ * @param wake_us Time until the controller answered, may be NULL
+ * @return
+ *      - ESP_OK: on success
+ *      - ESP_ERR_INVALID_STATE: no answer and no reset line
+ *      - ESP_ERR_TIMEOUT: no answer after the reset
+ */
+esp_err_t esp_lcd_touch_cst820_wake(esp_lcd_touch_handle_t tp, uint32_t *wake_us);
+
 /**
  * @brief I2C address of the CST820 controller
  *
@@ -0,0 +1,208 @@
+/**
+ * @file assets.c
+ * @brief Fonts and images read in place from the "assets" partition
+ */
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+
+#include "assets.h"
+
+#if LV_FONT_FMT_TXT_LARGE
+#error "pack_assets.py writes the compact lv_font_fmt_txt_glyph_dsc_t"
+#endif
+
+_Static_assert(sizeof(assets_pack_header_t) == 16, "pack header layout");
+_Static_assert(sizeof(assets_pack_entry_t) == 32, "pack entry layout");
+_Static_assert(sizeof(assets_pack_font_t) == 28, "pack font layout");
+_Static_assert(sizeof(assets_pack_cmap_t) == 20, "pack cmap layout");
+_Static_assert(sizeof(assets_pack_kern_t) == 20, "pack kern layout");
+_Static_assert(sizeof(lv_font_fmt_txt_glyph_dsc_t) == 8, "glyph descriptor layout");
+_Static_assert(sizeof(lv_image_header_t) == 12, "image header layout");
+
+/* Everything LVGL needs besides the mapped tables, one allocation per font */
+typedef struct {
+    lv_font_t font;
+    lv_font_fmt_txt_dsc_t dsc;
+    union {
+        lv_font_fmt_txt_kern_pair_t pairs;
+        lv_font_fmt_txt_kern_classes_t classes;
+    } kern;
+    lv_font_fmt_txt_cmap_t cmaps[];
+} assets_font_obj_t;
+
+static const char *TAG = "assets";
+
+static const uint8_t *s_base = NULL;
+static const assets_pack_entry_t *s_entries = NULL;
+static uint16_t s_count = 0;
+/* Descriptor built on the first lookup of each entry, indexed like s_entries */
+static void **s_objs = NULL;
+
+esp_err_t assets_init(void)
+{
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ASSETS_PARTITION_SUBTYPE, "assets");
+    ESP_RETURN_ON_FALSE(part, ESP_ERR_NOT_FOUND, TAG, "no assets partition");
+
+    const void *map = NULL;
+    esp_partition_mmap_handle_t handle;
+    ESP_RETURN_ON_ERROR(esp_partition_mmap(part, 0, part->size, ESP_PARTITION_MMAP_DATA, &map, &handle), TAG,
+                        "mmap failed");
+
+    esp_err_t ret = ESP_OK;
+    const assets_pack_header_t *hdr = map;
+    ESP_GOTO_ON_FALSE(hdr->magic == ASSETS_PACK_MAGIC && hdr->version == ASSETS_PACK_VERSION, ESP_ERR_INVALID_VERSION,
+                      err, TAG, "no pack or version %u, flash build/assets.bin", hdr->version);
+    ESP_GOTO_ON_FALSE(hdr->size >= sizeof(*hdr) + hdr->count * sizeof(assets_pack_entry_t) && hdr->size <= part->size,
+                      ESP_ERR_INVALID_SIZE, err, TAG, "bad pack size %" PRIu32, hdr->size);
+    /* The tables are read straight from flash later, so check them once here */
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)map + sizeof(*hdr), hdr->size - sizeof(*hdr));
+    ESP_GOTO_ON_FALSE(crc == hdr->crc32, ESP_ERR_INVALID_CRC, err, TAG, "pack CRC mismatch");
+
+    s_objs = calloc(hdr->count, sizeof(void *));
+    ESP_GOTO_ON_FALSE(s_objs, ESP_ERR_NO_MEM, err, TAG, "no memory");
+    s_base = map;
+    s_entries = (const assets_pack_entry_t *)(hdr + 1);
+    s_count = hdr->count;
+    ESP_LOGI(TAG, "%u assets, %" PRIu32 " bytes mapped at %p", s_count, hdr->size, map);
+    return ESP_OK;
+
+err:
+    esp_partition_munmap(handle);
+    return ret;
+}
+
+static int entry_cmp(const void *key, const void *elem)
+{
+    return strncmp(key, ((const assets_pack_entry_t *)elem)->name, ASSETS_NAME_LEN);
+}
+
+static int find(const char *name, assets_type_t type)
+{
+    if (!s_entries) {
+        return -1;
+    }
+    const assets_pack_entry_t *e = bsearch(name, s_entries, s_count, sizeof(*s_entries), entry_cmp);
+    if (!e || e->type != type) {
+        return -1;
+    }
+    return e - s_entries;
+}
+
+static const void *blob_ptr(const uint8_t *blob, uint32_t offset)
+{
+    return offset ? blob + offset : NULL;
+}
+
+static assets_font_obj_t *build_font(const assets_pack_entry_t *e)
+{
+    const uint8_t *blob = s_base + e->offset;
+    const assets_pack_font_t *pf = (const assets_pack_font_t *)blob;
+    const assets_pack_cmap_t *pcmaps = blob_ptr(blob, pf->cmaps);
+
+    assets_font_obj_t *obj = heap_caps_calloc(1, sizeof(*obj) + pf->cmap_num * sizeof(obj->cmaps[0]),
+                                              MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!obj) {
+        return NULL;
+    }
+
+    for (int i = 0; i < pf->cmap_num; i++) {
+        obj->cmaps[i] = (lv_font_fmt_txt_cmap_t) {
+            .range_start = pcmaps[i].range_start,
+            .range_length = pcmaps[i].range_length,
+            .glyph_id_start = pcmaps[i].glyph_id_start,
+            .unicode_list = blob_ptr(blob, pcmaps[i].unicode_list),
+            .glyph_id_ofs_list = blob_ptr(blob, pcmaps[i].glyph_id_ofs_list),
+            .list_length = pcmaps[i].list_length,
+            .type = pcmaps[i].type,
+        };
+    }
+
+    const void *kern_dsc = NULL;
+    const assets_pack_kern_t *pk = blob_ptr(blob, pf->kern);
+    if (pk && pf->kern_type == 1) {
+        obj->kern.pairs = (lv_font_fmt_txt_kern_pair_t) {
+            .glyph_ids = blob_ptr(blob, pk->left),
+            .values = blob_ptr(blob, pk->values),
+            .pair_cnt = pk->pair_cnt,
+            .glyph_ids_size = pk->glyph_ids_size,
+        };
+        kern_dsc = &obj->kern.pairs;
+    } else if (pk && pf->kern_type == 2) {
+        obj->kern.classes = (lv_font_fmt_txt_kern_classes_t) {
+            .class_pair_values = blob_ptr(blob, pk->values),
+            .left_class_mapping = blob_ptr(blob, pk->left),
+            .right_class_mapping = blob_ptr(blob, pk->right),
+            .left_class_cnt = pk->left_class_cnt,
+            .right_class_cnt = pk->right_class_cnt,
+        };
+        kern_dsc = &obj->kern.classes;
+    }
+
+    obj->dsc = (lv_font_fmt_txt_dsc_t) {
+        .glyph_bitmap = blob_ptr(blob, pf->glyph_bitmap),
+        .glyph_dsc = blob_ptr(blob, pf->glyph_dsc),
+        .cmaps = obj->cmaps,
+        .kern_dsc = kern_dsc,
+        .kern_scale = pf->kern_scale,
+        .cmap_num = pf->cmap_num,
+        .bpp = pf->bpp,
+        .kern_classes = pf->kern_type == 2,
+        .bitmap_format = pf->bitmap_format,
+    };
+    obj->font = (lv_font_t) {
+        .get_glyph_dsc = lv_font_get_glyph_dsc_fmt_txt,
+        .get_glyph_bitmap = lv_font_get_bitmap_fmt_txt,
+        .line_height = pf->line_height,
+        .base_line = pf->base_line,
+        .subpx = LV_FONT_SUBPX_NONE,
+        .underline_position = pf->underline_position,
+        .underline_thickness = pf->underline_thickness,
+        .dsc = &obj->dsc,
+    };
+    return obj;
+}
+
+const lv_font_t *assets_font(const char *name)
+{
+    int i = find(name, ASSETS_TYPE_FONT);
+    if (i < 0) {
+        ESP_LOGE(TAG, "font %s not in the pack, using the default", name);
+        return LV_FONT_DEFAULT;
+    }
+    if (!s_objs[i]) {
+        s_objs[i] = build_font(&s_entries[i]);
+        if (!s_objs[i]) {
+            ESP_LOGE(TAG, "no memory for font %s", name);
+            return LV_FONT_DEFAULT;
+        }
+    }
+    return &((assets_font_obj_t *)s_objs[i])->font;
+}
+
+const lv_image_dsc_t *assets_image(const char *name)
+{
+    int i = find(name, ASSETS_TYPE_IMAGE);
+    if (i < 0) {
+        return NULL;
+    }
+    if (!s_objs[i]) {
+        const assets_pack_entry_t *e = &s_entries[i];
+        lv_image_dsc_t *img = heap_caps_calloc(1, sizeof(*img), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (!img) {
+            return NULL;
+        }
+        memcpy(&img->header, s_base + e->offset, sizeof(img->header));
+        img->data = s_base + e->offset + sizeof(img->header);
+        img->data_size = e->size - sizeof(img->header);
+        s_objs[i] = img;
+    }
+    return s_objs[i];
+}
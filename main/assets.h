@@ -0,0 +1,113 @@
+/**
+ * @file assets.h
+ * @brief Fonts and images read in place from the "assets" partition
+ * @details The partition holds an indexed pack built by tools/pack_assets.py
+ *          and is memory-mapped once. Glyph bitmaps, glyph descriptors,
+ *          character maps, kerning tables and pixel data stay in flash: only
+ *          the small LVGL descriptors pointing at them are allocated, on the
+ *          first lookup of each asset.
+ *
+ *          Pack layout, all little-endian:
+ *          - assets_pack_header_t
+ *          - assets_pack_entry_t[count], sorted by name
+ *          - the asset blobs, 4-byte aligned, offsets from the partition start
+ *
+ *          A font blob is an assets_pack_font_t followed by its tables, with
+ *          offsets from the start of the blob. An image blob is an
+ *          lv_image_header_t followed by the pixel data.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "lvgl.h"
+
+#define ASSETS_PARTITION_SUBTYPE 0x40
+#define ASSETS_PACK_MAGIC 0x41424E4B   /* "KNBA" */
+#define ASSETS_PACK_VERSION 1
+#define ASSETS_NAME_LEN 20
+
+typedef enum {
+    ASSETS_TYPE_FONT = 1,
+    ASSETS_TYPE_IMAGE = 2,
+} assets_type_t;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    uint32_t size;              /*!< Whole pack, header included */
+    uint32_t crc32;             /*!< Over everything after the header */
+} assets_pack_header_t;
+
+typedef struct {
+    char name[ASSETS_NAME_LEN]; /*!< NUL-padded */
+    uint8_t type;               /*!< assets_type_t */
+    uint8_t reserved[3];
+    uint32_t offset;
+    uint32_t size;
+} assets_pack_entry_t;
+
+typedef struct {
+    uint16_t line_height;
+    uint16_t base_line;
+    int8_t underline_position;
+    int8_t underline_thickness;
+    uint8_t bpp;
+    uint8_t bitmap_format;      /*!< lv_font_fmt_txt_bitmap_format_t */
+    uint16_t kern_scale;
+    uint8_t kern_type;          /*!< 0 none, 1 pairs, 2 classes */
+    uint8_t cmap_num;
+    uint32_t glyph_bitmap;
+    uint32_t glyph_dsc;         /*!< lv_font_fmt_txt_glyph_dsc_t[] */
+    uint32_t cmaps;             /*!< assets_pack_cmap_t[cmap_num] */
+    uint32_t kern;              /*!< assets_pack_kern_t, 0 without kerning */
+} assets_pack_font_t;
+
+typedef struct {
+    uint32_t range_start;
+    uint16_t range_length;
+    uint16_t glyph_id_start;
+    uint32_t unicode_list;      /*!< 0 if none */
+    uint32_t glyph_id_ofs_list; /*!< 0 if none */
+    uint16_t list_length;
+    uint8_t type;               /*!< lv_font_fmt_txt_cmap_type_t */
+    uint8_t reserved;
+} assets_pack_cmap_t;
+
+typedef struct {
+    uint32_t values;            /*!< Pair values or class pair values */
+    uint32_t left;              /*!< Pair glyph ids or left class mapping */
+    uint32_t right;             /*!< Right class mapping, 0 for pairs */
+    uint32_t pair_cnt;
+    uint8_t left_class_cnt;
+    uint8_t right_class_cnt;
+    uint8_t glyph_ids_size;     /*!< 0: uint8_t ids, 1: uint16_t ids */
+    uint8_t reserved;
+} assets_pack_kern_t;
+
+/**
+ * @brief Map the assets partition and check the pack
+ *
+ * @return ESP_ERR_NOT_FOUND without the partition, ESP_ERR_INVALID_VERSION or
+ *         ESP_ERR_INVALID_CRC for a pack that does not match this firmware or
+ *         is damaged. Lookups then fall back, see below.
+ */
+esp_err_t assets_init(void);
+
+/**
+ * @brief Font by name, as packed from the generated ui_font_*.c
+ *
+ * @return Never NULL: LV_FONT_DEFAULT if the font is missing, so a bad pack
+ *         still leaves a readable UI.
+ */
+const lv_font_t *assets_font(const char *name);
+
+/**
+ * @brief Image by name
+ *
+ * @return NULL if missing
+ */
+const lv_image_dsc_t *assets_image(const char *name);
@@ -0,0 +1,111 @@
+/**
+ * @file cell_grid.c
+ * @brief Grid of fixed-size text cells with one selected cell
+ */
+
+#include "cell_grid.h"
+
+/* Longest formatted cell text */
+#define CELL_GRID_TEXT_MAX 16
+
+void cell_grid_cell_area(lv_obj_t *obj, const cell_grid_t *grid, uint16_t index, lv_area_t *area)
+{
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+    area->x1 = coords.x1 + (index % grid->columns) * grid->cell_w;
+    area->y1 = coords.y1 + (index / grid->columns - grid->top_row) * grid->cell_h;
+    area->x2 = area->x1 + grid->cell_w - 1;
+    area->y2 = area->y1 + grid->cell_h - 1;
+}
+
+void cell_grid_invalidate_cell(lv_obj_t *obj, const cell_grid_t *grid, uint16_t index)
+{
+    lv_area_t area;
+    cell_grid_cell_area(obj, grid, index, &area);
+    lv_obj_invalidate_area(obj, &area);
+}
+
+static void draw_event_cb(lv_event_t *e)
+{
+    lv_obj_t *obj = lv_event_get_target(e);
+    const cell_grid_t *grid = lv_event_get_user_data(e);
+    lv_layer_t *layer = lv_event_get_layer(e);
+
+    lv_draw_label_dsc_t label;
+    lv_draw_label_dsc_init(&label);
+    lv_obj_init_draw_label_dsc(obj, LV_PART_MAIN, &label);
+    label.font = grid->font;
+    label.align = LV_TEXT_ALIGN_CENTER;
+    lv_draw_label_dsc_t label_sel = label;
+    label_sel.color = lv_obj_get_style_text_color(obj, LV_PART_SELECTED);
+
+    /* Cells outside the invalidated area are clipped away by the draw layer */
+    uint16_t first = grid->top_row * grid->columns;
+    uint16_t last = LV_MIN(grid->count, first + grid->rows * grid->columns);
+    for (uint16_t i = first; i < last; i++) {
+        lv_area_t area;
+        cell_grid_cell_area(obj, grid, i, &area);
+        if (i == grid->selected) {
+            lv_draw_rect_dsc_t rect;
+            lv_draw_rect_dsc_init(&rect);
+            lv_obj_init_draw_rect_dsc(obj, LV_PART_SELECTED, &rect);
+            lv_draw_rect(layer, &rect, &area);
+        }
+        char buf[CELL_GRID_TEXT_MAX];
+        lv_draw_label_dsc_t *dsc = i == grid->selected ? &label_sel : &label;
+        dsc->text = grid->text_cb(grid, i, buf, sizeof(buf));
+        /* The draw task outlives buf */
+        dsc->text_local = dsc->text == buf;
+        lv_area_t text_area = area;
+        text_area.y1 += CELL_GRID_PAD_VER;
+        lv_draw_label(layer, dsc, &text_area);
+    }
+}
+
+static void delete_event_cb(lv_event_t *e)
+{
+    lv_free(lv_event_get_user_data(e));
+}
+
+lv_obj_t *cell_grid_create(lv_obj_t *parent, cell_grid_t *grid)
+{
+    lv_obj_t *obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(obj);
+    lv_obj_set_size(obj, grid->cell_w * grid->columns, grid->cell_h * grid->rows);
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_text_color(obj, lv_palette_main(LV_PALETTE_GREY), LV_PART_MAIN);
+    lv_obj_set_style_bg_color(obj, lv_palette_main(LV_PALETTE_BLUE), LV_PART_SELECTED);
+    lv_obj_set_style_bg_opa(obj, LV_OPA_COVER, LV_PART_SELECTED);
+    lv_obj_set_style_radius(obj, 6, LV_PART_SELECTED);
+    lv_obj_set_style_text_color(obj, lv_color_white(), LV_PART_SELECTED);
+    lv_obj_add_event_cb(obj, draw_event_cb, LV_EVENT_DRAW_MAIN, grid);
+    lv_obj_add_event_cb(obj, delete_event_cb, LV_EVENT_DELETE, grid);
+    lv_obj_set_user_data(obj, grid);
+    return obj;
+}
+
+void cell_grid_set_selected(lv_obj_t *obj, cell_grid_t *grid, uint16_t index)
+{
+    if (index >= grid->count || index == grid->selected) {
+        return;
+    }
+
+    uint16_t row = index / grid->columns;
+    uint16_t top_row = grid->top_row;
+    if (row < top_row) {
+        top_row = row;
+    } else if (row >= top_row + grid->rows) {
+        top_row = row - grid->rows + 1;
+    }
+
+    if (top_row != grid->top_row) {
+        /* Every visible cell shows another item */
+        grid->top_row = top_row;
+        grid->selected = index;
+        lv_obj_invalidate(obj);
+        return;
+    }
+    cell_grid_invalidate_cell(obj, grid, grid->selected);
+    grid->selected = index;
+    cell_grid_invalidate_cell(obj, grid, index);
+}
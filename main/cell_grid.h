@@ -0,0 +1,63 @@
+/**
+ * @file cell_grid.h
+ * @brief Grid of fixed-size text cells with one selected cell
+ * @details The common part of item_picker and zone_strip. The widget draws
+ *          the visible rows of a grid itself, asking for the text of each
+ *          cell while drawing, so a change invalidates only the cells it
+ *          affects. The window moves by whole rows when the selection leaves
+ *          it.
+ *
+ *          Cells use the font of the grid and the text_color of
+ *          LV_PART_MAIN; the selected cell uses the background, radius and
+ *          text colour of LV_PART_SELECTED.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lvgl.h"
+
+/* Space above the text of a cell; include it twice in cell_h */
+#define CELL_GRID_PAD_VER 4
+
+typedef struct cell_grid cell_grid_t;
+
+/**
+ * @brief Text of one cell, either static or formatted into buf
+ */
+typedef const char *(*cell_grid_text_cb_t)(const cell_grid_t *grid, uint16_t index, char *buf, size_t size);
+
+/**
+ * Embed as the first member of the widget state, so the text callback can
+ * cast back to it. Fill in everything but selected and top_row.
+ */
+struct cell_grid {
+    const lv_font_t *font;
+    cell_grid_text_cb_t text_cb;
+    uint16_t count;
+    uint16_t selected;
+    uint16_t top_row;
+    uint8_t columns;
+    uint8_t rows;           /*!< Visible rows */
+    int32_t cell_w;
+    int32_t cell_h;
+};
+
+/**
+ * @brief Create the object showing grid
+ *
+ * grid must come from lv_malloc() and is freed with the object. The object
+ * is neither clickable nor scrollable.
+ */
+lv_obj_t *cell_grid_create(lv_obj_t *parent, cell_grid_t *grid);
+
+void cell_grid_cell_area(lv_obj_t *obj, const cell_grid_t *grid, uint16_t index, lv_area_t *area);
+
+void cell_grid_invalidate_cell(lv_obj_t *obj, const cell_grid_t *grid, uint16_t index);
+
+/**
+ * @brief Select a cell, scrolling the window if it is not visible
+ */
+void cell_grid_set_selected(lv_obj_t *obj, cell_grid_t *grid, uint16_t index);
@@ -0,0 +1,41 @@
+/**
+ * @file click_recognizer.c
+ * @brief Multi-click recognition without a wait for the series to end
+ */
+
+#include "click_recognizer.h"
+
+void click_recognizer_init(click_recognizer_t *rec, int64_t gap_us)
+{
+    rec->gap_us = gap_us;
+    rec->last_us = 0;
+    rec->count = 0;
+}
+
+click_action_t click_recognizer_click(click_recognizer_t *rec, int64_t now_us, bool multi)
+{
+    if (!rec->count || now_us - rec->last_us > rec->gap_us) {
+        rec->count = 0;
+    }
+    rec->last_us = now_us;
+
+    if (!multi) {
+        if (rec->count) {
+            /* Tail of a series whose triple click left the multi-click context */
+            rec->count++;
+            return CLICK_ACTION_NONE;
+        }
+        return CLICK_ACTION_SINGLE;
+    }
+
+    switch (++rec->count) {
+    case 1:
+        return CLICK_ACTION_SINGLE;
+    case 2:
+        return CLICK_ACTION_UNDO_SINGLE;
+    case 3:
+        return CLICK_ACTION_TRIPLE;
+    default:
+        return CLICK_ACTION_NONE;
+    }
+}
@@ -0,0 +1,45 @@
+/**
+ * @file click_recognizer.h
+ * @brief Multi-click recognition without a wait for the series to end
+ * @details The single-click action is taken on the first click. If a second
+ *          click follows within the gap, the first one is undone, and the
+ *          third carries out the triple-click action. Further clicks in the
+ *          same series do nothing. A series ends once the gap passes with no
+ *          click.
+ *
+ *          This only works where the single action can be undone, such as
+ *          toggling the lock. Where no multi-click is defined, every click is
+ *          reported as a single one right away.
+ *
+ *          Pure logic with the time passed in: no timers, no RTOS.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    CLICK_ACTION_NONE,
+    CLICK_ACTION_SINGLE,
+    CLICK_ACTION_UNDO_SINGLE,   /*!< Revert the single action taken for the first click */
+    CLICK_ACTION_TRIPLE,
+} click_action_t;
+
+typedef struct {
+    int64_t gap_us;
+    int64_t last_us;
+    int count;
+} click_recognizer_t;
+
+/**
+ * @param gap_us Longest pause between two clicks of one series
+ */
+void click_recognizer_init(click_recognizer_t *rec, int64_t gap_us);
+
+/**
+ * @brief Feed one click and get the action to take now
+ *
+ * @param multi  The current context defines a triple click
+ */
+click_action_t click_recognizer_click(click_recognizer_t *rec, int64_t now_us, bool multi);
@@ -0,0 +1,86 @@
+/**
+ * @file ctl_frame.c
+ * @brief Framing of the control link: COBS over payload and CRC-32
+ */
+
+#include "esp_rom_crc.h"
+
+#include "ctl_frame.h"
+
+size_t ctl_frame_seal(uint8_t *payload, size_t len)
+{
+    uint32_t crc = esp_rom_crc32_le(0, payload, len);
+    for (int i = 0; i < CTL_FRAME_CRC_LEN; i++) {
+        payload[len + i] = crc >> (8 * i);
+    }
+    return len + CTL_FRAME_CRC_LEN;
+}
+
+size_t ctl_frame_encoded_len(const uint8_t *src, size_t len)
+{
+    size_t out = 1 + len;
+    uint8_t run = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (src[i] == 0) {
+            run = 0;
+        } else if (++run == 0xFE) {
+            out++;
+            run = 0;
+        }
+    }
+    return out;
+}
+
+size_t ctl_frame_encode(const uint8_t *src, size_t len, uint8_t *dst)
+{
+    size_t code_pos = 0;
+    size_t out = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < len; i++) {
+        if (src[i] != 0) {
+            dst[out++] = src[i];
+            code++;
+        }
+        if (src[i] == 0 || code == 0xFF) {
+            dst[code_pos] = code;
+            code_pos = out++;
+            code = 1;
+        }
+    }
+    dst[code_pos] = code;
+    return out;
+}
+
+/* In place; returns 0 for a malformed frame */
+static size_t cobs_decode(uint8_t *buf, size_t len)
+{
+    size_t in = 0;
+    size_t out = 0;
+    while (in < len) {
+        uint8_t code = buf[in++];
+        if (code == 0 || in + code - 1 > len) {
+            return 0;
+        }
+        for (uint8_t i = 1; i < code; i++) {
+            buf[out++] = buf[in++];
+        }
+        if (code < 0xFF && in < len) {
+            buf[out++] = 0;
+        }
+    }
+    return out;
+}
+
+size_t ctl_frame_open(uint8_t *buf, size_t len, size_t min_payload)
+{
+    len = cobs_decode(buf, len);
+    if (len < min_payload + CTL_FRAME_CRC_LEN) {
+        return 0;
+    }
+    len -= CTL_FRAME_CRC_LEN;
+    uint32_t crc = buf[len] | buf[len + 1] << 8 | buf[len + 2] << 16 | (uint32_t)buf[len + 3] << 24;
+    if (esp_rom_crc32_le(0, buf, len) != crc) {
+        return 0;
+    }
+    return len;
+}
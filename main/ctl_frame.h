@@ -0,0 +1,46 @@
+/**
+ * @file ctl_frame.h
+ * @brief Framing of the control link: COBS over payload and CRC-32
+ * @details A frame on the wire is COBS(payload, CRC-32) followed by 0x00,
+ *          see ctl_link.h. The CRC is the zlib one over the payload,
+ *          little-endian.
+ *
+ *          Pure byte handling without RTOS dependencies, so the host tests
+ *          in sim/test build it as is.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CTL_FRAME_CRC_LEN 4
+
+/**
+ * @brief Append the CRC-32 of payload[0..len)
+ *
+ * @return len + CTL_FRAME_CRC_LEN; payload must have room for the CRC
+ */
+size_t ctl_frame_seal(uint8_t *payload, size_t len);
+
+/**
+ * @brief Length of the COBS encoding of src, without the delimiter
+ */
+size_t ctl_frame_encoded_len(const uint8_t *src, size_t len);
+
+/**
+ * @brief COBS-encode src into dst, which holds ctl_frame_encoded_len() bytes
+ *
+ * @return Bytes written, without the delimiter
+ */
+size_t ctl_frame_encode(const uint8_t *src, size_t len, uint8_t *dst);
+
+/**
+ * @brief Decode a received frame in place and check its CRC
+ *
+ * @param buf         Bytes between two delimiters
+ * @param min_payload Shortest valid payload, at least 1
+ * @return Payload length without the CRC, 0 for a malformed frame, a bad
+ *         CRC or a payload shorter than min_payload
+ */
+size_t ctl_frame_open(uint8_t *buf, size_t len, size_t min_payload);
@@ -0,0 +1,313 @@
+/**
+ * @file ctl_link.c
+ * @brief Binary control and telemetry link on USB-Serial-JTAG
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/ringbuf.h"
+#include "freertos/task.h"
+#include "driver/usb_serial_jtag.h"
+#include "esp_check.h"
+#include "esp_console.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "ctl_frame.h"
+#include "ctl_link.h"
+#include "fan.h"
+#include "settings.h"
+#include "task_topology.h"
+#include "ui.h"
+
+#define CTL_LINK_PING 0x01
+#define CTL_LINK_GET_STATE 0x02
+#define CTL_LINK_SET_SPEED 0x03
+#define CTL_LINK_SET_LOCK 0x04
+#define CTL_LINK_GET_SETTINGS 0x05
+#define CTL_LINK_STREAM 0x06
+#define CTL_LINK_CLOSE 0x07
+#define CTL_LINK_REPLY 0x80
+#define CTL_LINK_TELEMETRY 0xC0
+
+/* Type, sequence, body, CRC-32 */
+#define CTL_LINK_MAX_BODY 64
+#define CTL_LINK_MAX_PAYLOAD (2 + CTL_LINK_MAX_BODY + 4)
+/* COBS adds one byte per 254, plus the delimiter */
+#define CTL_LINK_MAX_FRAME (CTL_LINK_MAX_PAYLOAD + CTL_LINK_MAX_PAYLOAD / 254 + 2)
+/* About 100 ms of telemetry at 1 kHz with four zones */
+#define CTL_LINK_TX_BUF_SIZE 4096
+#define CTL_LINK_RX_CHUNK 64
+#define CTL_LINK_OWNER_MAX 32
+
+static const char *TAG = "ctl_link";
+
+static struct {
+    RingbufHandle_t tx;
+    TaskHandle_t tx_task;
+    /* Set by the console task, sampled by the TX task; 0 is off */
+    volatile uint32_t telemetry_period_us;
+    /* Bumped by every STREAM request, restarts the counters */
+    volatile uint32_t telemetry_gen;
+    uint16_t telemetry_seq;
+    uint16_t telemetry_dropped;
+} s_link;
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    put_u16(p, v & 0xFFFF);
+    put_u16(p + 2, v >> 16);
+}
+
+/* Encode straight into the ring buffer; the TX task hands the item to the driver as is */
+static esp_err_t send_frame(uint8_t type, uint8_t seq, const uint8_t *body, size_t body_len, TickType_t wait)
+{
+    uint8_t payload[CTL_LINK_MAX_PAYLOAD];
+    payload[0] = type;
+    payload[1] = seq;
+    memcpy(&payload[2], body, body_len);
+    size_t len = ctl_frame_seal(payload, 2 + body_len);
+
+    size_t encoded = ctl_frame_encoded_len(payload, len);
+    uint8_t *item = NULL;
+    if (xRingbufferSendAcquire(s_link.tx, (void **)&item, encoded + 1, wait) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    ctl_frame_encode(payload, len, item);
+    item[encoded] = 0;
+    xRingbufferSendComplete(s_link.tx, item);
+    return ESP_OK;
+}
+
+static size_t put_state(uint8_t *p)
+{
+    ui_state_t state;
+    ui_get_state(&state);
+    p[0] = state.screen;
+    p[1] = state.locked ? 1 : 0;
+    p[2] = state.zone_selected;
+    p[3] = state.zone_count;
+    memcpy(&p[4], state.percent, state.zone_count);
+    return 4 + state.zone_count;
+}
+
+/* TX task; never waits for buffer space */
+static void send_telemetry(void)
+{
+    uint8_t body[8 + 4 + FAN_ZONE_MAX * 3];
+    put_u16(&body[0], s_link.telemetry_seq++);
+    put_u16(&body[2], s_link.telemetry_dropped);
+    put_u32(&body[4], (uint32_t)esp_timer_get_time());
+    size_t len = 8 + put_state(&body[8]);
+    for (int i = 0; i < fan_zone_count(); i++) {
+        put_u16(&body[len], fan_get_duty(i));
+        len += 2;
+    }
+    if (send_frame(CTL_LINK_TELEMETRY, 0, body, len, 0) != ESP_OK) {
+        s_link.telemetry_dropped++;
+    }
+}
+
+/* Sends what the ring buffer holds and samples telemetry in between, so the
+ * stream stays off the esp_timer task that runs the knob and the buttons */
+static void tx_task(void *arg)
+{
+    uint32_t gen = 0;
+    int64_t next_us = 0;
+    const int64_t tick_us = portTICK_PERIOD_MS * 1000;
+
+    while (1) {
+        TickType_t wait = portMAX_DELAY;
+        uint32_t period_us = s_link.telemetry_period_us;
+        if (period_us) {
+            int64_t now = esp_timer_get_time();
+            if (gen != s_link.telemetry_gen) {
+                gen = s_link.telemetry_gen;
+                s_link.telemetry_seq = 0;
+                s_link.telemetry_dropped = 0;
+                next_us = now;
+            }
+            if (now >= next_us) {
+                send_telemetry();
+                /* Samples missed behind a slow USB write are skipped, not sent late */
+                next_us += period_us;
+                if (next_us <= now) {
+                    next_us = now + period_us;
+                }
+            }
+            wait = (next_us - now + tick_us - 1) / tick_us;
+        }
+
+        size_t size = 0;
+        uint8_t *item = xRingbufferReceive(s_link.tx, &size, wait);
+        if (item) {
+            usb_serial_jtag_write_bytes(item, size, pdMS_TO_TICKS(20));
+            vRingbufferReturnItem(s_link.tx, item);
+        }
+    }
+}
+
+/* The reply to STREAM wakes the TX task, which picks the new period up */
+static uint8_t set_stream(uint32_t period_us)
+{
+    if (period_us != 0 && period_us < CTL_LINK_MIN_PERIOD_US) {
+        s_link.telemetry_period_us = 0;
+        return CTL_LINK_ERR_ARG;
+    }
+    s_link.telemetry_gen++;
+    s_link.telemetry_period_us = period_us;
+    return CTL_LINK_OK;
+}
+
+/* Returns true when the host closed the link */
+static bool handle_request(const uint8_t *payload, size_t len)
+{
+    uint8_t type = payload[0];
+    const uint8_t *body = &payload[2];
+    size_t body_len = len - 2;
+    uint8_t reply[CTL_LINK_MAX_BODY];
+    size_t reply_len = 1;
+    uint8_t status = CTL_LINK_OK;
+
+    switch (type) {
+    case CTL_LINK_PING:
+        reply[1] = CTL_LINK_VERSION;
+        reply[2] = fan_zone_count();
+        reply_len = 3;
+        break;
+    case CTL_LINK_GET_STATE:
+        reply_len += put_state(&reply[1]);
+        break;
+    case CTL_LINK_SET_SPEED:
+        if (body_len != 2) {
+            status = CTL_LINK_ERR_LENGTH;
+        } else if (ui_set_fan_speed(body[0], body[1]) != ESP_OK) {
+            status = CTL_LINK_ERR_ARG;
+        }
+        break;
+    case CTL_LINK_SET_LOCK:
+        if (body_len != 1) {
+            status = CTL_LINK_ERR_LENGTH;
+        } else if (body[0] > 1) {
+            status = CTL_LINK_ERR_ARG;
+        } else {
+            ui_set_locked(body[0]);
+        }
+        break;
+    case CTL_LINK_GET_SETTINGS: {
+        /* What is stored, not what is being edited on screen */
+        uint8_t lang = 0;
+        char owner[CTL_LINK_OWNER_MAX] = "";
+        settings_load(&lang, UINT8_MAX, owner, sizeof(owner));
+        size_t owner_len = strnlen(owner, sizeof(owner) - 1);
+        reply[1] = lang;
+        reply[2] = owner_len;
+        memcpy(&reply[3], owner, owner_len);
+        reply_len = 3 + owner_len;
+        break;
+    }
+    case CTL_LINK_STREAM:
+        if (body_len != 4) {
+            status = CTL_LINK_ERR_LENGTH;
+        } else {
+            status = set_stream(body[0] | body[1] << 8 | body[2] << 16 | (uint32_t)body[3] << 24);
+        }
+        break;
+    case CTL_LINK_CLOSE:
+        break;
+    default:
+        status = CTL_LINK_ERR_TYPE;
+        break;
+    }
+    reply[0] = status;
+    send_frame(type | CTL_LINK_REPLY, payload[1], reply, reply_len, pdMS_TO_TICKS(100));
+    return type == CTL_LINK_CLOSE;
+}
+
+static void run_session(void)
+{
+    uint8_t frame[CTL_LINK_MAX_FRAME];
+    size_t frame_len = 0;
+    bool overflow = false;
+    int64_t last_valid_us = esp_timer_get_time();
+
+    while (esp_timer_get_time() - last_valid_us < CTL_LINK_IDLE_MS * 1000LL) {
+        uint8_t chunk[CTL_LINK_RX_CHUNK];
+        int n = usb_serial_jtag_read_bytes(chunk, sizeof(chunk), pdMS_TO_TICKS(100));
+        for (int i = 0; i < n; i++) {
+            if (chunk[i] != 0) {
+                if (frame_len < sizeof(frame)) {
+                    frame[frame_len++] = chunk[i];
+                } else {
+                    overflow = true;
+                }
+                continue;
+            }
+            /* Delimiter: console text and damaged frames fail the checks below */
+            size_t len = overflow ? 0 : ctl_frame_open(frame, frame_len, 2);
+            frame_len = 0;
+            overflow = false;
+            if (!len) {
+                continue;
+            }
+            last_valid_us = esp_timer_get_time();
+            if (handle_request(frame, len)) {
+                return;
+            }
+        }
+    }
+}
+
+static esp_err_t link_setup(void)
+{
+    if (!s_link.tx) {
+        s_link.tx = xRingbufferCreate(CTL_LINK_TX_BUF_SIZE, RINGBUF_TYPE_NOSPLIT);
+        ESP_RETURN_ON_FALSE(s_link.tx, ESP_ERR_NO_MEM, TAG, "no memory for the TX buffer");
+    }
+
+    BaseType_t res = xTaskCreatePinnedToCore(tx_task, "ctl_link_tx", TASK_CTL_LINK_TX_STACK, NULL,
+                                             TASK_CTL_LINK_TX_PRIORITY, &s_link.tx_task, TASK_CTL_LINK_TX_CORE);
+    ESP_RETURN_ON_FALSE(res == pdPASS, ESP_ERR_NO_MEM, TAG, "Create task failed");
+    return ESP_OK;
+}
+
+static int log_discard(const char *fmt, va_list args)
+{
+    return 0;
+}
+
+static int cmd_link(int argc, char **argv)
+{
+    if (!s_link.tx_task && link_setup() != ESP_OK) {
+        printf("no memory\n");
+        return 1;
+    }
+    printf("binary link, CLOSE or %d ms of silence returns here\n", CTL_LINK_IDLE_MS);
+    fflush(stdout);
+    /* Log lines would cost the host resyncs; swallowing them keeps per-tag levels */
+    vprintf_like_t log_vprintf = esp_log_set_vprintf(log_discard);
+    run_session();
+    s_link.telemetry_period_us = 0;
+    esp_log_set_vprintf(log_vprintf);
+    printf("link closed\n");
+    return 0;
+}
+
+esp_err_t ctl_link_register_console(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "link",
+        .help = "Binary control and telemetry link for tools/ctl_link.py",
+        .func = cmd_link,
+    };
+    return esp_console_cmd_register(&cmd);
+}
@@ -0,0 +1,64 @@
+/**
+ * @file ctl_link.h
+ * @brief Binary control and telemetry link on USB-Serial-JTAG
+ * @details The console command "link" hands the port to a framed binary
+ *          protocol until the host closes it or stays silent for
+ *          CTL_LINK_IDLE_MS; the REPL takes over again afterwards. The host
+ *          side is tools/ctl_link.py.
+ *
+ *          A frame is COBS(payload, CRC-32) followed by 0x00. The CRC is
+ *          the zlib one over the payload, little-endian; payload is a type
+ *          byte, a sequence byte and the body. The device answers every
+ *          request with type | 0x80, the request's sequence byte and a
+ *          status byte (ctl_link_status_t) before any data:
+ *
+ *          | Request          | Body                   | Reply data                         |
+ *          |------------------|------------------------|------------------------------------|
+ *          | 0x01 PING        |                        | version, zone count                |
+ *          | 0x02 GET_STATE   |                        | ui_state_t fields, see STATE below |
+ *          | 0x03 SET_SPEED   | zone, percent          |                                    |
+ *          | 0x04 SET_LOCK    | 0 or 1                 |                                    |
+ *          | 0x05 GET_SETTINGS|                        | language, name length, name        |
+ *          | 0x06 STREAM      | period_us (u32, 0 off) |                                    |
+ *          | 0x07 CLOSE       |                        |                                    |
+ *
+ *          STATE is screen, flags (bit 0 locked), selected zone, zone count,
+ *          then one percent per zone. A telemetry frame (0xC0, sequence 0)
+ *          carries a u16 sample counter, a u16 count of samples dropped for
+ *          lack of buffer, a u32 timestamp in us, STATE, and then the LEDC
+ *          duty of every zone as u16.
+ *
+ *          Nothing here takes the LVGL port lock: telemetry and readback
+ *          copy ui_get_state(), which may catch a change half applied, and
+ *          read the fan duty registers; SET_SPEED and SET_LOCK hand the
+ *          change to the UI, which applies it on the esp_timer task.
+ *          Telemetry is sampled by the link's TX task between writes, so
+ *          the stream never delays the knob and button callbacks.
+ *          Framing is in ctl_frame.h.
+ *          Frames are COBS-encoded straight into a no-split ring buffer and
+ *          handed from there to the USB driver, without another copy.
+ */
+
+#pragma once
+
+#include "esp_err.h"
+
+#define CTL_LINK_VERSION 1
+/* Without any valid frame from the host for this long, the REPL returns */
+#define CTL_LINK_IDLE_MS 3000
+/* Fastest telemetry rate, 1 kHz: the TX task samples it and waits in ticks */
+#define CTL_LINK_MIN_PERIOD_US 1000
+
+typedef enum {
+    CTL_LINK_OK = 0,
+    CTL_LINK_ERR_ARG = 1,       /*!< Value out of range */
+    CTL_LINK_ERR_LENGTH = 2,    /*!< Body too short or too long */
+    CTL_LINK_ERR_TYPE = 3,      /*!< Unknown request */
+} ctl_link_status_t;
+
+/**
+ * @brief Add the "link" command to the console
+ *
+ * @note Call once the console REPL exists.
+ */
+esp_err_t ctl_link_register_console(void);
@@ -0,0 +1,218 @@
+/**
+ * @file digit_display.c
+ * @brief Numeric readout blitted from a glyph atlas
+ */
+
+#include <string.h>
+
+#include "esp_heap_caps.h"
+
+#include "digit_display.h"
+
+#define DIGIT_DISPLAY_MAX_DIGITS 3
+#define DIGIT_DISPLAY_MAX_CELLS (DIGIT_DISPLAY_MAX_DIGITS + 1)
+#define GLYPH_PERCENT 10
+#define GLYPH_COUNT 11
+#define GLYPH_NONE 0xFF
+
+typedef struct {
+    uint8_t *atlas;
+    lv_image_dsc_t glyphs[GLYPH_COUNT];
+    int32_t digit_w;
+    int32_t percent_w;
+    int32_t cell_h;
+    int32_t value;
+    uint8_t cells[DIGIT_DISPLAY_MAX_CELLS];
+    uint8_t cell_count;
+} digit_display_t;
+
+static int32_t glyph_width(const digit_display_t *dd, uint8_t glyph)
+{
+    return glyph == GLYPH_PERCENT ? dd->percent_w : dd->digit_w;
+}
+
+/* Render one glyph through the normal label path and keep only its coverage */
+static void rasterise_glyph(digit_display_t *dd, lv_obj_t *canvas, lv_draw_buf_t *scratch,
+                            const lv_font_t *font, uint8_t glyph, int32_t atlas_x, uint32_t atlas_stride)
+{
+    static const char *const glyph_text[GLYPH_COUNT] = {
+        "0", "1", "2", "3", "4", "5", "6", "7", "8", "9", "%",
+    };
+    int32_t w = glyph_width(dd, glyph);
+
+    lv_draw_buf_clear(scratch, NULL);
+    lv_layer_t layer;
+    lv_canvas_init_layer(canvas, &layer);
+    lv_draw_label_dsc_t label;
+    lv_draw_label_dsc_init(&label);
+    label.text = glyph_text[glyph];
+    label.font = font;
+    label.color = lv_color_white();
+    label.align = LV_TEXT_ALIGN_CENTER;
+    lv_area_t area = {0, 0, w - 1, dd->cell_h - 1};
+    lv_draw_label(&layer, &label, &area);
+    lv_canvas_finish_layer(canvas, &layer);
+
+    for (int32_t y = 0; y < dd->cell_h; y++) {
+        const uint8_t *src = scratch->data + y * scratch->header.stride;
+        uint8_t *dst = dd->atlas + y * atlas_stride + atlas_x;
+        for (int32_t x = 0; x < w; x++) {
+            dst[x] = src[x * 4 + 3];
+        }
+    }
+
+    lv_image_dsc_t *img = &dd->glyphs[glyph];
+    img->header.magic = LV_IMAGE_HEADER_MAGIC;
+    img->header.cf = LV_COLOR_FORMAT_A8;
+    img->header.w = w;
+    img->header.h = dd->cell_h;
+    img->header.stride = atlas_stride;
+    img->data = dd->atlas + atlas_x;
+    img->data_size = atlas_stride * (dd->cell_h - 1) + w;
+}
+
+static bool build_atlas(digit_display_t *dd, lv_obj_t *parent, const lv_font_t *font)
+{
+    dd->digit_w = 0;
+    for (uint32_t ch = '0'; ch <= '9'; ch++) {
+        dd->digit_w = LV_MAX(dd->digit_w, (int32_t)lv_font_get_glyph_width(font, ch, 0));
+    }
+    dd->percent_w = lv_font_get_glyph_width(font, '%', 0);
+    dd->cell_h = lv_font_get_line_height(font);
+
+    uint32_t atlas_stride = dd->digit_w * 10 + dd->percent_w;
+    /* Hot data: read on every speed change, keep it in internal RAM if possible */
+    dd->atlas = heap_caps_malloc(atlas_stride * dd->cell_h, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!dd->atlas) {
+        dd->atlas = heap_caps_malloc(atlas_stride * dd->cell_h, MALLOC_CAP_8BIT);
+    }
+    if (!dd->atlas) {
+        return false;
+    }
+
+    lv_draw_buf_t *scratch = lv_draw_buf_create(LV_MAX(dd->digit_w, dd->percent_w), dd->cell_h,
+                                                LV_COLOR_FORMAT_ARGB8888, LV_STRIDE_AUTO);
+    if (!scratch) {
+        heap_caps_free(dd->atlas);
+        dd->atlas = NULL;
+        return false;
+    }
+    lv_obj_t *canvas = lv_canvas_create(parent);
+    lv_obj_add_flag(canvas, LV_OBJ_FLAG_HIDDEN);
+    lv_canvas_set_draw_buf(canvas, scratch);
+    for (uint8_t glyph = 0; glyph < GLYPH_COUNT; glyph++) {
+        rasterise_glyph(dd, canvas, scratch, font, glyph, glyph * dd->digit_w, atlas_stride);
+    }
+    lv_obj_delete(canvas);
+    lv_draw_buf_destroy(scratch);
+    return true;
+}
+
+static int32_t cells_width(const digit_display_t *dd)
+{
+    int32_t w = 0;
+    for (uint8_t i = 0; i < dd->cell_count; i++) {
+        w += glyph_width(dd, dd->cells[i]);
+    }
+    return w;
+}
+
+/* Cells are centred horizontally in the object */
+static void cell_area(lv_obj_t *obj, const digit_display_t *dd, uint8_t index, lv_area_t *area)
+{
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+    int32_t x = coords.x1 + (lv_area_get_width(&coords) - cells_width(dd)) / 2;
+    for (uint8_t i = 0; i < index; i++) {
+        x += glyph_width(dd, dd->cells[i]);
+    }
+    area->x1 = x;
+    area->y1 = coords.y1;
+    area->x2 = x + glyph_width(dd, dd->cells[index]) - 1;
+    area->y2 = coords.y1 + dd->cell_h - 1;
+}
+
+static void draw_event_cb(lv_event_t *e)
+{
+    lv_obj_t *obj = lv_event_get_target(e);
+    digit_display_t *dd = lv_event_get_user_data(e);
+    lv_layer_t *layer = lv_event_get_layer(e);
+
+    lv_draw_image_dsc_t img;
+    lv_draw_image_dsc_init(&img);
+    img.recolor = lv_obj_get_style_text_color(obj, LV_PART_MAIN);
+    img.recolor_opa = LV_OPA_COVER;
+    img.opa = lv_obj_get_style_opa(obj, LV_PART_MAIN);
+    for (uint8_t i = 0; i < dd->cell_count; i++) {
+        lv_area_t area;
+        cell_area(obj, dd, i, &area);
+        img.src = &dd->glyphs[dd->cells[i]];
+        lv_draw_image(layer, &img, &area);
+    }
+}
+
+static void delete_event_cb(lv_event_t *e)
+{
+    digit_display_t *dd = lv_event_get_user_data(e);
+    heap_caps_free(dd->atlas);
+    lv_free(dd);
+}
+
+lv_obj_t *digit_display_create(lv_obj_t *parent, const lv_font_t *font)
+{
+    digit_display_t *dd = lv_malloc_zeroed(sizeof(digit_display_t));
+    if (!dd) {
+        return NULL;
+    }
+    if (!build_atlas(dd, parent, font)) {
+        lv_free(dd);
+        return NULL;
+    }
+    dd->value = -1;
+
+    lv_obj_t *obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(obj);
+    lv_obj_set_size(obj, dd->digit_w * DIGIT_DISPLAY_MAX_DIGITS + dd->percent_w, dd->cell_h);
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_event_cb(obj, draw_event_cb, LV_EVENT_DRAW_MAIN, dd);
+    lv_obj_add_event_cb(obj, delete_event_cb, LV_EVENT_DELETE, dd);
+    lv_obj_set_user_data(obj, dd);
+    return obj;
+}
+
+void digit_display_set_value(lv_obj_t *obj, int32_t value)
+{
+    digit_display_t *dd = lv_obj_get_user_data(obj);
+    value = LV_CLAMP(0, value, 999);
+    if (value == dd->value) {
+        return;
+    }
+    dd->value = value;
+
+    uint8_t cells[DIGIT_DISPLAY_MAX_CELLS];
+    uint8_t count = 0;
+    if (value >= 100) {
+        cells[count++] = value / 100;
+    }
+    if (value >= 10) {
+        cells[count++] = (value / 10) % 10;
+    }
+    cells[count++] = value % 10;
+    cells[count++] = GLYPH_PERCENT;
+
+    if (count != dd->cell_count) {
+        /* The number got wider or narrower, everything moves */
+        memcpy(dd->cells, cells, count);
+        dd->cell_count = count;
+        lv_obj_invalidate(obj);
+        return;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        if (cells[i] != dd->cells[i]) {
+            dd->cells[i] = cells[i];
+            lv_area_t area;
+            cell_area(obj, dd, i, &area);
+            lv_obj_invalidate_area(obj, &area);
+        }
+    }
+}
@@ -0,0 +1,27 @@
+/**
+ * @file digit_display.h
+ * @brief Numeric readout blitted from a glyph atlas
+ * @details Replaces the "%d%%" label of the speed readout. The glyphs 0-9
+ *          and % are rasterised once, when the widget is created, into a
+ *          fixed-cell A8 atlas; a value change only swaps atlas cells and
+ *          invalidates the cells whose glyph actually changed, e.g. just
+ *          the units digit going from 65% to 66%. There is no text layout
+ *          and no font rendering after creation.
+ *
+ *          Digits use one cell width (tabular figures), so the number does
+ *          not shift sideways while the value changes. The glyph colour is
+ *          the text_color style of LV_PART_MAIN.
+ */
+
+#pragma once
+
+#include "lvgl.h"
+
+/**
+ * @brief Create a readout for values 0..999 followed by a percent sign
+ *
+ * Returns NULL if the atlas cannot be allocated.
+ */
+lv_obj_t *digit_display_create(lv_obj_t *parent, const lv_font_t *font);
+
+void digit_display_set_value(lv_obj_t *obj, int32_t value);
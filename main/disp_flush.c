@@ -0,0 +1,524 @@
+/**
+ * @file disp_flush.c
+ * @brief LVGL flush path for the SH8601 panel
+ */
+
+#include <stdatomic.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "disp_flush.h"
+
+/* Rows per transfer when clipping to the disc; even, as the SH8601 wants */
+#define DISP_FLUSH_BAND_ROWS 8
+#define DISP_FLUSH_STAGING_CNT 2
+/* Extra visible pixels around the disc, the glass edge is not pixel exact */
+#define DISP_FLUSH_ROUND_MARGIN 4
+/* More than the panel IO queue depth can ever hold in flight */
+#define DISP_FLUSH_TAG_RING 32
+#define DISP_FLUSH_MAX_OBSERVERS 4
+/* Never produced by hash_segment(), marks what the panel holds as unknown */
+#define DISP_FLUSH_HASH_UNKNOWN 0
+
+static const char *TAG = "disp_flush";
+
+typedef struct {
+    lv_display_t *disp;
+    esp_lcd_panel_handle_t panel;
+    esp_lcd_panel_io_handle_t io;
+    int32_t h_res;
+    int32_t v_res;
+    bool round;
+    /* Visible columns per row, x1 even and x2 odd */
+    uint16_t *span_x1;
+    uint16_t *span_x2;
+    /* Hash of every row of every tile column as last sent, v_res x tile_cols */
+    uint32_t *tile_hash;
+    int32_t tile_cols;
+    /* DMA-capable copies of partial-width bands */
+    uint8_t *staging[DISP_FLUSH_STAGING_CNT];
+    uint8_t staging_next;
+    SemaphoreHandle_t staging_free;
+    /* Transfers complete in order; remember which ones used a staging buffer */
+    volatile uint8_t tag_staged[DISP_FLUSH_TAG_RING];
+    volatile uint32_t tag_head;
+    volatile uint32_t tag_tail;
+    /* Outstanding transfers of the current flush, plus one while queueing */
+    atomic_int pending;
+    /* The current flush is the last one of the frame */
+    volatile bool frame_last;
+    /* Transfers queued by disp_flush_blit(), which LVGL knows nothing about */
+    volatile bool blitting;
+    disp_flush_capture_cb_t capture;
+    void *capture_arg;
+    /* Flushed areas only go to the capture callback */
+    bool hold;
+    disp_flush_frame_cb_t observers[DISP_FLUSH_MAX_OBSERVERS];
+    void *observer_args[DISP_FLUSH_MAX_OBSERVERS];
+    volatile int observer_cnt;
+    /* First flush of the frame being sent; 0 between frames */
+    int64_t frame_start_us;
+    disp_flush_stats_t stats;
+} disp_flush_ctx_t;
+
+static disp_flush_ctx_t s_flush;
+
+static void IRAM_ATTR flush_done(void)
+{
+    if (s_flush.blitting) {
+        return;
+    }
+    if (s_flush.frame_last) {
+        int64_t now = esp_timer_get_time();
+        s_flush.stats.frames++;
+        s_flush.stats.flush_us += now - s_flush.frame_start_us;
+        s_flush.frame_start_us = 0;
+        for (int i = 0; i < s_flush.observer_cnt; i++) {
+            s_flush.observers[i](now, s_flush.observer_args[i]);
+        }
+    }
+    lv_display_flush_ready(s_flush.disp);
+}
+
+static bool IRAM_ATTR on_color_trans_done(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx)
+{
+    BaseType_t need_yield = pdFALSE;
+    if (s_flush.tag_tail == s_flush.tag_head) {
+        /* A transfer queued by the port flush before we took over */
+        lv_display_flush_ready((lv_display_t *)user_ctx);
+        return false;
+    }
+    uint8_t staged = s_flush.tag_staged[s_flush.tag_tail % DISP_FLUSH_TAG_RING];
+    s_flush.tag_tail++;
+    if (staged) {
+        xSemaphoreGiveFromISR(s_flush.staging_free, &need_yield);
+    }
+    if (atomic_fetch_sub(&s_flush.pending, 1) == 1 && s_flush.disp) {
+        flush_done();
+    }
+    return need_yield == pdTRUE;
+}
+
+static esp_err_t send_rect(int32_t x1, int32_t y1, int32_t x2, int32_t y2, const void *data, bool staged)
+{
+    s_flush.tag_staged[s_flush.tag_head % DISP_FLUSH_TAG_RING] = staged;
+    s_flush.tag_head++;
+    atomic_fetch_add(&s_flush.pending, 1);
+    esp_err_t err = esp_lcd_panel_draw_bitmap(s_flush.panel, x1, y1, x2 + 1, y2 + 1, data);
+    if (err == ESP_OK) {
+        s_flush.stats.transfers++;
+        s_flush.stats.bytes += (x2 - x1 + 1) * (y2 - y1 + 1) * 2;
+    } else {
+        /* No completion callback will come for this one */
+        ESP_LOGE(TAG, "draw_bitmap failed: %s", esp_err_to_name(err));
+        s_flush.stats.errors++;
+        s_flush.tag_head--;
+        if (staged) {
+            xSemaphoreGive(s_flush.staging_free);
+        }
+        atomic_fetch_sub(&s_flush.pending, 1);
+    }
+    return err;
+}
+
+static uint8_t *take_staging(void)
+{
+    xSemaphoreTake(s_flush.staging_free, portMAX_DELAY);
+    uint8_t *buf = s_flush.staging[s_flush.staging_next];
+    s_flush.staging_next = (s_flush.staging_next + 1) % DISP_FLUSH_STAGING_CNT;
+    return buf;
+}
+
+/* Send columns x1..x2 of rows y1..y2 of a flushed area, in bands clipped to the disc when round;
+ * returns the error of a failed transfer, if any */
+static esp_err_t send_part(const lv_area_t *area, const uint8_t *px_map, int32_t x1, int32_t y1, int32_t x2,
+                           int32_t y2)
+{
+    const int32_t stride = lv_area_get_width(area) * 2;
+    if (!s_flush.round && x1 == area->x1 && x2 == area->x2) {
+        return send_rect(x1, y1, x2, y2, px_map + (y1 - area->y1) * stride, false);
+    }
+    esp_err_t ret = ESP_OK;
+    esp_err_t err;
+    int32_t run_y1 = -1;
+
+    for (int32_t by1 = y1; by1 <= y2; by1 += DISP_FLUSH_BAND_ROWS) {
+        int32_t by2 = LV_MIN(by1 + DISP_FLUSH_BAND_ROWS - 1, y2);
+        int32_t sx1 = x1;
+        int32_t sx2 = x2;
+        if (s_flush.round) {
+            int32_t vx1 = INT32_MAX;
+            int32_t vx2 = -1;
+            for (int32_t y = by1; y <= by2; y++) {
+                vx1 = LV_MIN(vx1, s_flush.span_x1[y]);
+                vx2 = LV_MAX(vx2, s_flush.span_x2[y]);
+            }
+            sx1 = LV_MAX(sx1, vx1);
+            sx2 = LV_MIN(sx2, vx2);
+        }
+
+        if (sx1 == area->x1 && sx2 == area->x2) {
+            /* Full-width bands are contiguous in the buffer, send them in one go */
+            if (run_y1 < 0) {
+                run_y1 = by1;
+            }
+            continue;
+        }
+        if (run_y1 >= 0) {
+            err = send_rect(area->x1, run_y1, area->x2, by1 - 1, px_map + (run_y1 - area->y1) * stride, false);
+            ret = err != ESP_OK ? err : ret;
+            run_y1 = -1;
+        }
+        if (sx1 > sx2) {
+            continue;
+        }
+
+        const int32_t row_bytes = (sx2 - sx1 + 1) * 2;
+        uint8_t *dst = take_staging();
+        const uint8_t *src = px_map + (by1 - area->y1) * stride + (sx1 - area->x1) * 2;
+        for (int32_t y = by1; y <= by2; y++) {
+            memcpy(dst + (y - by1) * row_bytes, src, row_bytes);
+            src += stride;
+        }
+        err = send_rect(sx1, by1, sx2, by2, dst, true);
+        ret = err != ESP_OK ? err : ret;
+    }
+    if (run_y1 >= 0) {
+        err = send_rect(area->x1, run_y1, area->x2, y2, px_map + (run_y1 - area->y1) * stride, false);
+        ret = err != ESP_OK ? err : ret;
+    }
+    return ret;
+}
+
+/* Pixels x1..x2 of one row, seeded with their position so a narrower part of a tile never matches */
+static uint32_t hash_segment(const uint8_t *px, int32_t x1, int32_t x2)
+{
+    /* x1 is even and areas are an even number of pixels wide, so this is word aligned */
+    const uint32_t *w = (const uint32_t *)px;
+    uint32_t h = 0x811C9DC5u ^ ((uint32_t)x1 << 16 | (uint32_t)x2);
+    for (int32_t i = 0; i < (x2 - x1 + 1) / 2; i++) {
+        h = (h ^ w[i]) * 0x9E3779B1u;
+        h ^= h >> 15;
+    }
+    return h != DISP_FLUSH_HASH_UNKNOWN ? h : 1;
+}
+
+static int32_t visible_px(int32_t y, int32_t x1, int32_t x2)
+{
+    if (s_flush.round) {
+        x1 = LV_MAX(x1, s_flush.span_x1[y]);
+        x2 = LV_MIN(x2, s_flush.span_x2[y]);
+    }
+    return LV_MAX(0, x2 - x1 + 1);
+}
+
+/* Tile columns c..c+cols-1 of rows y1..y2 did not reach the panel, send them next time whatever they hold */
+static void forget_tiles(int32_t c, int32_t cols, int32_t y1, int32_t y2)
+{
+    for (int32_t y = y1; y <= y2; y++) {
+        memset(s_flush.tile_hash + y * s_flush.tile_cols + c, DISP_FLUSH_HASH_UNKNOWN, cols * sizeof(uint32_t));
+    }
+}
+
+/* One window per run of tile columns set in mask, over rows y1..y2 */
+static void send_windows(const lv_area_t *area, const uint8_t *px_map, uint32_t mask, int32_t c0, int32_t y1,
+                         int32_t y2)
+{
+    while (mask) {
+        int32_t first = __builtin_ctz(mask);
+        int32_t len = __builtin_ctz(~(mask >> first));
+        mask &= ~(((1u << len) - 1) << first);
+        int32_t x1 = LV_MAX((c0 + first) * DISP_FLUSH_TILE, area->x1);
+        int32_t x2 = LV_MIN((c0 + first + len) * DISP_FLUSH_TILE - 1, area->x2);
+        if (send_part(area, px_map, x1, y1, x2, y2) != ESP_OK) {
+            forget_tiles(c0 + first, len, y1, y2);
+        }
+    }
+}
+
+/* Send only the tiles of an area whose pixels differ from what was last sent there */
+static void flush_changed(const lv_area_t *area, const uint8_t *px_map)
+{
+    const int32_t stride = lv_area_get_width(area) * 2;
+    const int32_t c0 = area->x1 / DISP_FLUSH_TILE;
+    const int32_t c1 = area->x2 / DISP_FLUSH_TILE;
+    /* Tile rows with the same changed columns share their windows */
+    uint32_t open_mask = 0;
+    int32_t open_y1 = area->y1;
+    int32_t ty2;
+
+    for (int32_t ty1 = area->y1; ty1 <= area->y2; ty1 = ty2 + 1) {
+        ty2 = LV_MIN((ty1 / DISP_FLUSH_TILE + 1) * DISP_FLUSH_TILE - 1, area->y2);
+        uint32_t mask = 0;
+        for (int32_t y = ty1; y <= ty2; y++) {
+            const uint8_t *row = px_map + (y - area->y1) * stride;
+            uint32_t *hash = s_flush.tile_hash + y * s_flush.tile_cols;
+            for (int32_t c = c0; c <= c1; c++) {
+                int32_t x1 = LV_MAX(c * DISP_FLUSH_TILE, area->x1);
+                int32_t x2 = LV_MIN(c * DISP_FLUSH_TILE + DISP_FLUSH_TILE - 1, area->x2);
+                uint32_t h = hash_segment(row + (x1 - area->x1) * 2, x1, x2);
+                if (h != hash[c]) {
+                    hash[c] = h;
+                    mask |= 1u << (c - c0);
+                }
+            }
+        }
+        for (int32_t c = c0; c <= c1; c++) {
+            if (mask & (1u << (c - c0))) {
+                continue;
+            }
+            int32_t x1 = LV_MAX(c * DISP_FLUSH_TILE, area->x1);
+            int32_t x2 = LV_MIN(c * DISP_FLUSH_TILE + DISP_FLUSH_TILE - 1, area->x2);
+            for (int32_t y = ty1; y <= ty2; y++) {
+                s_flush.stats.skipped_bytes += visible_px(y, x1, x2) * 2;
+            }
+        }
+        if (mask != open_mask) {
+            send_windows(area, px_map, open_mask, c0, open_y1, ty1 - 1);
+            open_mask = mask;
+            open_y1 = ty1;
+        }
+    }
+    send_windows(area, px_map, open_mask, c0, open_y1, area->y2);
+}
+
+static void disp_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    lv_draw_sw_rgb565_swap(px_map, lv_area_get_size(area));
+
+    if (s_flush.hold) {
+        /* Nothing reaches the panel, so this is not a frame */
+        if (s_flush.capture) {
+            s_flush.capture(area, px_map, s_flush.capture_arg);
+        }
+        lv_display_flush_ready(disp);
+        return;
+    }
+    if (!s_flush.frame_start_us) {
+        s_flush.frame_start_us = esp_timer_get_time();
+    }
+    s_flush.stats.flushes++;
+    s_flush.frame_last = lv_display_flush_is_last(disp);
+    atomic_store(&s_flush.pending, 1);
+    if (s_flush.tile_hash) {
+        flush_changed(area, px_map);
+    } else {
+        send_part(area, px_map, area->x1, area->y1, area->x2, area->y2);
+    }
+    /* The buffer is LVGL's until flush_cb returns, copying it overlaps the transfer */
+    if (s_flush.capture) {
+        s_flush.capture(area, px_map, s_flush.capture_arg);
+    }
+    if (atomic_fetch_sub(&s_flush.pending, 1) == 1) {
+        flush_done();
+    }
+}
+
+void disp_flush_clip_to_viewport(lv_area_t *area)
+{
+    /* get_max_row() of LVGL sizes its render strips by sending
+     * {0, 0, 0, rows - 1} through the rounder; clipped, that column would
+     * shrink to nothing and LVGL would render in 2-row strips */
+    if (!s_flush.round || (area->x1 == 0 && area->x2 <= 1 && area->y1 == 0)) {
+        return;
+    }
+    int32_t x1 = INT32_MAX;
+    int32_t x2 = -1;
+    int32_t y1 = -1;
+    int32_t y2 = -1;
+    for (int32_t y = area->y1; y <= area->y2; y++) {
+        int32_t sx1 = LV_MAX(s_flush.span_x1[y], area->x1);
+        int32_t sx2 = LV_MIN(s_flush.span_x2[y], area->x2);
+        if (sx1 > sx2) {
+            continue;
+        }
+        if (y1 < 0) {
+            y1 = y;
+        }
+        y2 = y;
+        x1 = LV_MIN(x1, sx1);
+        x2 = LV_MAX(x2, sx2);
+    }
+    if (y1 < 0) {
+        /* Entirely in a corner. The area cannot be dropped from here; it
+         * gets rendered, and the flush sends none of it. */
+        return;
+    }
+    area->x1 = x1 & ~1;
+    area->y1 = y1 & ~1;
+    area->x2 = x2 | 1;
+    area->y2 = y2 | 1;
+}
+
+static void build_spans(void)
+{
+    /* Pixel centres inside the inscribed circle, in 1/2 px units */
+    const int32_t diameter = LV_MIN(s_flush.h_res, s_flush.v_res);
+    const int32_t r2 = (diameter + 2 * DISP_FLUSH_ROUND_MARGIN) * (diameter + 2 * DISP_FLUSH_ROUND_MARGIN);
+    for (int32_t y = 0; y < s_flush.v_res; y++) {
+        int32_t dy = 2 * y + 1 - s_flush.v_res;
+        int32_t half = (int32_t)lv_sqrt32((uint32_t)LV_MAX(0, r2 - dy * dy));
+        int32_t x1 = (s_flush.h_res - half) / 2;
+        int32_t x2 = (s_flush.h_res + half) / 2;
+        s_flush.span_x1[y] = LV_CLAMP(0, x1, s_flush.h_res - 1) & ~1;
+        s_flush.span_x2[y] = LV_CLAMP(0, x2, s_flush.h_res - 1) | 1;
+    }
+}
+
+static void wait_idle(void)
+{
+    while (atomic_load(&s_flush.pending) > 0) {
+        vTaskDelay(1);
+    }
+}
+
+/* Row y of a moved left by shift, b following it, columns x1..x2 */
+static void compose_row(uint8_t *dst, const uint8_t *a, const uint8_t *b, int32_t shift, int32_t y, int32_t x1,
+                        int32_t x2)
+{
+    const int32_t stride = s_flush.h_res * 2;
+    const int32_t split = s_flush.h_res - shift;
+    if (x1 < split) {
+        int32_t end = LV_MIN(x2, split - 1);
+        memcpy(dst, a + y * stride + (x1 + shift) * 2, (end - x1 + 1) * 2);
+        dst += (end - x1 + 1) * 2;
+    }
+    if (x2 >= split) {
+        int32_t start = LV_MAX(x1, split);
+        memcpy(dst, b + y * stride + (start - split) * 2, (x2 - start + 1) * 2);
+    }
+}
+
+esp_err_t disp_flush_blit(const uint8_t *a, const uint8_t *b, int32_t shift)
+{
+    ESP_RETURN_ON_FALSE(s_flush.disp && a && shift >= 0 && shift <= s_flush.h_res && (b || !shift),
+                        ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+
+    /* LVGL may have left its last transfer of a refresh in flight */
+    wait_idle();
+    s_flush.blitting = true;
+    atomic_store(&s_flush.pending, 1);
+    for (int32_t by1 = 0; by1 < s_flush.v_res; by1 += DISP_FLUSH_BAND_ROWS) {
+        int32_t by2 = LV_MIN(by1 + DISP_FLUSH_BAND_ROWS, s_flush.v_res) - 1;
+        int32_t sx1 = 0;
+        int32_t sx2 = s_flush.h_res - 1;
+        if (s_flush.round) {
+            sx1 = INT32_MAX;
+            sx2 = -1;
+            for (int32_t y = by1; y <= by2; y++) {
+                sx1 = LV_MIN(sx1, s_flush.span_x1[y]);
+                sx2 = LV_MAX(sx2, s_flush.span_x2[y]);
+            }
+        }
+        /* The source may be in PSRAM, which the SPI DMA cannot read: always stage */
+        const int32_t row_bytes = (sx2 - sx1 + 1) * 2;
+        uint8_t *dst = take_staging();
+        for (int32_t y = by1; y <= by2; y++) {
+            compose_row(dst + (y - by1) * row_bytes, a, b, shift, y, sx1, sx2);
+        }
+        send_rect(sx1, by1, sx2, by2, dst, true);
+    }
+    atomic_fetch_sub(&s_flush.pending, 1);
+    wait_idle();
+    s_flush.blitting = false;
+    /* The panel no longer holds what the hashes describe */
+    if (s_flush.tile_hash) {
+        memset(s_flush.tile_hash, DISP_FLUSH_HASH_UNKNOWN, s_flush.v_res * s_flush.tile_cols * sizeof(uint32_t));
+    }
+    return ESP_OK;
+}
+
+void disp_flush_set_capture(disp_flush_capture_cb_t cb, void *arg)
+{
+    s_flush.capture = NULL;
+    s_flush.capture_arg = arg;
+    s_flush.capture = cb;
+}
+
+void disp_flush_set_hold(bool hold)
+{
+    s_flush.hold = hold;
+}
+
+/* The corners are never sent again, make sure they start out black */
+static void clear_panel(void)
+{
+    uint8_t *zero = s_flush.staging[0];
+    memset(zero, 0, s_flush.h_res * DISP_FLUSH_BAND_ROWS * 2);
+    atomic_store(&s_flush.pending, 1);
+    for (int32_t y = 0; y < s_flush.v_res; y += DISP_FLUSH_BAND_ROWS) {
+        send_rect(0, y, s_flush.h_res - 1, LV_MIN(y + DISP_FLUSH_BAND_ROWS, s_flush.v_res) - 1, zero, false);
+    }
+    atomic_fetch_sub(&s_flush.pending, 1);
+    wait_idle();
+}
+
+esp_err_t disp_flush_install(lv_display_t *disp, const disp_flush_config_t *config)
+{
+    ESP_RETURN_ON_FALSE(disp && config, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+
+    s_flush.panel = config->panel;
+    s_flush.io = config->io;
+    s_flush.h_res = config->h_res;
+    s_flush.v_res = config->v_res;
+
+    if (config->round) {
+        s_flush.span_x1 = heap_caps_malloc(config->v_res * sizeof(uint16_t), MALLOC_CAP_INTERNAL);
+        s_flush.span_x2 = heap_caps_malloc(config->v_res * sizeof(uint16_t), MALLOC_CAP_INTERNAL);
+        ESP_RETURN_ON_FALSE(s_flush.span_x1 && s_flush.span_x2, ESP_ERR_NO_MEM, TAG, "No memory for spans");
+        build_spans();
+    }
+    for (int i = 0; i < DISP_FLUSH_STAGING_CNT; i++) {
+        s_flush.staging[i] = heap_caps_malloc(config->h_res * DISP_FLUSH_BAND_ROWS * 2, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        ESP_RETURN_ON_FALSE(s_flush.staging[i], ESP_ERR_NO_MEM, TAG, "No memory for staging");
+    }
+    if (config->skip_unchanged) {
+        s_flush.tile_cols = (config->h_res + DISP_FLUSH_TILE - 1) / DISP_FLUSH_TILE;
+        /* A window is a run of bits in a 32-bit column mask */
+        ESP_RETURN_ON_FALSE(s_flush.tile_cols < 32, ESP_ERR_INVALID_ARG, TAG, "Too many tile columns");
+        /* Zeroed is DISP_FLUSH_HASH_UNKNOWN, the first frame goes out in full */
+        s_flush.tile_hash = heap_caps_calloc(config->v_res * s_flush.tile_cols, sizeof(uint32_t), MALLOC_CAP_INTERNAL);
+        ESP_RETURN_ON_FALSE(s_flush.tile_hash, ESP_ERR_NO_MEM, TAG, "No memory for tile hashes");
+    }
+    s_flush.staging_free = xSemaphoreCreateCounting(DISP_FLUSH_STAGING_CNT, DISP_FLUSH_STAGING_CNT);
+    ESP_RETURN_ON_FALSE(s_flush.staging_free, ESP_ERR_NO_MEM, TAG, "No memory for semaphore");
+
+    const esp_lcd_panel_io_callbacks_t cbs = {
+        .on_color_trans_done = on_color_trans_done,
+    };
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_register_event_callbacks(s_flush.io, &cbs, disp), TAG, "IO callbacks failed");
+
+    if (config->round) {
+        clear_panel();
+    }
+    s_flush.round = config->round;
+    s_flush.disp = disp;
+    lv_display_set_flush_cb(disp, disp_flush_cb);
+    return ESP_OK;
+}
+
+esp_err_t disp_flush_add_frame_observer(disp_flush_frame_cb_t cb, void *arg)
+{
+    ESP_RETURN_ON_FALSE(cb, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(s_flush.observer_cnt < DISP_FLUSH_MAX_OBSERVERS, ESP_ERR_NO_MEM, TAG, "Too many observers");
+    int i = s_flush.observer_cnt;
+    s_flush.observers[i] = cb;
+    s_flush.observer_args[i] = arg;
+    /* Publish only once the slot is filled, the ISR may be walking the list */
+    s_flush.observer_cnt = i + 1;
+    return ESP_OK;
+}
+
+void disp_flush_get_stats(disp_flush_stats_t *stats)
+{
+    /* 64-bit fields may be mid-update by the ISR; good enough for reporting */
+    *stats = s_flush.stats;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file disp_flush.h
+ * @brief LVGL flush path for the SH8601 panel
+ * @details Replaces the esp_lvgl_port flush callback and panel IO "color
+ *          transfer done" callback so the transfer of a rendered area can be
+ *          split, filtered and accounted for. A flush may turn into several
+ *          panel transfers; lv_display_flush_ready() is signalled when the
+ *          last of them completes.
+ *
+ *          Round viewport: the 1.5" AMOLED only shows a disc inscribed in the
+ *          panel RAM. With it enabled, invalidated areas are shrunk to the
+ *          visible part of the disc before rendering, and each flushed area is
+ *          sent in bands of rows clipped to the disc span, so the corners are
+ *          neither rendered nor streamed over QSPI. The corners are cleared to
+ *          black once at install time.
+ *
+ *          Unchanged tiles: an invalidated area often renders to the pixels
+ *          the panel already shows, e.g. a fading overlay at a level it had
+ *          reached or a label set to its own text. With skip_unchanged, every
+ *          row of every DISP_FLUSH_TILE-wide tile column of a flushed area is
+ *          hashed and compared with the hash of what was last sent there.
+ *          Only tiles with a changed row are sent; adjacent changed tiles of
+ *          a tile row become one window, and tile rows with the same changed
+ *          columns share their windows. The hashes cost about 28 KB of
+ *          internal RAM and a few ms of CPU for a full frame, a fraction of
+ *          its transfer time. disp_flush_blit() forgets them.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_ops.h"
+#include "lvgl.h"
+
+/* Tile edge in pixels for skip_unchanged; even, as the SH8601 wants */
+#define DISP_FLUSH_TILE 32
+
+typedef struct {
+    esp_lcd_panel_handle_t panel;
+    esp_lcd_panel_io_handle_t io;
+    int32_t h_res;
+    int32_t v_res;
+    bool round;             /*!< Clip rendering and transfers to the inscribed disc */
+    bool skip_unchanged;    /*!< Only send the tiles whose pixels changed */
+} disp_flush_config_t;
+
+typedef struct {
+    uint32_t frames;        /*!< Frames whose last transfer completed */
+    uint32_t flushes;       /*!< flush_cb calls */
+    uint32_t transfers;     /*!< draw_bitmap calls that were queued */
+    uint32_t errors;        /*!< draw_bitmap calls that failed */
+    uint64_t bytes;         /*!< Pixel bytes queued to the panel */
+    uint64_t skipped_bytes; /*!< Visible pixel bytes of unchanged tiles left out */
+    uint64_t flush_us;      /*!< Sum over frames of first flush to last transfer done */
+} disp_flush_stats_t;
+
+/**
+ * @brief Called when the last transfer of a frame has reached the panel
+ *
+ * @note Runs in the panel IO interrupt, or in the LVGL task when nothing was
+ *       left in flight. Keep it short, IRAM-safe and non-blocking.
+ */
+typedef void (*disp_flush_frame_cb_t)(int64_t done_us, void *arg);
+
+/**
+ * @brief Sees every flushed area, already in panel byte order
+ *
+ * @note Runs in flush_cb while the area is being sent. The row stride is the
+ *       width of the area.
+ */
+typedef void (*disp_flush_capture_cb_t)(const lv_area_t *area, const uint8_t *px_map, void *arg);
+
+/**
+ * @brief Take over the flush of an esp_lvgl_port display
+ *
+ * @note Call with the LVGL port lock held, after lvgl_port_add_disp().
+ */
+esp_err_t disp_flush_install(lv_display_t *disp, const disp_flush_config_t *config);
+
+/**
+ * @brief Shrink an invalidated area to the bounding box of its visible part
+ *
+ * Meant to be called from the LV_EVENT_INVALIDATE_AREA rounder, after the
+ * area has been aligned for the panel. No-op when the round viewport is off.
+ * Areas with nothing visible, and areas 2 px wide at the top left corner,
+ * which is the shape of the probe LVGL sizes its render strips with, are
+ * left alone.
+ */
+void disp_flush_clip_to_viewport(lv_area_t *area);
+
+/**
+ * @brief Register a frame-done observer
+ *
+ * @note Register during start-up only; observers cannot be removed.
+ */
+esp_err_t disp_flush_add_frame_observer(disp_flush_frame_cb_t cb, void *arg);
+
+/**
+ * @brief Set the one capture callback, NULL to stop capturing
+ *
+ * @note Call with the LVGL port lock held.
+ */
+void disp_flush_set_capture(disp_flush_capture_cb_t cb, void *arg);
+
+/**
+ * @brief Keep LVGL's flushes off the panel
+ *
+ * While held, flushed areas only go to the capture callback and the panel
+ * keeps showing what was last sent or blitted. For a caller that puts
+ * frames on the panel with disp_flush_blit() over several refreshes.
+ *
+ * @note Call with the LVGL port lock held.
+ */
+void disp_flush_set_hold(bool hold);
+
+/**
+ * @brief Send whole frames held outside LVGL straight to the panel
+ *
+ * a and b are h_res x v_res frames in panel byte order, in any memory. The
+ * panel shows a moved left by shift pixels with b following it on the
+ * right: shift 0 is a alone, h_res is b alone, and b may be NULL then.
+ * Clipped to the round viewport like any flush. Waits for LVGL's last
+ * transfer first and returns once the frame is on the panel.
+ *
+ * @note Call from the LVGL task with the port lock held, outside flush_cb.
+ */
+esp_err_t disp_flush_blit(const uint8_t *a, const uint8_t *b, int32_t shift);
+
+/**
+ * @brief Counters since install; monotonic, diff two reads for rates
+ */
+void disp_flush_get_stats(disp_flush_stats_t *stats);
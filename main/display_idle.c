@@ -0,0 +1,195 @@
+/**
+ * @file display_idle.c
+ * @brief Staged display power management on user inactivity
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "lvgl.h"
+#include "esp_lvgl_port.h"
+
+#include "display_idle.h"
+#include "task_topology.h"
+
+#define DISPLAY_IDLE_POLL_MS 250
+
+/* SH8601 over QSPI: write opcode in the top byte, DCS command in bits 8..15 */
+#define SH8601_QSPI_CMD(cmd) ((0x02 << 24) | ((cmd) << 8))
+#define SH8601_CMD_SLPIN 0x10
+#define SH8601_CMD_SLPOUT 0x11
+#define SH8601_CMD_WRDISBV 0x51
+/* Sleep-out needs 120 ms before the panel accepts display-on reliably */
+#define SH8601_SLPOUT_DELAY_MS 120
+
+static const char *TAG = "display_idle";
+
+static const char *const state_names[DISPLAY_IDLE_STATE_COUNT] = {
+    [DISPLAY_IDLE_FULL] = "full",
+    [DISPLAY_IDLE_DIM] = "dim",
+    [DISPLAY_IDLE_OFF] = "off",
+    [DISPLAY_IDLE_SLEEP] = "sleep",
+};
+
+static display_idle_config_t s_cfg;
+static TaskHandle_t s_task = NULL;
+static volatile display_idle_state_t s_state = DISPLAY_IDLE_FULL;
+static volatile int64_t s_last_activity_us = 0;
+static int64_t s_state_since_us = 0;
+static uint64_t s_residency_us[DISPLAY_IDLE_STATE_COUNT];
+static uint32_t s_entries[DISPLAY_IDLE_STATE_COUNT];
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static esp_err_t panel_cmd(uint8_t cmd, const uint8_t *param, size_t len)
+{
+    return esp_lcd_panel_io_tx_param(s_cfg.io, SH8601_QSPI_CMD(cmd), param, len);
+}
+
+static esp_err_t set_brightness(uint8_t level)
+{
+    return panel_cmd(SH8601_CMD_WRDISBV, &level, 1);
+}
+
+static display_idle_state_t target_state(int64_t idle_ms)
+{
+    if (s_cfg.sleep_after_ms && idle_ms >= s_cfg.sleep_after_ms) {
+        return DISPLAY_IDLE_SLEEP;
+    }
+    if (s_cfg.off_after_ms && idle_ms >= s_cfg.off_after_ms) {
+        return DISPLAY_IDLE_OFF;
+    }
+    if (s_cfg.dim_after_ms && idle_ms >= s_cfg.dim_after_ms) {
+        return DISPLAY_IDLE_DIM;
+    }
+    return DISPLAY_IDLE_FULL;
+}
+
+/* Walk the stages between the current and the target state, in order */
+static void apply_state(display_idle_state_t from, display_idle_state_t to)
+{
+    /* Panel commands share the bus with the flush, keep LVGL out meanwhile */
+    lvgl_port_lock(0);
+    if (to > from) {
+        if (from < DISPLAY_IDLE_DIM && to >= DISPLAY_IDLE_DIM) {
+            set_brightness(s_cfg.dim_brightness);
+        }
+        if (from < DISPLAY_IDLE_OFF && to >= DISPLAY_IDLE_OFF) {
+            esp_lcd_panel_disp_on_off(s_cfg.panel, false);
+            lvgl_port_stop();
+        }
+        if (from < DISPLAY_IDLE_SLEEP && to >= DISPLAY_IDLE_SLEEP) {
+            panel_cmd(SH8601_CMD_SLPIN, NULL, 0);
+        }
+    } else {
+        if (from >= DISPLAY_IDLE_SLEEP && to < DISPLAY_IDLE_SLEEP) {
+            panel_cmd(SH8601_CMD_SLPOUT, NULL, 0);
+            vTaskDelay(pdMS_TO_TICKS(SH8601_SLPOUT_DELAY_MS));
+        }
+        if (from >= DISPLAY_IDLE_OFF && to < DISPLAY_IDLE_OFF) {
+            esp_lcd_panel_disp_on_off(s_cfg.panel, true);
+            /* Whatever changed while stopped gets drawn in the first frame */
+            lv_obj_invalidate(lv_screen_active());
+            lvgl_port_resume();
+        }
+        if (to == DISPLAY_IDLE_FULL) {
+            set_brightness(s_cfg.full_brightness);
+        }
+    }
+    lvgl_port_unlock();
+}
+
+static void enter_state(display_idle_state_t to)
+{
+    display_idle_state_t from = s_state;
+    if (s_cfg.on_transition) {
+        s_cfg.on_transition(from, to, s_last_activity_us);
+    }
+    apply_state(from, to);
+
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&s_stats_lock);
+    s_residency_us[from] += now - s_state_since_us;
+    s_state_since_us = now;
+    s_entries[to]++;
+    s_state = to;
+    portEXIT_CRITICAL(&s_stats_lock);
+    ESP_LOGD(TAG, "%s -> %s", state_names[from], state_names[to]);
+}
+
+static void display_idle_task(void *arg)
+{
+    for (;;) {
+        /* Nothing can time out further once asleep, only input wakes us */
+        TickType_t wait = s_state == DISPLAY_IDLE_SLEEP ? portMAX_DELAY : pdMS_TO_TICKS(DISPLAY_IDLE_POLL_MS);
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        int64_t idle_ms = (esp_timer_get_time() - s_last_activity_us) / 1000;
+        display_idle_state_t target = target_state(idle_ms);
+        if (target != s_state) {
+            enter_state(target);
+        }
+    }
+}
+
+esp_err_t display_idle_init(const display_idle_config_t *config)
+{
+    ESP_RETURN_ON_FALSE(config && config->io && config->panel, ESP_ERR_INVALID_ARG, TAG, "Invalid config");
+    ESP_RETURN_ON_FALSE(!s_task, ESP_ERR_INVALID_STATE, TAG, "Already initialized");
+
+    s_cfg = *config;
+    s_last_activity_us = esp_timer_get_time();
+    s_state_since_us = s_last_activity_us;
+    s_entries[DISPLAY_IDLE_FULL] = 1;
+
+    BaseType_t res = xTaskCreatePinnedToCore(display_idle_task, "disp_idle", TASK_DISP_IDLE_STACK, NULL,
+                                             TASK_DISP_IDLE_PRIORITY, &s_task, TASK_DISP_IDLE_CORE);
+    ESP_RETURN_ON_FALSE(res == pdPASS, ESP_ERR_NO_MEM, TAG, "Create task failed");
+    return ESP_OK;
+}
+
+bool display_idle_activity(void)
+{
+    s_last_activity_us = esp_timer_get_time();
+    display_idle_state_t state = s_state;
+    if (state != DISPLAY_IDLE_FULL && s_task) {
+        xTaskNotifyGive(s_task);
+    }
+    return state >= DISPLAY_IDLE_OFF;
+}
+
+void IRAM_ATTR display_idle_activity_from_isr(void)
+{
+    s_last_activity_us = esp_timer_get_time();
+    if (s_state != DISPLAY_IDLE_FULL && s_task) {
+        BaseType_t need_yield = pdFALSE;
+        vTaskNotifyGiveFromISR(s_task, &need_yield);
+        portYIELD_FROM_ISR(need_yield);
+    }
+}
+
+display_idle_state_t display_idle_get_state(void)
+{
+    return s_state;
+}
+
+void display_idle_get_stats(display_idle_stats_t *stats)
+{
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&s_stats_lock);
+    stats->state = s_state;
+    for (int i = 0; i < DISPLAY_IDLE_STATE_COUNT; i++) {
+        stats->residency_us[i] = s_residency_us[i];
+        stats->entries[i] = s_entries[i];
+    }
+    stats->residency_us[s_state] += now - s_state_since_us;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+const char *display_idle_state_name(display_idle_state_t state)
+{
+    return state < DISPLAY_IDLE_STATE_COUNT ? state_names[state] : "?";
+}
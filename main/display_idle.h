@@ -0,0 +1,76 @@
+/**
+ * @file display_idle.h
+ * @brief Staged display power management on user inactivity
+ * @details FULL -> DIM (SH8601 0x51 brightness) -> OFF (display off, LVGL task
+ *          stopped) -> SLEEP (panel sleep-in, 0x10). Any knob, button or touch
+ *          activity brings the display straight back to FULL. Time spent in
+ *          every state is accumulated so the saving can be measured.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_ops.h"
+
+typedef enum {
+    DISPLAY_IDLE_FULL = 0,
+    DISPLAY_IDLE_DIM,
+    DISPLAY_IDLE_OFF,
+    DISPLAY_IDLE_SLEEP,
+    DISPLAY_IDLE_STATE_COUNT,
+} display_idle_state_t;
+
+/**
+ * @brief Called from the idle task before a state change is applied
+ *
+ * @param activity_us Timestamp of the last input; on a wake-up this is the
+ *                    input that caused it.
+ */
+typedef void (*display_idle_transition_cb_t)(display_idle_state_t from, display_idle_state_t to, int64_t activity_us);
+
+typedef struct {
+    esp_lcd_panel_io_handle_t io;
+    esp_lcd_panel_handle_t panel;
+    uint32_t dim_after_ms;      /*!< Inactivity before dimming, 0 to never dim */
+    uint32_t off_after_ms;      /*!< Inactivity before display off, 0 to never */
+    uint32_t sleep_after_ms;    /*!< Inactivity before panel sleep-in, 0 to never */
+    uint8_t full_brightness;
+    uint8_t dim_brightness;
+    display_idle_transition_cb_t on_transition;     /*!< Optional */
+} display_idle_config_t;
+
+typedef struct {
+    display_idle_state_t state;
+    uint64_t residency_us[DISPLAY_IDLE_STATE_COUNT];   /*!< Including the time in the current state */
+    uint32_t entries[DISPLAY_IDLE_STATE_COUNT];
+} display_idle_stats_t;
+
+/**
+ * @brief Start the idle manager task
+ *
+ * @note The display must be up and esp_lvgl_port initialised.
+ */
+esp_err_t display_idle_init(const display_idle_config_t *config);
+
+/**
+ * @brief Report user input
+ *
+ * @return true if the display was off or asleep: the input only woke it and
+ *         should not act on the UI.
+ */
+bool display_idle_activity(void);
+
+/**
+ * @brief Report user input from an interrupt handler (touch INT)
+ */
+void display_idle_activity_from_isr(void);
+
+display_idle_state_t display_idle_get_state(void);
+
+void display_idle_get_stats(display_idle_stats_t *stats);
+
+const char *display_idle_state_name(display_idle_state_t state);
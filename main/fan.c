@@ -0,0 +1,204 @@
+/**
+ * @file fan.c
+ * @brief 4-pin fan PWM outputs on LEDC, one channel per zone
+ */
+
+#include "driver/gpio.h"
+#include "driver/ledc.h"
+#include "esp_check.h"
+#include "esp_err.h"
+#include "esp_idf_version.h"
+#include "esp_sleep.h"
+#include "freertos/FreeRTOS.h"
+
+#include "fan.h"
+
+_Static_assert(FAN_ZONE_MAX <= LEDC_CHANNEL_MAX, "one LEDC channel per zone");
+
+#define FAN_PWM_FREQ_HZ 25000
+#if CONFIG_PM_ENABLE
+/* RC_FAST keeps running in light sleep; ~17.5 MHz / 25 kHz leaves 9 bits */
+#define FAN_PWM_CLK LEDC_USE_RC_FAST_CLK
+#define FAN_PWM_RESOLUTION LEDC_TIMER_9_BIT
+#else
+#define FAN_PWM_CLK LEDC_AUTO_CLK
+#define FAN_PWM_RESOLUTION LEDC_TIMER_10_BIT
+#endif
+#define FAN_PWM_MAX_DUTY ((1 << FAN_PWM_RESOLUTION) - 1)
+
+typedef struct {
+    fan_zone_config_t config;
+    uint16_t curve[FAN_CURVE_POINTS];
+    bool curve_set;
+    bool held;
+    int percent;
+} fan_zone_t;
+
+static const char *TAG = "fan";
+
+/* Knob input arrives on the esp_timer task, curve updates on the calibration task */
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+/* Keeps the duty latches of a group update within one PWM period */
+static portMUX_TYPE s_update_lock = portMUX_INITIALIZER_UNLOCKED;
+static fan_zone_t s_zones[FAN_ZONE_MAX];
+static int s_zone_count = 0;
+
+static esp_err_t config_timer(ledc_timer_t timer)
+{
+    ledc_timer_config_t timer_conf = {
+        .speed_mode = LEDC_LOW_SPEED_MODE,
+        .timer_num = timer,
+        .duty_resolution = FAN_PWM_RESOLUTION,
+        .freq_hz = FAN_PWM_FREQ_HZ,
+        .clk_cfg = FAN_PWM_CLK,
+    };
+    return ledc_timer_config(&timer_conf);
+}
+
+esp_err_t fan_init(const fan_zone_config_t *zones, int count)
+{
+    ESP_RETURN_ON_FALSE(zones && count > 0 && count <= FAN_ZONE_MAX, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    uint32_t timers_done = 0;
+
+    for (int i = 0; i < count; i++) {
+        const fan_zone_config_t *zone = &zones[i];
+        ESP_RETURN_ON_FALSE(zone->timer < LEDC_TIMER_MAX && zone->min_percent <= zone->max_percent &&
+                            zone->max_percent <= 100, ESP_ERR_INVALID_ARG, TAG, "Invalid zone %d", i);
+        if (!(timers_done & BIT(zone->timer))) {
+            ESP_RETURN_ON_ERROR(config_timer(zone->timer), TAG, "timer %d config failed", zone->timer);
+            timers_done |= BIT(zone->timer);
+        }
+
+        ledc_channel_config_t chan_conf = {
+            .gpio_num = zone->gpio_num,
+            .speed_mode = LEDC_LOW_SPEED_MODE,
+            .channel = (ledc_channel_t)i,
+            .timer_sel = zone->timer,
+            .duty = 0,
+            .hpoint = 0,
+#if CONFIG_PM_ENABLE && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 4, 0)
+            .sleep_mode = LEDC_SLEEP_MODE_KEEP_ALIVE,
+#endif
+        };
+        ESP_RETURN_ON_ERROR(ledc_channel_config(&chan_conf), TAG, "zone %d config failed", i);
+#if CONFIG_PM_ENABLE && ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 4, 0)
+        /* Keep the fan spinning through light sleep: pin not switched */
+        ESP_RETURN_ON_ERROR(gpio_sleep_sel_dis(zone->gpio_num), TAG, "zone %d sleep config failed", i);
+#endif
+        s_zones[i] = (fan_zone_t) {
+            .config = *zone,
+        };
+    }
+    s_zone_count = count;
+
+#if CONFIG_PM_ENABLE && ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 4, 0)
+    /* Keep the PWM clock on through light sleep */
+    ESP_RETURN_ON_ERROR(esp_sleep_pd_config(ESP_PD_DOMAIN_RC_FAST, ESP_PD_OPTION_ON), TAG, "sleep config failed");
+#endif
+    return ESP_OK;
+}
+
+int fan_zone_count(void)
+{
+    return s_zone_count;
+}
+
+void fan_zone_limits(int zone, int *min_percent, int *max_percent)
+{
+    *min_percent = s_zones[zone].config.min_percent;
+    *max_percent = s_zones[zone].config.max_percent;
+}
+
+/* Record the percentage; returns false while the zone is held. Call with s_lock held. */
+static bool zone_update(fan_zone_t *z, int percent, uint32_t *duty)
+{
+    if (percent < z->config.min_percent) {
+        percent = z->config.min_percent;
+    }
+    if (percent > z->config.max_percent) {
+        percent = z->config.max_percent;
+    }
+    z->percent = percent;
+    *duty = z->curve_set ? z->curve[percent] : (uint32_t)((percent * FAN_PWM_MAX_DUTY) / 100);
+    return !z->held;
+}
+
+void fan_set_percent(int zone, int percent)
+{
+    uint32_t duty;
+    portENTER_CRITICAL(&s_lock);
+    bool write = zone_update(&s_zones[zone], percent, &duty);
+    portEXIT_CRITICAL(&s_lock);
+    if (write) {
+        fan_set_duty(zone, duty);
+    }
+}
+
+void fan_set_all(const int *percent)
+{
+    uint32_t duty[FAN_ZONE_MAX];
+    bool write[FAN_ZONE_MAX];
+
+    portENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < s_zone_count; i++) {
+        write[i] = zone_update(&s_zones[i], percent[i], &duty[i]);
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    /* Stage every duty first; a channel only picks it up after its update */
+    for (int i = 0; i < s_zone_count; i++) {
+        if (write[i]) {
+            ledc_set_duty(LEDC_LOW_SPEED_MODE, (ledc_channel_t)i, duty[i]);
+        }
+    }
+    portENTER_CRITICAL(&s_update_lock);
+    for (int i = 0; i < s_zone_count; i++) {
+        if (write[i]) {
+            ledc_update_duty(LEDC_LOW_SPEED_MODE, (ledc_channel_t)i);
+        }
+    }
+    portEXIT_CRITICAL(&s_update_lock);
+}
+
+uint32_t fan_get_duty(int zone)
+{
+    return ledc_get_duty(LEDC_LOW_SPEED_MODE, (ledc_channel_t)zone);
+}
+
+uint32_t fan_get_max_duty(void)
+{
+    return FAN_PWM_MAX_DUTY;
+}
+
+void fan_set_curve(int zone, const uint16_t *duty)
+{
+    fan_zone_t *z = &s_zones[zone];
+    portENTER_CRITICAL(&s_lock);
+    if (duty) {
+        for (int i = 0; i < FAN_CURVE_POINTS; i++) {
+            z->curve[i] = duty[i] > FAN_PWM_MAX_DUTY ? FAN_PWM_MAX_DUTY : duty[i];
+        }
+    }
+    z->curve_set = duty != NULL;
+    int percent = z->percent;
+    portEXIT_CRITICAL(&s_lock);
+    fan_set_percent(zone, percent);
+}
+
+void fan_hold(int zone, bool hold)
+{
+    fan_zone_t *z = &s_zones[zone];
+    portENTER_CRITICAL(&s_lock);
+    z->held = hold;
+    int percent = z->percent;
+    portEXIT_CRITICAL(&s_lock);
+    if (!hold) {
+        fan_set_percent(zone, percent);
+    }
+}
+
+void fan_set_duty(int zone, uint32_t duty)
+{
+    ledc_set_duty(LEDC_LOW_SPEED_MODE, (ledc_channel_t)zone, duty > FAN_PWM_MAX_DUTY ? FAN_PWM_MAX_DUTY : duty);
+    ledc_update_duty(LEDC_LOW_SPEED_MODE, (ledc_channel_t)zone);
+}
@@ -0,0 +1,88 @@
+/**
+ * @file fan.h
+ * @brief 4-pin fan PWM outputs, one per fan zone
+ * @details 25 kHz PWM on LEDC, one channel per zone (zone n is channel n).
+ *          Zones either share one timer or each get their own; zones on a
+ *          shared timer also share the period boundary at which a new duty
+ *          takes effect, which fan_set_all() uses to switch them together.
+ *          With power management enabled the timers run from RC_FAST so the
+ *          fans keep their speed through light sleep.
+ *
+ *          The percentage maps to duty linearly until a curve from
+ *          fan_cal.c is set for the zone, then through a 101-entry lookup
+ *          table.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#define FAN_CURVE_POINTS 101
+/* One LEDC channel per zone */
+#define FAN_ZONE_MAX 8
+
+typedef struct {
+    int gpio_num;
+    uint8_t timer;          /*!< LEDC timer; zones may share one */
+    uint8_t min_percent;    /*!< Lowest speed the zone is set to */
+    uint8_t max_percent;    /*!< Highest speed the zone is set to */
+} fan_zone_config_t;
+
+/**
+ * @brief Configure the zones, all outputs off
+ *
+ * @param zones Zone n drives LEDC channel n; copied
+ * @param count 1..FAN_ZONE_MAX
+ */
+esp_err_t fan_init(const fan_zone_config_t *zones, int count);
+
+int fan_zone_count(void);
+
+void fan_zone_limits(int zone, int *min_percent, int *max_percent);
+
+/**
+ * @brief Set one zone, clamped to its limits
+ */
+void fan_set_percent(int zone, int percent);
+
+/**
+ * @brief Set every zone in one group update
+ *
+ * @param percent One value per zone, clamped to the zone limits. The new
+ *                duties are latched together: zones on a shared timer
+ *                switch at the same PWM period, none runs a period with a
+ *                mix of old and new settings.
+ */
+void fan_set_all(const int *percent);
+
+/**
+ * @brief Duty the zone's channel currently outputs, read back from LEDC
+ */
+uint32_t fan_get_duty(int zone);
+
+/**
+ * @brief Duty that gives 100 %, for the current PWM resolution
+ */
+uint32_t fan_get_max_duty(void);
+
+/**
+ * @brief Replace the percent-to-duty mapping of a zone and apply it
+ *
+ * @param duty FAN_CURVE_POINTS duties, one per percent; copied. NULL goes
+ *             back to the linear mapping.
+ */
+void fan_set_curve(int zone, const uint16_t *duty);
+
+/**
+ * @brief Take the output of a zone over for calibration
+ *
+ * While held, fan_set_percent() and fan_set_all() only record the
+ * percentage and fan_set_duty() drives the output; the release applies the
+ * last recorded percentage.
+ */
+void fan_hold(int zone, bool hold);
+
+void fan_set_duty(int zone, uint32_t duty);
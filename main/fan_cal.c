@@ -0,0 +1,296 @@
+/**
+ * @file fan_cal.c
+ * @brief Fan control voltage calibration against the ADC
+ */
+
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_adc/adc_cali.h"
+#include "esp_adc/adc_cali_scheme.h"
+#include "esp_check.h"
+#include "esp_idf_version.h"
+#include "esp_console.h"
+#include "esp_log.h"
+#include "nvs.h"
+
+#include "fan.h"
+#include "fan_cal.h"
+#include "task_topology.h"
+
+#define FAN_CAL_NAMESPACE "fan_cal"
+#define FAN_CAL_KEY "curve"
+#define FAN_CAL_VERSION 1
+/* 10 V at the fan input is 100 % */
+#define FAN_CAL_FULL_SCALE_MV 10000
+/* Duty steps of the sweep, 0 and full duty included */
+#define FAN_CAL_STEPS 21
+/* Output filter of the multiplier plus margin */
+#define FAN_CAL_SETTLE_MS 300
+#define FAN_CAL_SAMPLE_HZ 20000
+#define FAN_CAL_SAMPLES 4096
+#define FAN_CAL_FRAME_BYTES 256
+#define FAN_CAL_POOL_FRAMES 4
+/* Twice the frames FAN_CAL_SAMPLES take; more means the channel is not sampled */
+#define FAN_CAL_MAX_FRAMES (2 * FAN_CAL_SAMPLES * SOC_ADC_DIGI_RESULT_BYTES / FAN_CAL_FRAME_BYTES)
+/* Less swing than this over the sweep means nothing is connected */
+#define FAN_CAL_MIN_SPAN_MV 2000
+
+typedef struct {
+    uint16_t version;
+    uint8_t resolution_bits;
+    uint8_t zone;
+    uint16_t duty[FAN_CURVE_POINTS];
+} fan_cal_blob_t;
+
+static const char *TAG = "fan_cal";
+
+static fan_cal_config_t s_config;
+/* The boot-time run and the console command must not sweep at once */
+static atomic_bool s_busy = false;
+
+static uint8_t resolution_bits(void)
+{
+    return 32 - __builtin_clz(fan_get_max_duty());
+}
+
+static esp_err_t load_curve(fan_cal_blob_t *blob)
+{
+    nvs_handle_t handle;
+    ESP_RETURN_ON_ERROR(nvs_open(FAN_CAL_NAMESPACE, NVS_READONLY, &handle), TAG, "no stored curve");
+    size_t len = sizeof(*blob);
+    esp_err_t err = nvs_get_blob(handle, FAN_CAL_KEY, blob, &len);
+    nvs_close(handle);
+    ESP_RETURN_ON_ERROR(err, TAG, "no stored curve");
+    ESP_RETURN_ON_FALSE(len == sizeof(*blob) && blob->version == FAN_CAL_VERSION &&
+                        blob->resolution_bits == resolution_bits() && blob->zone == s_config.zone,
+                        ESP_ERR_INVALID_VERSION, TAG, "stored curve does not match the PWM setup");
+    return ESP_OK;
+}
+
+static esp_err_t save_curve(const fan_cal_blob_t *blob)
+{
+    nvs_handle_t handle;
+    ESP_RETURN_ON_ERROR(nvs_open(FAN_CAL_NAMESPACE, NVS_READWRITE, &handle), TAG, "nvs_open failed");
+    esp_err_t err = nvs_set_blob(handle, FAN_CAL_KEY, blob, sizeof(*blob));
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return err;
+}
+
+/* Average raw reading of the configured channel over FAN_CAL_SAMPLES */
+static esp_err_t read_average(adc_continuous_handle_t adc, uint32_t *raw)
+{
+    uint8_t frame[FAN_CAL_FRAME_BYTES];
+    uint64_t sum = 0;
+    uint32_t count = 0;
+
+    for (int frames = 0; count < FAN_CAL_SAMPLES; frames++) {
+        ESP_RETURN_ON_FALSE(frames < FAN_CAL_MAX_FRAMES, ESP_ERR_TIMEOUT, TAG, "only %" PRIu32 " samples of channel %d",
+                            count, (int)s_config.channel);
+        uint32_t len = 0;
+        ESP_RETURN_ON_ERROR(adc_continuous_read(adc, frame, sizeof(frame), &len, 100), TAG, "ADC read failed");
+        for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= len; i += SOC_ADC_DIGI_RESULT_BYTES) {
+            const adc_digi_output_data_t *p = (const adc_digi_output_data_t *)&frame[i];
+            if (p->type2.channel == s_config.channel) {
+                sum += p->type2.data;
+                count++;
+            }
+        }
+    }
+    *raw = sum / count;
+    return ESP_OK;
+}
+
+/* The pool still holds what the previous step did not read */
+static esp_err_t start_fresh(adc_continuous_handle_t adc)
+{
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 2, 0)
+    ESP_RETURN_ON_ERROR(adc_continuous_flush_pool(adc), TAG, "ADC flush failed");
+    return adc_continuous_start(adc);
+#else
+    /* No adc_continuous_flush_pool() before 5.2: read the pool out once running */
+    ESP_RETURN_ON_ERROR(adc_continuous_start(adc), TAG, "ADC start failed");
+    uint8_t frame[FAN_CAL_FRAME_BYTES];
+    uint32_t len = 0;
+    for (int i = 0; i < FAN_CAL_POOL_FRAMES; i++) {
+        if (adc_continuous_read(adc, frame, sizeof(frame), &len, 0) != ESP_OK) {
+            break;
+        }
+    }
+    return ESP_OK;
+#endif
+}
+
+static esp_err_t measure(uint32_t duty_at[FAN_CAL_STEPS], int mv_at[FAN_CAL_STEPS])
+{
+    adc_continuous_handle_t adc = NULL;
+    adc_cali_handle_t cali = NULL;
+    esp_err_t ret = ESP_OK;
+
+    adc_continuous_handle_cfg_t handle_cfg = {
+        .max_store_buf_size = FAN_CAL_POOL_FRAMES * FAN_CAL_FRAME_BYTES,
+        .conv_frame_size = FAN_CAL_FRAME_BYTES,
+    };
+    ESP_RETURN_ON_ERROR(adc_continuous_new_handle(&handle_cfg, &adc), TAG, "ADC init failed");
+
+    adc_digi_pattern_config_t pattern = {
+        .atten = ADC_ATTEN_DB_12,
+        .channel = s_config.channel,
+        .unit = ADC_UNIT_1,
+        .bit_width = SOC_ADC_DIGI_MAX_BITWIDTH,
+    };
+    adc_continuous_config_t adc_cfg = {
+        .pattern_num = 1,
+        .adc_pattern = &pattern,
+        .sample_freq_hz = FAN_CAL_SAMPLE_HZ,
+        .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+        .format = ADC_DIGI_OUTPUT_FORMAT_TYPE2,
+    };
+    ESP_GOTO_ON_ERROR(adc_continuous_config(adc, &adc_cfg), out, TAG, "ADC config failed");
+
+    adc_cali_curve_fitting_config_t cali_cfg = {
+        .unit_id = ADC_UNIT_1,
+        .chan = s_config.channel,
+        .atten = ADC_ATTEN_DB_12,
+        .bitwidth = ADC_BITWIDTH_DEFAULT,
+    };
+    ESP_GOTO_ON_ERROR(adc_cali_create_scheme_curve_fitting(&cali_cfg, &cali), out, TAG, "no ADC calibration");
+
+    uint32_t max_duty = fan_get_max_duty();
+    for (int i = 0; i < FAN_CAL_STEPS; i++) {
+        duty_at[i] = max_duty * i / (FAN_CAL_STEPS - 1);
+        fan_set_duty(s_config.zone, duty_at[i]);
+        vTaskDelay(pdMS_TO_TICKS(FAN_CAL_SETTLE_MS));
+
+        uint32_t raw = 0;
+        int pin_mv = 0;
+        ESP_GOTO_ON_ERROR(start_fresh(adc), out, TAG, "ADC start failed");
+        ret = read_average(adc, &raw);
+        adc_continuous_stop(adc);
+        ESP_GOTO_ON_ERROR(ret, out, TAG, "ADC read failed");
+        ESP_GOTO_ON_ERROR(adc_cali_raw_to_voltage(cali, raw, &pin_mv), out, TAG, "ADC conversion failed");
+        mv_at[i] = pin_mv * (int)s_config.divider_x1000 / 1000;
+        ESP_LOGI(TAG, "duty %4" PRIu32 "/%" PRIu32 ": %5d mV", duty_at[i], max_duty, mv_at[i]);
+    }
+
+out:
+    if (cali) {
+        adc_cali_delete_scheme_curve_fitting(cali);
+    }
+    adc_continuous_deinit(adc);
+    return ret;
+}
+
+/* Invert the measured duty-to-voltage points into one duty per percent */
+static esp_err_t build_curve(const uint32_t duty_at[FAN_CAL_STEPS], int mv_at[FAN_CAL_STEPS],
+                             uint16_t duty[FAN_CURVE_POINTS])
+{
+    /* Noise can make a flat stretch dip; the inverse needs it monotonic */
+    for (int i = 1; i < FAN_CAL_STEPS; i++) {
+        if (mv_at[i] < mv_at[i - 1]) {
+            mv_at[i] = mv_at[i - 1];
+        }
+    }
+    ESP_RETURN_ON_FALSE(mv_at[FAN_CAL_STEPS - 1] - mv_at[0] >= FAN_CAL_MIN_SPAN_MV, ESP_ERR_INVALID_RESPONSE, TAG,
+                        "output only spans %d..%d mV, is the sense divider connected?", mv_at[0],
+                        mv_at[FAN_CAL_STEPS - 1]);
+
+    int seg = 0;
+    for (int percent = 0; percent < FAN_CURVE_POINTS; percent++) {
+        int target = percent * FAN_CAL_FULL_SCALE_MV / 100;
+        while (seg < FAN_CAL_STEPS - 2 && mv_at[seg + 1] < target) {
+            seg++;
+        }
+        int v0 = mv_at[seg];
+        int v1 = mv_at[seg + 1];
+        uint32_t d;
+        if (percent == 0 || target <= mv_at[0]) {
+            d = 0;
+        } else if (target >= mv_at[FAN_CAL_STEPS - 1]) {
+            d = duty_at[FAN_CAL_STEPS - 1];
+        } else if (v1 == v0) {
+            d = duty_at[seg];
+        } else {
+            d = duty_at[seg] + (uint32_t)(target - v0) * (duty_at[seg + 1] - duty_at[seg]) / (uint32_t)(v1 - v0);
+        }
+        duty[percent] = d;
+    }
+    return ESP_OK;
+}
+
+esp_err_t fan_cal_run(void)
+{
+    uint32_t duty_at[FAN_CAL_STEPS];
+    int mv_at[FAN_CAL_STEPS];
+    fan_cal_blob_t blob = {
+        .version = FAN_CAL_VERSION,
+        .resolution_bits = resolution_bits(),
+        .zone = s_config.zone,
+    };
+
+    ESP_RETURN_ON_FALSE(!atomic_exchange(&s_busy, true), ESP_ERR_INVALID_STATE, TAG, "already calibrating");
+    ESP_LOGI(TAG, "calibrating zone %d, the fan will sweep its full range", s_config.zone + 1);
+    fan_hold(s_config.zone, true);
+    esp_err_t ret = measure(duty_at, mv_at);
+    if (ret == ESP_OK) {
+        ret = build_curve(duty_at, mv_at, blob.duty);
+    }
+    if (ret == ESP_OK) {
+        fan_set_curve(s_config.zone, blob.duty);
+    }
+    fan_hold(s_config.zone, false);
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "40%% -> duty %u, 80%% -> duty %u", blob.duty[40], blob.duty[80]);
+        ret = save_curve(&blob);
+    }
+    atomic_store(&s_busy, false);
+    return ret;
+}
+
+static void fan_cal_task(void *arg)
+{
+    fan_cal_run();
+    vTaskDelete(NULL);
+}
+
+esp_err_t fan_cal_init(const fan_cal_config_t *config)
+{
+    ESP_RETURN_ON_FALSE(config && config->divider_x1000 && config->zone < fan_zone_count(), ESP_ERR_INVALID_ARG, TAG,
+                        "Invalid argument");
+    s_config = *config;
+
+    fan_cal_blob_t blob;
+    if (load_curve(&blob) == ESP_OK) {
+        fan_set_curve(s_config.zone, blob.duty);
+        return ESP_OK;
+    }
+    /* Measure without holding up the display; the UI runs linear meanwhile */
+    BaseType_t res = xTaskCreatePinnedToCore(fan_cal_task, "fan_cal", TASK_FAN_CAL_STACK, NULL,
+                                             TASK_FAN_CAL_PRIORITY, NULL, TASK_FAN_CAL_CORE);
+    ESP_RETURN_ON_FALSE(res == pdPASS, ESP_ERR_NO_MEM, TAG, "Create task failed");
+    return ESP_OK;
+}
+
+static int cmd_fancal(int argc, char **argv)
+{
+    esp_err_t err = fan_cal_run();
+    printf("%s\n", err == ESP_OK ? "calibrated" : esp_err_to_name(err));
+    return err == ESP_OK ? 0 : 1;
+}
+
+esp_err_t fan_cal_register_console(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "fancal",
+        .help = "Measure the fan output voltage and rebuild the duty curve",
+        .func = cmd_fancal,
+    };
+    return esp_console_cmd_register(&cmd);
+}
@@ -0,0 +1,51 @@
+/**
+ * @file fan_cal.h
+ * @brief Fan control voltage calibration against the ADC
+ * @details The 0-3.3 V PWM goes through an external filter and multiplier
+ *          to the 0-10 V fan input, where 10 V is 100 %. Neither stage is
+ *          exactly linear, so fan_cal sweeps the duty, reads the
+ *          conditioned output back through a divider with the ADC in
+ *          continuous (DMA) mode, and inverts the measured curve into one
+ *          duty per percent. The table is kept in NVS (namespace "fan_cal")
+ *          and handed to fan_set_curve(), so setting a speed stays a table
+ *          lookup. Only the zone wired to the sense divider is measured;
+ *          the others keep the linear mapping.
+ *
+ *          The table is measured again when it is missing or was taken at
+ *          another PWM resolution, and on the console command "fancal".
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_adc/adc_continuous.h"
+#include "esp_err.h"
+
+typedef struct {
+    uint8_t zone;               /*!< Fan zone whose output the divider senses */
+    adc_channel_t channel;      /*!< ADC1 channel of the sense divider */
+    uint32_t divider_x1000;     /*!< Fan input voltage over ADC pin voltage, times 1000 */
+} fan_cal_config_t;
+
+/**
+ * @brief Apply the stored table, or start a calibration in the background
+ *
+ * @note Call after fan_init().
+ */
+esp_err_t fan_cal_init(const fan_cal_config_t *config);
+
+/**
+ * @brief Sweep, measure, store and apply a new table
+ *
+ * Holds the fan output for the whole sweep, a few seconds. On failure the
+ * previous mapping stays in place.
+ */
+esp_err_t fan_cal_run(void);
+
+/**
+ * @brief Add the "fancal" command to the console
+ *
+ * @note Call once the console REPL exists.
+ */
+esp_err_t fan_cal_register_console(void);
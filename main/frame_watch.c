@@ -0,0 +1,322 @@
+/**
+ * @file frame_watch.c
+ * @brief Frame budget watchdog with slow-frame attribution
+ */
+
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_check.h"
+#include "esp_console.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_lvgl_port.h"
+
+#include "frame_watch.h"
+#include "perf_journal.h"
+
+#define FRAME_WATCH_MAX_TASKS 32
+/* lv_freertos.c gives every thread it creates, here the draw units, this name */
+#define FRAME_WATCH_LVGL_THREAD "LVGLthread"
+
+static const char *TAG = "frame_watch";
+
+static const char *const phase_names[FRAME_PHASE_COUNT] = {
+    "render", "flush", "wait", "i2c", "nvs", "load", "jrnl",
+};
+
+/* Phases marked from any task; only ever added to */
+static atomic_uint_least32_t s_phase_total[FRAME_PHASE_COUNT];
+/* Guards the table, which the console reads */
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static struct {
+    volatile uint32_t budget_us;
+    /* LVGL task */
+    int64_t start_us;
+    int64_t flush_start_us;
+    int64_t wait_start_us;
+    uint32_t flush_us;
+    uint32_t wait_us;
+    bool flushed;
+    bool rendering;
+    uint32_t phase_start[FRAME_PHASE_COUNT];
+    TaskStatus_t start_tasks[FRAME_WATCH_MAX_TASKS];
+    UBaseType_t start_count;
+    TaskStatus_t end_tasks[FRAME_WATCH_MAX_TASKS];
+    /* Under s_lock */
+    uint32_t frames;
+    uint32_t slow_frames;
+    frame_watch_entry_t slots[FRAME_WATCH_SLOTS];
+    int used;
+} s_fw;
+
+int64_t frame_watch_phase_begin(void)
+{
+    return esp_timer_get_time();
+}
+
+void frame_watch_phase_end(frame_phase_t phase, int64_t begin_us)
+{
+    atomic_fetch_add_explicit(&s_phase_total[phase], (uint32_t)(esp_timer_get_time() - begin_us),
+                              memory_order_relaxed);
+}
+
+/* Keep the FRAME_WATCH_TOP_TASKS largest run-time deltas, largest first */
+static void rank_task(frame_watch_entry_t *entry, const TaskStatus_t *task, uint32_t run_us)
+{
+    int pos = FRAME_WATCH_TOP_TASKS;
+    while (pos > 0 && (!entry->tasks[pos - 1].name[0] || entry->tasks[pos - 1].run_us < run_us)) {
+        pos--;
+    }
+    if (pos == FRAME_WATCH_TOP_TASKS) {
+        return;
+    }
+    memmove(&entry->tasks[pos + 1], &entry->tasks[pos], (FRAME_WATCH_TOP_TASKS - pos - 1) * sizeof(entry->tasks[0]));
+    frame_watch_task_t *t = &entry->tasks[pos];
+    strlcpy(t->name, task->pcTaskName, sizeof(t->name));
+    t->run_us = run_us;
+    t->core = task->xCoreID == tskNO_AFFINITY ? -1 : task->xCoreID;
+}
+
+/* The frame's own work and idle time are not what slowed it down */
+static bool is_frame_or_idle(const TaskStatus_t *task, TaskHandle_t self)
+{
+    return task->xHandle == self || task->xHandle == xTaskGetIdleTaskHandleForCore(0) ||
+           task->xHandle == xTaskGetIdleTaskHandleForCore(1) ||
+           strcmp(task->pcTaskName, FRAME_WATCH_LVGL_THREAD) == 0;
+}
+
+static void attribute_tasks(frame_watch_entry_t *entry)
+{
+    UBaseType_t n = uxTaskGetSystemState(s_fw.end_tasks, FRAME_WATCH_MAX_TASKS, NULL);
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (UBaseType_t i = 0; i < n; i++) {
+        const TaskStatus_t *task = &s_fw.end_tasks[i];
+        if (is_frame_or_idle(task, self)) {
+            continue;
+        }
+        /* A task created during the frame has run for all of its counter */
+        uint32_t start_rt = 0;
+        for (UBaseType_t j = 0; j < s_fw.start_count; j++) {
+            if (s_fw.start_tasks[j].xHandle == task->xHandle) {
+                start_rt = s_fw.start_tasks[j].ulRunTimeCounter;
+                break;
+            }
+        }
+        uint32_t run_us = (uint32_t)task->ulRunTimeCounter - start_rt;
+        if (run_us) {
+            rank_task(entry, task, run_us);
+        }
+    }
+}
+
+static void frame_end(int64_t now)
+{
+    uint32_t frame_us = now - s_fw.start_us;
+    bool slow = frame_us > s_fw.budget_us;
+    portENTER_CRITICAL(&s_lock);
+    s_fw.frames++;
+    s_fw.slow_frames += slow;
+    portEXIT_CRITICAL(&s_lock);
+    if (!slow) {
+        return;
+    }
+
+    frame_watch_entry_t entry = {
+        .t_us = s_fw.start_us,
+        .frame_us = frame_us,
+    };
+    entry.phase_us[FRAME_PHASE_FLUSH] = s_fw.flush_us;
+    entry.phase_us[FRAME_PHASE_FLUSH_WAIT] = s_fw.wait_us;
+    uint32_t lvgl_us = s_fw.flush_us + s_fw.wait_us;
+    entry.phase_us[FRAME_PHASE_RENDER] = frame_us > lvgl_us ? frame_us - lvgl_us : 0;
+    for (int i = FRAME_PHASE_TOUCH_I2C; i < FRAME_PHASE_COUNT; i++) {
+        entry.phase_us[i] = atomic_load_explicit(&s_phase_total[i], memory_order_relaxed) - s_fw.phase_start[i];
+    }
+    if (s_fw.rendering) {
+        attribute_tasks(&entry);
+    }
+    int worst = 0;
+    for (int i = 1; i < FRAME_PHASE_COUNT; i++) {
+        if (entry.phase_us[i] > entry.phase_us[worst]) {
+            worst = i;
+        }
+    }
+    perf_journal_log(PERF_JOURNAL_FRAME_OVER, frame_us, worst | LV_MIN(entry.phase_us[worst], 0xFFFFFF) << 8);
+
+    portENTER_CRITICAL(&s_lock);
+    int slot = s_fw.used;
+    if (slot < FRAME_WATCH_SLOTS) {
+        s_fw.used++;
+    } else {
+        /* Full: the new frame only goes in over the fastest one kept */
+        slot = 0;
+        for (int i = 1; i < FRAME_WATCH_SLOTS; i++) {
+            if (s_fw.slots[i].frame_us < s_fw.slots[slot].frame_us) {
+                slot = i;
+            }
+        }
+        if (s_fw.slots[slot].frame_us >= frame_us) {
+            slot = -1;
+        }
+    }
+    if (slot >= 0) {
+        s_fw.slots[slot] = entry;
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+/* LVGL task */
+static void disp_event_cb(lv_event_t *e)
+{
+    int64_t now = esp_timer_get_time();
+    switch (lv_event_get_code(e)) {
+    case LV_EVENT_REFR_START:
+        s_fw.start_us = now;
+        s_fw.flush_us = 0;
+        s_fw.wait_us = 0;
+        s_fw.flushed = false;
+        s_fw.rendering = false;
+        for (int i = 0; i < FRAME_PHASE_COUNT; i++) {
+            s_fw.phase_start[i] = atomic_load_explicit(&s_phase_total[i], memory_order_relaxed);
+        }
+        break;
+    case LV_EVENT_RENDER_START:
+        /* Only sent when something was invalidated, so idle refreshes skip the
+         * task list walk; layout time before it is not attributed */
+        s_fw.rendering = true;
+        s_fw.start_count = uxTaskGetSystemState(s_fw.start_tasks, FRAME_WATCH_MAX_TASKS, NULL);
+        break;
+    case LV_EVENT_FLUSH_START:
+        s_fw.flush_start_us = now;
+        s_fw.flushed = true;
+        break;
+    case LV_EVENT_FLUSH_FINISH:
+        s_fw.flush_us += now - s_fw.flush_start_us;
+        break;
+    case LV_EVENT_FLUSH_WAIT_START:
+        s_fw.wait_start_us = now;
+        break;
+    case LV_EVENT_FLUSH_WAIT_FINISH:
+        s_fw.wait_us += now - s_fw.wait_start_us;
+        break;
+    case LV_EVENT_REFR_READY:
+        /* Refreshes with nothing invalidated are not frames */
+        if (s_fw.flushed) {
+            frame_end(now);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+esp_err_t frame_watch_init(const frame_watch_config_t *config)
+{
+    ESP_RETURN_ON_FALSE(config && config->disp && config->budget_us, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    s_fw.budget_us = config->budget_us;
+
+    static const lv_event_code_t codes[] = {
+        LV_EVENT_REFR_START, LV_EVENT_RENDER_START, LV_EVENT_FLUSH_START, LV_EVENT_FLUSH_FINISH,
+        LV_EVENT_FLUSH_WAIT_START, LV_EVENT_FLUSH_WAIT_FINISH, LV_EVENT_REFR_READY,
+    };
+    lvgl_port_lock(0);
+    for (size_t i = 0; i < sizeof(codes) / sizeof(codes[0]); i++) {
+        lv_display_add_event_cb(config->disp, disp_event_cb, codes[i], NULL);
+    }
+    lvgl_port_unlock();
+    return ESP_OK;
+}
+
+static int compare_slower(const void *a, const void *b)
+{
+    const frame_watch_entry_t *ea = a;
+    const frame_watch_entry_t *eb = b;
+    return (ea->frame_us < eb->frame_us) - (ea->frame_us > eb->frame_us);
+}
+
+int frame_watch_get(frame_watch_entry_t *entries, int max)
+{
+    portENTER_CRITICAL(&s_lock);
+    int n = LV_MIN(s_fw.used, max);
+    memcpy(entries, s_fw.slots, n * sizeof(entries[0]));
+    portEXIT_CRITICAL(&s_lock);
+    qsort(entries, n, sizeof(entries[0]), compare_slower);
+    return n;
+}
+
+void frame_watch_clear(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    s_fw.used = 0;
+    s_fw.frames = 0;
+    s_fw.slow_frames = 0;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+static int cmd_frames(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "clear") == 0) {
+        frame_watch_clear();
+        return 0;
+    }
+    if (argc > 2 && strcmp(argv[1], "budget") == 0) {
+        uint32_t ms = strtoul(argv[2], NULL, 10);
+        if (!ms) {
+            printf("budget must be at least 1 ms\n");
+            return 1;
+        }
+        s_fw.budget_us = ms * 1000;
+        frame_watch_clear();
+        return 0;
+    }
+
+    frame_watch_entry_t *entries = malloc(FRAME_WATCH_SLOTS * sizeof(frame_watch_entry_t));
+    if (!entries) {
+        printf("no memory\n");
+        return 1;
+    }
+    portENTER_CRITICAL(&s_lock);
+    uint32_t frames = s_fw.frames;
+    uint32_t slow = s_fw.slow_frames;
+    portEXIT_CRITICAL(&s_lock);
+    int n = frame_watch_get(entries, FRAME_WATCH_SLOTS);
+    printf("budget %" PRIu32 " ms: %" PRIu32 " of %" PRIu32 " frames over, worst %d:\n", s_fw.budget_us / 1000, slow,
+           frames, n);
+    for (int i = 0; i < n; i++) {
+        const frame_watch_entry_t *e = &entries[i];
+        printf("%9.3f s %6.1f ms |", e->t_us / 1e6, e->frame_us / 1000.0);
+        for (int p = 0; p < FRAME_PHASE_COUNT; p++) {
+            if (e->phase_us[p]) {
+                printf(" %s %.1f", phase_names[p], e->phase_us[p] / 1000.0);
+            }
+        }
+        printf(" |");
+        for (int t = 0; t < FRAME_WATCH_TOP_TASKS && e->tasks[t].name[0]; t++) {
+            printf(" %s %.1f", e->tasks[t].name, e->tasks[t].run_us / 1000.0);
+            if (e->tasks[t].core >= 0) {
+                printf("@%d", e->tasks[t].core);
+            }
+        }
+        printf("\n");
+    }
+    free(entries);
+    return 0;
+}
+
+esp_err_t frame_watch_register_console(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "frames",
+        .hint = "[clear|budget <ms>]",
+        .help = "Slowest frames over the budget, by phase and by the other tasks that ran",
+        .func = cmd_frames,
+    };
+    return esp_console_cmd_register(&cmd);
+}
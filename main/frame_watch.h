@@ -0,0 +1,92 @@
+/**
+ * @file frame_watch.h
+ * @brief Frame budget watchdog with slow-frame attribution
+ * @details A frame runs from LV_EVENT_REFR_START to LV_EVENT_REFR_READY of a
+ *          refresh that flushed something. Inside it the LVGL flush events
+ *          split off the time spent in flush_cb and waiting for the panel;
+ *          what is left is rendering. Code elsewhere brackets the known
+ *          stutter suspects with frame_watch_phase_begin()/end() (touch
+ *          I2C, NVS commits, screen loads, journal writes), and the time they took while
+ *          the frame was open is charged to it.
+ *
+ *          Every refresh that renders also snapshots the FreeRTOS run-time
+ *          counters when rendering starts. When a frame ends over the budget,
+ *          the counter deltas name the other tasks that ran meanwhile; the
+ *          LVGL task, its draw unit threads and the idle tasks are left out. The frame goes into a small
+ *          table that keeps only the worst FRAME_WATCH_SLOTS frames, shown
+ *          by the console command "frames".
+ *
+ *          The phase marks are cheap and always on; without
+ *          frame_watch_init() nobody reads them.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "lvgl.h"
+
+#define FRAME_WATCH_SLOTS 8
+#define FRAME_WATCH_TOP_TASKS 3
+#define FRAME_WATCH_TASK_NAME_LEN 16
+
+typedef enum {
+    FRAME_PHASE_RENDER = 0,     /*!< Frame time outside flush_cb and the flush wait */
+    FRAME_PHASE_FLUSH,          /*!< Inside flush_cb */
+    FRAME_PHASE_FLUSH_WAIT,     /*!< LVGL waiting for the panel transfer */
+    FRAME_PHASE_TOUCH_I2C,      /*!< CST820 read */
+    FRAME_PHASE_NVS,            /*!< Settings written to flash */
+    FRAME_PHASE_SCREEN_LOAD,    /*!< lv_screen_load() */
+    FRAME_PHASE_JOURNAL,        /*!< Performance journal written to flash */
+    FRAME_PHASE_COUNT,
+} frame_phase_t;
+
+typedef struct {
+    char name[FRAME_WATCH_TASK_NAME_LEN];
+    uint32_t run_us;            /*!< Run-time counter delta over the frame */
+    int8_t core;                /*!< -1 when not pinned */
+} frame_watch_task_t;
+
+typedef struct {
+    int64_t t_us;               /*!< Frame start */
+    uint32_t frame_us;
+    uint32_t phase_us[FRAME_PHASE_COUNT];
+    frame_watch_task_t tasks[FRAME_WATCH_TOP_TASKS];    /*!< Busiest other tasks, empty names unused */
+} frame_watch_entry_t;
+
+typedef struct {
+    lv_display_t *disp;
+    uint32_t budget_us;
+} frame_watch_config_t;
+
+/**
+ * @note Takes the LVGL port lock itself.
+ */
+esp_err_t frame_watch_init(const frame_watch_config_t *config);
+
+/**
+ * @brief Start of a phase; hand the result to frame_watch_phase_end()
+ */
+int64_t frame_watch_phase_begin(void);
+
+/**
+ * @brief Charge the time since begin_us to a phase; any task, not ISRs
+ */
+void frame_watch_phase_end(frame_phase_t phase, int64_t begin_us);
+
+/**
+ * @brief Copy the recorded frames, slowest first
+ *
+ * @return Number of entries written
+ */
+int frame_watch_get(frame_watch_entry_t *entries, int max);
+
+void frame_watch_clear(void);
+
+/**
+ * @brief Add the "frames" command to the console
+ *
+ * @note Call once the console REPL exists.
+ */
+esp_err_t frame_watch_register_console(void);
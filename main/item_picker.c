@@ -0,0 +1,63 @@
+/**
+ * @file item_picker.c
+ * @brief Knob-driven picker over a static table of short labels
+ */
+
+#include "cell_grid.h"
+#include "item_picker.h"
+
+#define ITEM_PICKER_PAD_HOR 8
+
+typedef struct {
+    cell_grid_t grid;
+    const char *const *items;
+} item_picker_t;
+
+static const char *item_text(const cell_grid_t *grid, uint16_t index, char *buf, size_t size)
+{
+    const item_picker_t *ip = (const item_picker_t *)grid;
+    return ip->items[index];
+}
+
+lv_obj_t *item_picker_create(lv_obj_t *parent, const lv_font_t *font, const char *const *items, uint16_t count,
+                             uint8_t columns, uint8_t rows)
+{
+    item_picker_t *ip = lv_malloc_zeroed(sizeof(item_picker_t));
+    if (!ip) {
+        return NULL;
+    }
+    ip->items = items;
+    ip->grid.font = font;
+    ip->grid.text_cb = item_text;
+    ip->grid.count = count;
+    ip->grid.columns = columns;
+    ip->grid.rows = rows;
+    for (uint16_t i = 0; i < count; i++) {
+        ip->grid.cell_w = LV_MAX(ip->grid.cell_w, lv_text_get_width(items[i], LV_TEXT_LEN_MAX, font, 0));
+    }
+    ip->grid.cell_w += 2 * ITEM_PICKER_PAD_HOR;
+    ip->grid.cell_h = lv_font_get_line_height(font) + 2 * CELL_GRID_PAD_VER;
+    return cell_grid_create(parent, &ip->grid);
+}
+
+void item_picker_set_selected(lv_obj_t *obj, uint16_t index)
+{
+    item_picker_t *ip = lv_obj_get_user_data(obj);
+    cell_grid_set_selected(obj, &ip->grid, index);
+}
+
+uint16_t item_picker_get_selected(const lv_obj_t *obj)
+{
+    const item_picker_t *ip = lv_obj_get_user_data((lv_obj_t *)obj);
+    return ip->grid.selected;
+}
+
+void item_picker_step(lv_obj_t *obj, int32_t delta)
+{
+    item_picker_t *ip = lv_obj_get_user_data(obj);
+    int32_t index = (ip->grid.selected + delta) % ip->grid.count;
+    if (index < 0) {
+        index += ip->grid.count;
+    }
+    cell_grid_set_selected(obj, &ip->grid, index);
+}
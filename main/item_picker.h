@@ -0,0 +1,37 @@
+/**
+ * @file item_picker.h
+ * @brief Knob-driven picker over a static table of short labels
+ * @details Replaces lv_roller for the language and owner name screens. The
+ *          widget keeps an index into a caller-owned table instead of a
+ *          newline-joined copy of the options, and draws a grid of fixed
+ *          cells: only the visible rows are drawn, and a step inside the
+ *          visible window invalidates just the old and the new selected
+ *          cell. The window moves by whole rows when the selection leaves it.
+ *
+ *          Labels use the font given at creation and the text_color of
+ *          LV_PART_MAIN; the selected cell uses the background and text
+ *          colour of LV_PART_SELECTED.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "lvgl.h"
+
+/**
+ * @param items   Labels, must outlive the widget
+ * @param columns Cells per row
+ * @param rows    Visible rows
+ */
+lv_obj_t *item_picker_create(lv_obj_t *parent, const lv_font_t *font, const char *const *items, uint16_t count,
+                             uint8_t columns, uint8_t rows);
+
+void item_picker_set_selected(lv_obj_t *obj, uint16_t index);
+
+uint16_t item_picker_get_selected(const lv_obj_t *obj);
+
+/**
+ * @brief Move the selection by delta items, wrapping around at both ends
+ */
+void item_picker_step(lv_obj_t *obj, int32_t delta);
@@ -0,0 +1,180 @@
+/**
+ * @file latency_trace.c
+ * @brief Input-to-photon latency of knob input
+ */
+
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "latency_trace.h"
+
+#define LATENCY_TRACE_BUCKET_US 250
+#define LATENCY_TRACE_BUCKETS 256
+/* Inputs can pile up between two refreshes when the knob spins fast */
+#define LATENCY_TRACE_QUEUE 16
+#define LATENCY_TRACE_LOG_EVERY 100
+
+static const char *TAG = "latency";
+
+/* Set and consumed by the input callback path */
+static int64_t s_input_us = 0;
+
+/* Committed, not yet rendered; LVGL lock */
+static int64_t s_pending[LATENCY_TRACE_QUEUE];
+static int s_pending_cnt = 0;
+
+/* Rendering in the current frame; handed to the frame-done callback */
+static int64_t s_latched[LATENCY_TRACE_QUEUE];
+static atomic_int s_latched_cnt = 0;
+
+/* Current refresh flushed something; LVGL task */
+static bool s_flushed = false;
+/* Flushes are kept off the panel; LVGL lock */
+static bool s_held = false;
+
+static uint32_t s_hist[LATENCY_TRACE_BUCKETS];
+static uint32_t s_count = 0;
+static uint32_t s_overflow = 0;
+static uint32_t s_dropped = 0;
+static uint32_t s_min_us = UINT32_MAX;
+static uint32_t s_max_us = 0;
+static uint32_t s_logged_count = 0;
+
+void latency_trace_input(void)
+{
+    s_input_us = esp_timer_get_time();
+}
+
+void latency_trace_commit(void)
+{
+    if (!s_input_us) {
+        return;
+    }
+    if (s_pending_cnt < LATENCY_TRACE_QUEUE) {
+        s_pending[s_pending_cnt++] = s_input_us;
+    } else {
+        s_dropped++;
+    }
+    s_input_us = 0;
+}
+
+static uint32_t percentile(uint32_t count, uint32_t pct)
+{
+    uint32_t rank = (count * pct + 99) / 100;
+    uint32_t seen = 0;
+    for (int i = 0; i < LATENCY_TRACE_BUCKETS; i++) {
+        seen += s_hist[i];
+        if (seen >= rank) {
+            return (i + 1) * LATENCY_TRACE_BUCKET_US;
+        }
+    }
+    return s_max_us;
+}
+
+void latency_trace_get_stats(latency_trace_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->count = s_count;
+    stats->overflow = s_overflow;
+    stats->dropped = s_dropped;
+    if (!s_count) {
+        return;
+    }
+    stats->min_us = s_min_us;
+    stats->max_us = s_max_us;
+    stats->p50_us = percentile(s_count, 50);
+    stats->p99_us = percentile(s_count, 99);
+}
+
+/* At the first flush of a refresh: only a refresh that sends pixels closes
+ * stamps, and by now every REFR_START handler has set up the hold */
+static void latch(void)
+{
+    /* The previous frame is still on its way, its inputs are not closed yet */
+    if (s_pending_cnt && atomic_load(&s_latched_cnt) == 0) {
+        memcpy(s_latched, s_pending, s_pending_cnt * sizeof(s_pending[0]));
+        atomic_store(&s_latched_cnt, s_pending_cnt);
+        s_pending_cnt = 0;
+    }
+}
+
+static void refr_start(void)
+{
+    s_flushed = false;
+
+    if (s_count - s_logged_count >= LATENCY_TRACE_LOG_EVERY) {
+        latency_trace_stats_t stats;
+        latency_trace_get_stats(&stats);
+        s_logged_count = s_count;
+        ESP_LOGI(TAG, "input-to-photon n=%" PRIu32 " min %" PRIu32 " p50 %" PRIu32 " p99 %" PRIu32 " max %" PRIu32 " us",
+                 stats.count, stats.min_us, stats.p50_us, stats.p99_us, stats.max_us);
+    }
+}
+
+static void refr_event_cb(lv_event_t *e)
+{
+    switch (lv_event_get_code(e)) {
+    case LV_EVENT_REFR_START:
+        refr_start();
+        break;
+    case LV_EVENT_FLUSH_START:
+        if (!s_flushed) {
+            s_flushed = true;
+            /* Held frames never reach the panel; the stamps wait for one that does */
+            if (!s_held) {
+                latch();
+            }
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void IRAM_ATTR latency_trace_frame_done(int64_t done_us, void *arg)
+{
+    int n = atomic_load(&s_latched_cnt);
+    for (int i = 0; i < n; i++) {
+        uint32_t latency = (uint32_t)(done_us - s_latched[i]);
+        uint32_t bucket = latency / LATENCY_TRACE_BUCKET_US;
+        if (bucket < LATENCY_TRACE_BUCKETS) {
+            s_hist[bucket]++;
+        } else {
+            s_overflow++;
+        }
+        s_min_us = latency < s_min_us ? latency : s_min_us;
+        s_max_us = latency > s_max_us ? latency : s_max_us;
+        s_count++;
+    }
+    if (n) {
+        atomic_store(&s_latched_cnt, 0);
+    }
+}
+
+void latency_trace_set_held(bool held)
+{
+    s_held = held;
+}
+
+void latency_trace_reset(void)
+{
+    memset(s_hist, 0, sizeof(s_hist));
+    s_count = 0;
+    s_overflow = 0;
+    s_dropped = 0;
+    s_min_us = UINT32_MAX;
+    s_max_us = 0;
+    s_logged_count = 0;
+}
+
+void latency_trace_attach(lv_display_t *disp)
+{
+    lv_display_add_event_cb(disp, refr_event_cb, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(disp, refr_event_cb, LV_EVENT_FLUSH_START, NULL);
+}
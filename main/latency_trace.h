@@ -0,0 +1,67 @@
+/**
+ * @file latency_trace.h
+ * @brief Input-to-photon latency of knob input
+ * @details An input callback stamps the event (latency_trace_input()). If
+ *          handling it changed the UI, the stamp is committed under the LVGL
+ *          lock. The next LVGL refresh that flushes to the panel picks up
+ *          the committed stamps at its first flush, and the completion of
+ *          the last panel transfer of that frame closes them. Refreshes that
+ *          flush nothing, or flush while held off the panel, leave them
+ *          waiting.
+ *          Latencies go into a fixed histogram of 250 us buckets up to 64 ms.
+ *
+ *          No RTOS dependency, the host simulator uses it as well.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lvgl.h"
+
+typedef struct {
+    uint32_t count;
+    uint32_t overflow;      /*!< Samples above the histogram range */
+    uint32_t dropped;       /*!< Inputs committed while the queue was full */
+    uint32_t min_us;
+    uint32_t max_us;
+    uint32_t p50_us;        /*!< Upper edge of the bucket holding the median */
+    uint32_t p99_us;
+} latency_trace_stats_t;
+
+/**
+ * @brief Hook the refresh events of the display
+ *
+ * @note Call with the LVGL lock held. latency_trace_frame_done() still has
+ *       to be wired to the end of the frame transfer.
+ */
+void latency_trace_attach(lv_display_t *disp);
+
+/**
+ * @brief Stamp the input event that is being handled now
+ */
+void latency_trace_input(void);
+
+/**
+ * @brief The stamped input changed the UI; call with the LVGL lock held
+ */
+void latency_trace_commit(void);
+
+/**
+ * @brief Flushes are kept off the panel, see disp_flush_set_hold()
+ *
+ * Stamps are not picked up by held refreshes. Call with the LVGL lock held.
+ */
+void latency_trace_set_held(bool held);
+
+/**
+ * @brief Last transfer of a frame reached the panel
+ *
+ * Matches disp_flush_frame_cb_t; safe from the panel IO interrupt.
+ */
+void latency_trace_frame_done(int64_t done_us, void *arg);
+
+void latency_trace_get_stats(latency_trace_stats_t *stats);
+
+void latency_trace_reset(void);
@@ -13,6 +13,7 @@
  * @version 1.0
  */
 
+#include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -20,7 +21,6 @@
 #include "freertos/task.h"
 #include "driver/gpio.h"
 #include "driver/i2c.h"
-#include "driver/ledc.h"
 #include "driver/spi_master.h"
 #include "esp_timer.h"
 #include "esp_lcd_panel_io.h"
@@ -29,7 +29,7 @@
 #include "esp_err.h"
 #include "esp_log.h"
 #include "esp_check.h"
-#include "nvs.h"
+#include "esp_attr.h"
 #include "nvs_flash.h"
 
 #include "lvgl.h"
@@ -41,6 +41,24 @@
 #include "esp_lvgl_port.h"
 #include "esp_lcd_sh8601.h"
 #include "esp_lcd_touch_cst820.h"
+#include "ui.h"
+#include "ctl_link.h"
+#include "fan.h"
+#include "fan_cal.h"
+#include "frame_watch.h"
+#include "disp_flush.h"
+#include "display_idle.h"
+#include "power_mgmt.h"
+#include "qspi_bench.h"
+#include "screen_cache.h"
+#include "latency_trace.h"
+#include "perf_console.h"
+#include "perf_journal.h"
+#include "task_topology.h"
+#include "assets.h"
+#if CONFIG_EXAMPLE_LVGL_BENCHMARK
+#include "lv_demos.h"
+#endif
 
 //***************** */
 
@@ -60,8 +78,7 @@ static esp_lcd_panel_handle_t lcd_panel = NULL;
 static lv_display_t *lvgl_disp = NULL;
 static lv_indev_t *lvgl_touch_indev = NULL;
 static esp_lcd_touch_handle_t touch_handle = NULL;
-static esp_timer_handle_t boot_timer = NULL;
-static esp_timer_handle_t click_timer = NULL;
+static int lcd_draw_buff_rows = EXAMPLE_LCD_DRAW_BUFF_HEIGHT;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// Please update the following configuration according to your LCD spec //////////////////////////////
@@ -70,7 +87,8 @@ static esp_timer_handle_t click_timer = NULL;
 #define EXAMPLE_LCD_BITS_PER_PIXEL (16)
 #define EXAMPLE_LCD_DRAW_BUFF_DOUBLE (1)
 #define EXAMPLE_LCD_LVGL_AVOID_TEAR (1)
-#define EXAMPLE_LCD_DRAW_BUFF_HEIGHT (60)
+#define EXAMPLE_LCD_DRAW_BUFF_HEIGHT (60) /* Until a QSPI benchmark run stored a better one */
+#define EXAMPLE_LCD_PCLK_HZ (80 * 1000 * 1000)
 #define EXAMPLE_LCD_BK_LIGHT_ON_LEVEL 1
 #define EXAMPLE_LCD_BK_LIGHT_OFF_LEVEL !EXAMPLE_LCD_BK_LIGHT_ON_LEVEL
 #define EXAMPLE_PIN_NUM_LCD_CS (GPIO_NUM_12)
@@ -117,151 +135,47 @@ typedef enum
 #define BSP_ENCODER_A (GPIO_NUM_6)
 #define BSP_ENCODER_B (GPIO_NUM_5)
 #define BSP_FAN_PWM (GPIO_NUM_45)
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// UI/UX configuration ///////////////////////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-#define FAN_SPEED_MIN_PERCENT 40
-#define FAN_SPEED_MAX_PERCENT 80
-#define FAN_SPEED_DEFAULT_PERCENT 65
-#define FAN_PWM_FREQ_HZ 25000
-#define FAN_PWM_RESOLUTION LEDC_TIMER_10_BIT
-#define FAN_PWM_MAX_DUTY ((1 << 10) - 1)
-#define OWNER_NAME_MAX_LEN 16
-#define CLICK_WINDOW_US (800 * 1000)
-
-typedef enum {
-    UI_SCREEN_BOOT = 0,
-    UI_SCREEN_MAIN,
-    UI_SCREEN_SETTINGS,
-    UI_SCREEN_LANGUAGE,
-    UI_SCREEN_OWNER,
-} ui_screen_t;
-
-typedef enum {
-    LANG_EN = 0,
-    LANG_RU,
-    LANG_ET,
-    LANG_DE,
-    LANG_FI,
-    LANG_LV,
-    LANG_LT,
-    LANG_ES,
-    LANG_COUNT,
-} ui_lang_t;
-
-static ui_screen_t ui_screen = UI_SCREEN_BOOT;
-static ui_lang_t current_lang = LANG_EN;
-static bool ui_locked = false;
-static int fan_speed_percent = FAN_SPEED_DEFAULT_PERCENT;
-static int settings_index = 0;
-static size_t owner_name_len = 0;
-static char owner_name[OWNER_NAME_MAX_LEN + 1] = "";
-static int click_count = 0;
-static bool suppress_click = false;
 
-static lv_obj_t *boot_screen = NULL;
-static lv_obj_t *main_screen = NULL;
-static lv_obj_t *settings_screen = NULL;
-static lv_obj_t *language_screen = NULL;
-static lv_obj_t *owner_screen = NULL;
-static lv_obj_t *label_speed = NULL;
-static lv_obj_t *label_speed_caption = NULL;
-static lv_obj_t *arc_speed = NULL;
-static lv_obj_t *lock_overlay = NULL;
-static lv_obj_t *settings_items[2] = {0};
-static lv_obj_t *label_settings_title = NULL;
-static lv_obj_t *label_language_title = NULL;
-static lv_obj_t *label_owner_title = NULL;
-static lv_obj_t *roller_language = NULL;
-static lv_obj_t *label_owner_value = NULL;
-static lv_obj_t *roller_owner = NULL;
-
-static const char *language_names[LANG_COUNT] = {
-    "English",
-    "Русский",
-    "Eesti",
-    "Deutsch",
-    "Suomi",
-    "Latviešu",
-    "Lietuviu",
-    "Español",
+/* Zone n (1-based) takes its pin and knob range from the Kconfig options of that zone */
+#if CONFIG_EXAMPLE_FAN_ZONES_SHARED_TIMER || CONFIG_EXAMPLE_FAN_ZONES == 1
+#define FAN_ZONE_TIMER(n) 0
+#else
+/* Four LEDC timers */
+#define FAN_ZONE_TIMER(n) (((n) - 1) % 4)
+#endif
+#define FAN_ZONE(n, gpio) { \
+    .gpio_num = (gpio), .timer = FAN_ZONE_TIMER(n), \
+    .min_percent = CONFIG_EXAMPLE_FAN_ZONE##n##_MIN_PERCENT, .max_percent = CONFIG_EXAMPLE_FAN_ZONE##n##_MAX_PERCENT }
+
+static const fan_zone_config_t fan_zones[] = {
+    FAN_ZONE(1, BSP_FAN_PWM),
+#if CONFIG_EXAMPLE_FAN_ZONES >= 2
+    FAN_ZONE(2, CONFIG_EXAMPLE_FAN_ZONE2_GPIO),
+#endif
+#if CONFIG_EXAMPLE_FAN_ZONES >= 3
+    FAN_ZONE(3, CONFIG_EXAMPLE_FAN_ZONE3_GPIO),
+#endif
+#if CONFIG_EXAMPLE_FAN_ZONES >= 4
+    FAN_ZONE(4, CONFIG_EXAMPLE_FAN_ZONE4_GPIO),
+#endif
+#if CONFIG_EXAMPLE_FAN_ZONES >= 5
+    FAN_ZONE(5, CONFIG_EXAMPLE_FAN_ZONE5_GPIO),
+#endif
+#if CONFIG_EXAMPLE_FAN_ZONES >= 6
+    FAN_ZONE(6, CONFIG_EXAMPLE_FAN_ZONE6_GPIO),
+#endif
+#if CONFIG_EXAMPLE_FAN_ZONES >= 7
+    FAN_ZONE(7, CONFIG_EXAMPLE_FAN_ZONE7_GPIO),
+#endif
+#if CONFIG_EXAMPLE_FAN_ZONES >= 8
+    FAN_ZONE(8, CONFIG_EXAMPLE_FAN_ZONE8_GPIO),
+#endif
 };
 
-typedef struct {
-    const char *fan_speed;
-    const char *settings;
-    const char *language;
-    const char *owner_name;
-    const char *locked;
-    const char *unlocked;
-} ui_strings_t;
-
-static const ui_strings_t ui_strings[LANG_COUNT] = {
-    [LANG_EN] = {
-        .fan_speed = "Fan speed",
-        .settings = "Settings",
-        .language = "Language",
-        .owner_name = "Owner name",
-        .locked = "Locked",
-        .unlocked = "Unlocked",
-    },
-    [LANG_RU] = {
-        .fan_speed = "Скорость",
-        .settings = "Настройки",
-        .language = "Язык",
-        .owner_name = "Имя владельца",
-        .locked = "Заблокировано",
-        .unlocked = "Разблокировано",
-    },
-    [LANG_ET] = {
-        .fan_speed = "Ventilaator",
-        .settings = "Seaded",
-        .language = "Keel",
-        .owner_name = "Omaniku nimi",
-        .locked = "Lukus",
-        .unlocked = "Avatud",
-    },
-    [LANG_DE] = {
-        .fan_speed = "Luefter",
-        .settings = "Einstellungen",
-        .language = "Sprache",
-        .owner_name = "Besitzername",
-        .locked = "Gesperrt",
-        .unlocked = "Entsperrt",
-    },
-    [LANG_FI] = {
-        .fan_speed = "Tuuletin",
-        .settings = "Asetukset",
-        .language = "Kieli",
-        .owner_name = "Omistaja",
-        .locked = "Lukittu",
-        .unlocked = "Avattu",
-    },
-    [LANG_LV] = {
-        .fan_speed = "Ventilators",
-        .settings = "Iestatījumi",
-        .language = "Valoda",
-        .owner_name = "Īpašnieks",
-        .locked = "Bloķēts",
-        .unlocked = "Atbloķēts",
-    },
-    [LANG_LT] = {
-        .fan_speed = "Ventiliatorius",
-        .settings = "Nustatymai",
-        .language = "Kalba",
-        .owner_name = "Savininko vardas",
-        .locked = "Užrakinta",
-        .unlocked = "Atrakinta",
-    },
-    [LANG_ES] = {
-        .fan_speed = "Ventilador",
-        .settings = "Ajustes",
-        .language = "Idioma",
-        .owner_name = "Propietario",
-        .locked = "Bloqueado",
-        .unlocked = "Desbloqueado",
-    },
-};
+/* Button press bookkeeping: a long press or a wake-up press is not a click */
+static bool suppress_click = false;
+static bool wake_press = false;
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// Please update the following configuration according to LVGL ///////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -293,7 +207,7 @@ void my_print(lv_log_level_t level, const char *buf)
         lvl = ESP_LOG_ERROR;
         break;
     case LV_LOG_LEVEL_USER:
-        lvl = ESP_LOG_DEBUG;
+        lvl = ESP_LOG_INFO;
         break;
     case LV_LOG_LEVEL_NONE:
         lvl = ESP_LOG_NONE;
@@ -302,193 +216,85 @@ void my_print(lv_log_level_t level, const char *buf)
     ESP_LOG_LEVEL(lvl, TAG, "%s", buf);
 }
 
-static void init_pwm_fan(void)
-{
-    ledc_timer_config_t timer_conf = {
-        .speed_mode = LEDC_LOW_SPEED_MODE,
-        .timer_num = LEDC_TIMER_0,
-        .duty_resolution = FAN_PWM_RESOLUTION,
-        .freq_hz = FAN_PWM_FREQ_HZ,
-        .clk_cfg = LEDC_AUTO_CLK,
-    };
-    ESP_ERROR_CHECK(ledc_timer_config(&timer_conf));
-
-    ledc_channel_config_t chan_conf = {
-        .gpio_num = BSP_FAN_PWM,
-        .speed_mode = LEDC_LOW_SPEED_MODE,
-        .channel = LEDC_CHANNEL_0,
-        .timer_sel = LEDC_TIMER_0,
-        .duty = 0,
-        .hpoint = 0,
-    };
-    ESP_ERROR_CHECK(ledc_channel_config(&chan_conf));
-}
-
-static void apply_fan_pwm(int percent)
-{
-    if (percent < 0) {
-        percent = 0;
-    }
-    if (percent > 100) {
-        percent = 100;
-    }
-    uint32_t duty = (uint32_t)((percent * FAN_PWM_MAX_DUTY) / 100);
-    ledc_set_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0, duty);
-    ledc_update_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0);
-}
-
-static void save_owner_name(void)
-{
-    nvs_handle_t handle;
-    if (nvs_open("settings", NVS_READWRITE, &handle) == ESP_OK) {
-        nvs_set_str(handle, "owner", owner_name);
-        nvs_commit(handle);
-        nvs_close(handle);
-    }
-}
-
-static void save_language(void)
-{
-    nvs_handle_t handle;
-    if (nvs_open("settings", NVS_READWRITE, &handle) == ESP_OK) {
-        nvs_set_u8(handle, "lang", (uint8_t)current_lang);
-        nvs_commit(handle);
-        nvs_close(handle);
-    }
-}
-
-static void load_settings(void)
-{
-    nvs_handle_t handle;
-    if (nvs_open("settings", NVS_READONLY, &handle) == ESP_OK) {
-        uint8_t lang = 0;
-        if (nvs_get_u8(handle, "lang", &lang) == ESP_OK && lang < LANG_COUNT) {
-            current_lang = (ui_lang_t)lang;
-        }
-        size_t len = sizeof(owner_name);
-        if (nvs_get_str(handle, "owner", owner_name, &len) == ESP_OK) {
-            owner_name_len = strnlen(owner_name, sizeof(owner_name) - 1);
-        }
-        nvs_close(handle);
-    }
-}
-
-static void update_main_ui(void)
-{
-    if (!label_speed || !arc_speed) {
-        return;
-    }
-    char speed_text[8];
-    snprintf(speed_text, sizeof(speed_text), "%d%%", fan_speed_percent);
-    lv_label_set_text(label_speed, speed_text);
-    lv_arc_set_value(arc_speed, fan_speed_percent);
-    if (label_speed_caption) {
-        lv_label_set_text(label_speed_caption, ui_strings[current_lang].fan_speed);
-    }
-}
+/* Poll while a finger is down, so the lift is seen without an INT edge */
+#define TOUCH_RELEASE_POLL_MS 20
 
-static void apply_language(void)
-{
-    if (label_speed_caption) {
-        lv_label_set_text(label_speed_caption, ui_strings[current_lang].fan_speed);
-    }
-    if (label_settings_title) {
-        lv_label_set_text(label_settings_title, ui_strings[current_lang].settings);
-    }
-    if (label_language_title) {
-        lv_label_set_text(label_language_title, ui_strings[current_lang].language);
-    }
-    if (label_owner_title) {
-        lv_label_set_text(label_owner_title, ui_strings[current_lang].owner_name);
-    }
-    if (settings_items[0]) {
-        lv_label_set_text(settings_items[0], ui_strings[current_lang].language);
-    }
-    if (settings_items[1]) {
-        lv_label_set_text(settings_items[1], ui_strings[current_lang].owner_name);
-    }
-}
+/* Latest CST820 report, written by the touch task on the I/O core */
+static portMUX_TYPE touch_lock = portMUX_INITIALIZER_UNLOCKED;
+static struct {
+    uint16_t x;
+    uint16_t y;
+    bool pressed;
+    bool tapped;    /* Pressed at some point since LVGL last looked */
+} touch_state;
+static TaskHandle_t touch_task_handle = NULL;
 
-static void set_lock_overlay(bool enabled)
+static void IRAM_ATTR touch_isr_cb(esp_lcd_touch_handle_t tp)
 {
-    if (!lock_overlay) {
-        return;
-    }
-    if (enabled) {
-        lv_obj_clear_flag(lock_overlay, LV_OBJ_FLAG_HIDDEN);
-    } else {
-        lv_obj_add_flag(lock_overlay, LV_OBJ_FLAG_HIDDEN);
+    BaseType_t need_yield = pdFALSE;
+    power_mgmt_touch_isr();
+    display_idle_activity_from_isr();
+    if (touch_task_handle) {
+        vTaskNotifyGiveFromISR(touch_task_handle, &need_yield);
     }
+    portYIELD_FROM_ISR(need_yield);
 }
 
-static void update_settings_selection(void)
+/* Journal the first failure of a run of failed reads and the recovery */
+static void journal_touch_read(esp_err_t err)
 {
-    for (int i = 0; i < 2; ++i) {
-        if (!settings_items[i]) {
-            continue;
-        }
-        if (i == settings_index) {
-            lv_obj_set_style_text_color(settings_items[i], lv_color_white(), 0);
-            lv_obj_set_style_bg_opa(settings_items[i], LV_OPA_40, 0);
-        } else {
-            lv_obj_set_style_text_color(settings_items[i], lv_color_gray(), 0);
-            lv_obj_set_style_bg_opa(settings_items[i], LV_OPA_TRANSP, 0);
+    static uint32_t failures;
+    static int64_t failed_since_us;
+    if (err != ESP_OK) {
+        if (!failures++) {
+            failed_since_us = esp_timer_get_time();
+            perf_journal_log(PERF_JOURNAL_I2C_ERROR, err, 0);
         }
+    } else if (failures) {
+        perf_journal_log(PERF_JOURNAL_I2C_RECOVERED, failures, (esp_timer_get_time() - failed_since_us) / 1000);
+        failures = 0;
     }
 }
 
-static void show_screen(lv_obj_t *screen)
+/* I2C reads stay off the render core; LVGL only picks up the result */
+static void touch_task(void *arg)
 {
-    if (screen) {
-        lv_scr_load(screen);
-    }
-}
+    bool pressed = false;
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pressed ? pdMS_TO_TICKS(TOUCH_RELEASE_POLL_MS) : portMAX_DELAY);
 
-static void boot_timer_cb(void *arg)
-{
-    lvgl_port_lock(0);
-    ui_screen = UI_SCREEN_MAIN;
-    show_screen(main_screen);
-    set_lock_overlay(ui_locked);
-    update_main_ui();
-    lvgl_port_unlock();
-}
+        uint16_t x = 0;
+        uint16_t y = 0;
+        uint8_t count = 0;
+        int64_t t = frame_watch_phase_begin();
+        esp_err_t err = esp_lcd_touch_read_data(touch_handle);
+        frame_watch_phase_end(FRAME_PHASE_TOUCH_I2C, t);
+        journal_touch_read(err);
+#if CONFIG_EXAMPLE_PERF_CONSOLE
+        perf_console_count_i2c(err);
+#endif
+        pressed = err == ESP_OK && esp_lcd_touch_get_coordinates(touch_handle, &x, &y, NULL, &count, 1) && count > 0;
 
-static void click_timer_cb(void *arg)
-{
-    int count = click_count;
-    click_count = 0;
-    if (count == 1) {
-        lvgl_port_lock(0);
-        if (ui_screen == UI_SCREEN_MAIN) {
-            ui_locked = !ui_locked;
-            set_lock_overlay(ui_locked);
-        } else {
-            handle_single_click();
-        }
-        lvgl_port_unlock();
-    } else if (count == 3) {
-        if (ui_screen == UI_SCREEN_MAIN) {
-            ui_screen = UI_SCREEN_SETTINGS;
-            lvgl_port_lock(0);
-            show_screen(settings_screen);
-            update_settings_selection();
-            lvgl_port_unlock();
+        portENTER_CRITICAL(&touch_lock);
+        if (pressed) {
+            touch_state.x = x;
+            touch_state.y = y;
+            touch_state.tapped = true;
         }
+        touch_state.pressed = pressed;
+        portEXIT_CRITICAL(&touch_lock);
     }
 }
 
-static void start_click_timer(void)
+static void touch_read_cb(lv_indev_t *indev, lv_indev_data_t *data)
 {
-    if (!click_timer) {
-        esp_timer_create_args_t timer_args = {
-            .callback = &click_timer_cb,
-            .name = "click_timer",
-        };
-        ESP_ERROR_CHECK(esp_timer_create(&timer_args, &click_timer));
-    }
-    esp_timer_stop(click_timer);
-    ESP_ERROR_CHECK(esp_timer_start_once(click_timer, CLICK_WINDOW_US));
+    portENTER_CRITICAL(&touch_lock);
+    data->point.x = touch_state.x;
+    data->point.y = touch_state.y;
+    /* A tap shorter than the indev period still reaches LVGL once */
+    data->state = touch_state.pressed || touch_state.tapped ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+    touch_state.tapped = false;
+    portEXIT_CRITICAL(&touch_lock);
 }
 
 esp_err_t app_touch_init(void)
@@ -520,11 +326,18 @@ esp_err_t app_touch_init(void)
             .mirror_x = 0,
             .mirror_y = 0,
         },
+        /* Touch INT is the only wake source while LVGL is stopped */
+        .interrupt_callback = touch_isr_cb,
     };
     esp_lcd_panel_io_handle_t tp_io_handle = NULL;
     const esp_lcd_panel_io_i2c_config_t tp_io_config = ESP_LCD_TOUCH_IO_I2C_CST820_CONFIG();
     ESP_RETURN_ON_ERROR(esp_lcd_new_panel_io_i2c((esp_lcd_i2c_bus_handle_t)EXAMPLE_TOUCH_I2C_NUM, &tp_io_config, &tp_io_handle), TAG, "");
-    return esp_lcd_touch_new_i2c_cst820(tp_io_handle, &tp_cfg, &touch_handle);
+    ESP_RETURN_ON_ERROR(esp_lcd_touch_new_i2c_cst820(tp_io_handle, &tp_cfg, &touch_handle), TAG, "Touch init failed");
+
+    BaseType_t res = xTaskCreatePinnedToCore(touch_task, "touch", TASK_TOUCH_STACK, NULL, TASK_TOUCH_PRIORITY,
+                                             &touch_task_handle, TASK_TOUCH_CORE);
+    ESP_RETURN_ON_FALSE(res == pdPASS, ESP_ERR_NO_MEM, TAG, "Create touch task failed");
+    return ESP_OK;
 }
 
 void rounder_event_cb(lv_event_t *e)
@@ -542,15 +355,32 @@ void rounder_event_cb(lv_event_t *e)
     // round the end of coordinate up to the nearest 2N+1 number
     area->x2 = ((x2 >> 1) << 1) + 1;
     area->y2 = ((y2 >> 1) << 1) + 1;
+
+    // skip what falls outside the round glass
+    disp_flush_clip_to_viewport(area);
+}
+
+/* Rows per flush as LVGL works them out, through the rounder, against the rows of the draw buffer */
+static bool flush_rows_match(lv_display_t *disp)
+{
+    int32_t rows = lv_display_get_buf_active(disp)->header.h;
+    lv_area_t probe = {.x1 = 0, .y1 = 0, .x2 = 0, .y2 = rows - 1};
+    lv_display_send_event(disp, LV_EVENT_INVALIDATE_AREA, &probe);
+    if (lv_area_get_height(&probe) != (rows & ~1)) {
+        ESP_LOGE(TAG, "Rounder turns %" PRId32 " buffer rows into %" PRId32 " per flush", rows,
+                 lv_area_get_height(&probe));
+        return false;
+    }
+    return true;
 }
 
 esp_err_t app_lvgl_init(void)
 {
     /* Initialize LVGL */
     const lvgl_port_cfg_t lvgl_cfg = {
-        .task_priority = 4,       /* LVGL task priority */
-        .task_stack = 7096,       /* LVGL task stack size */
-        .task_affinity = -1,      /* LVGL task pinned to core (-1 is no affinity) */
+        .task_priority = TASK_LVGL_PRIORITY, /* LVGL task priority */
+        .task_stack = TASK_LVGL_STACK,       /* LVGL task stack size */
+        .task_affinity = TASK_LVGL_CORE,     /* Render core, see task_topology.h */
         .task_max_sleep_ms = 500, /* Maximum sleep in LVGL task */
         .timer_period_ms = 5      /* LVGL timer tick period in ms */
     };
@@ -561,7 +391,7 @@ esp_err_t app_lvgl_init(void)
     const lvgl_port_display_cfg_t disp_cfg = {
         .io_handle = lcd_io,
         .panel_handle = lcd_panel,
-        .buffer_size = EXAMPLE_LCD_H_RES * EXAMPLE_LCD_DRAW_BUFF_HEIGHT, // EXAMPLE_LCD_DRAW_BUFF_HEIGHT
+        .buffer_size = EXAMPLE_LCD_H_RES * lcd_draw_buff_rows,
         .double_buffer = EXAMPLE_LCD_DRAW_BUFF_DOUBLE,
         .hres = EXAMPLE_LCD_H_RES,
         .vres = EXAMPLE_LCD_V_RES,
@@ -581,326 +411,46 @@ esp_err_t app_lvgl_init(void)
 #endif
         }};
     lvgl_disp = lvgl_port_add_disp(&disp_cfg);
-    lv_display_add_event_cb(lvgl_disp, rounder_event_cb, LV_EVENT_INVALIDATE_AREA, NULL);
-
-    /* Add touch input (for selected screen) */
-    const lvgl_port_touch_cfg_t touch_cfg = {
-        .disp = lvgl_disp,
-        .handle = touch_handle,
+    ESP_RETURN_ON_FALSE(lvgl_disp, ESP_FAIL, TAG, "Add LVGL display failed");
+
+    /* Own flush path: byte swap, round viewport clipping, unchanged tiles, transfer accounting */
+    const disp_flush_config_t flush_cfg = {
+        .panel = lcd_panel,
+        .io = lcd_io,
+        .h_res = EXAMPLE_LCD_H_RES,
+        .v_res = EXAMPLE_LCD_V_RES,
+#if CONFIG_EXAMPLE_LCD_ROUND_VIEWPORT
+        .round = true,
+#endif
+#if CONFIG_EXAMPLE_LCD_SKIP_UNCHANGED
+        .skip_unchanged = true,
+#endif
     };
-    lvgl_touch_indev = lvgl_port_add_touch(&touch_cfg);
-
-    return ESP_OK;
-}
-
-static void create_boot_screen(void)
-{
-    boot_screen = lv_obj_create(NULL);
-    lv_obj_clear_flag(boot_screen, LV_OBJ_FLAG_SCROLLABLE);
-
-    lv_obj_t *logo = lv_label_create(boot_screen);
-    lv_label_set_text(logo, "Belom");
-    lv_obj_set_style_text_font(logo, &lv_font_montserrat_28, 0);
-    lv_obj_center(logo);
-
-    if (owner_name_len > 0) {
-        lv_obj_t *owner = lv_label_create(boot_screen);
-        char owner_text[32];
-        snprintf(owner_text, sizeof(owner_text), "Owner: %s", owner_name);
-        lv_label_set_text(owner, owner_text);
-        lv_obj_set_style_text_font(owner, &lv_font_montserrat_12, 0);
-        lv_obj_align(owner, LV_ALIGN_BOTTOM_MID, 0, -12);
-    }
-}
-
-static void create_main_screen(void)
-{
-    main_screen = lv_obj_create(NULL);
-    lv_obj_clear_flag(main_screen, LV_OBJ_FLAG_SCROLLABLE);
-
-    arc_speed = lv_arc_create(main_screen);
-    lv_obj_set_size(arc_speed, 200, 200);
-    lv_obj_center(arc_speed);
-    lv_arc_set_range(arc_speed, 0, 100);
-    lv_arc_set_rotation(arc_speed, 270);
-    lv_arc_set_bg_angles(arc_speed, 0, 360);
-    lv_obj_remove_style(arc_speed, NULL, LV_PART_KNOB);
-    lv_obj_set_style_arc_width(arc_speed, 12, LV_PART_MAIN);
-    lv_obj_set_style_arc_width(arc_speed, 12, LV_PART_INDICATOR);
-
-    label_speed = lv_label_create(main_screen);
-    lv_obj_set_style_text_font(label_speed, &lv_font_montserrat_36, 0);
-    lv_obj_center(label_speed);
-
-    label_speed_caption = lv_label_create(main_screen);
-    lv_obj_set_style_text_font(label_speed_caption, &lv_font_montserrat_14, 0);
-    lv_obj_align(label_speed_caption, LV_ALIGN_CENTER, 0, 56);
-
-    lock_overlay = lv_label_create(main_screen);
-    lv_label_set_text(lock_overlay, "🔒");
-    lv_obj_set_style_text_font(lock_overlay, &lv_font_montserrat_28, 0);
-    lv_obj_align(lock_overlay, LV_ALIGN_TOP_RIGHT, -16, 16);
-    lv_obj_add_flag(lock_overlay, LV_OBJ_FLAG_HIDDEN);
-
-    lv_anim_t anim;
-    lv_anim_init(&anim);
-    lv_anim_set_var(&anim, lock_overlay);
-    lv_anim_set_exec_cb(&anim, (lv_anim_exec_xcb_t)lv_obj_set_style_opa);
-    lv_anim_set_values(&anim, 80, 255);
-    lv_anim_set_time(&anim, 1200);
-    lv_anim_set_playback_time(&anim, 1200);
-    lv_anim_set_repeat_count(&anim, LV_ANIM_REPEAT_INFINITE);
-    lv_anim_start(&anim);
-}
-
-static void create_settings_screen(void)
-{
-    settings_screen = lv_obj_create(NULL);
-    lv_obj_clear_flag(settings_screen, LV_OBJ_FLAG_SCROLLABLE);
-
-    label_settings_title = lv_label_create(settings_screen);
-    lv_obj_set_style_text_font(label_settings_title, &lv_font_montserrat_20, 0);
-    lv_obj_align(label_settings_title, LV_ALIGN_TOP_MID, 0, 12);
-
-    lv_obj_t *list = lv_obj_create(settings_screen);
-    lv_obj_set_size(list, 200, 140);
-    lv_obj_align(list, LV_ALIGN_CENTER, 0, 16);
-    lv_obj_set_style_pad_all(list, 8, 0);
-    lv_obj_set_style_bg_opa(list, LV_OPA_TRANSP, 0);
-    lv_obj_set_style_border_width(list, 0, 0);
-
-    settings_items[0] = lv_label_create(list);
-    settings_items[1] = lv_label_create(list);
-    lv_obj_set_width(settings_items[0], 180);
-    lv_obj_set_width(settings_items[1], 180);
-    lv_obj_align(settings_items[0], LV_ALIGN_TOP_LEFT, 0, 0);
-    lv_obj_align(settings_items[1], LV_ALIGN_TOP_LEFT, 0, 40);
-    lv_obj_set_style_pad_all(settings_items[0], 6, 0);
-    lv_obj_set_style_pad_all(settings_items[1], 6, 0);
-
-    apply_language();
-    update_settings_selection();
-}
-
-static void create_language_screen(void)
-{
-    language_screen = lv_obj_create(NULL);
-    lv_obj_clear_flag(language_screen, LV_OBJ_FLAG_SCROLLABLE);
-
-    label_language_title = lv_label_create(language_screen);
-    lv_obj_set_style_text_font(label_language_title, &lv_font_montserrat_20, 0);
-    lv_label_set_text(label_language_title, ui_strings[current_lang].language);
-    lv_obj_align(label_language_title, LV_ALIGN_TOP_MID, 0, 12);
-
-    roller_language = lv_roller_create(language_screen);
-    lv_obj_set_width(roller_language, 220);
-    lv_obj_align(roller_language, LV_ALIGN_CENTER, 0, 20);
-
-    lv_roller_set_options(roller_language,
-                          "English\nРусский\nEesti\nDeutsch\nSuomi\nLatviešu\nLietuviu\nEspañol",
-                          LV_ROLLER_MODE_INFINITE);
-    lv_roller_set_visible_row_count(roller_language, 4);
-    lv_roller_set_selected(roller_language, current_lang, LV_ANIM_OFF);
-}
-
-static void create_owner_screen(void)
-{
-    owner_screen = lv_obj_create(NULL);
-    lv_obj_clear_flag(owner_screen, LV_OBJ_FLAG_SCROLLABLE);
-
-    label_owner_title = lv_label_create(owner_screen);
-    lv_obj_set_style_text_font(label_owner_title, &lv_font_montserrat_20, 0);
-    lv_label_set_text(label_owner_title, ui_strings[current_lang].owner_name);
-    lv_obj_align(label_owner_title, LV_ALIGN_TOP_MID, 0, 12);
-
-    label_owner_value = lv_label_create(owner_screen);
-    lv_label_set_text(label_owner_value, owner_name_len ? owner_name : "-");
-    lv_obj_set_style_text_font(label_owner_value, &lv_font_montserrat_16, 0);
-    lv_obj_align(label_owner_value, LV_ALIGN_TOP_MID, 0, 46);
-
-    roller_owner = lv_roller_create(owner_screen);
-    lv_obj_set_width(roller_owner, 200);
-    lv_obj_align(roller_owner, LV_ALIGN_CENTER, 0, 20);
-    lv_roller_set_visible_row_count(roller_owner, 4);
-    lv_roller_set_options(roller_owner,
-                          "A\nB\nC\nD\nE\nF\nG\nH\nI\nJ\nK\nL\nM\nN\nO\nP\nQ\nR\nS\nT\nU\nV\nW\nX\nY\nZ\n"
-                          "a\nb\nc\nd\ne\nf\ng\nh\ni\nj\nk\nl\nm\nn\no\np\nq\nr\ns\nt\nu\nv\nw\nx\ny\nz\n"
-                          "0\n1\n2\n3\n4\n5\n6\n7\n8\n9\n"
-                          "space\n<-\nSave",
-                          LV_ROLLER_MODE_NORMAL);
-}
-
-static void ui_init(void)
-{
-    create_boot_screen();
-    create_main_screen();
-    create_settings_screen();
-    create_language_screen();
-    create_owner_screen();
-
-    show_screen(boot_screen);
-    update_main_ui();
-
-    if (!boot_timer) {
-        esp_timer_create_args_t timer_args = {
-            .callback = &boot_timer_cb,
-            .name = "boot_timer",
-        };
-        ESP_ERROR_CHECK(esp_timer_create(&timer_args, &boot_timer));
-    }
-    esp_timer_start_once(boot_timer, 2000 * 1000);
-}
-
-static void handle_knob_move(int direction)
-{
-    if (ui_screen == UI_SCREEN_MAIN) {
-        if (ui_locked) {
-            return;
-        }
-        fan_speed_percent += direction;
-        if (fan_speed_percent < FAN_SPEED_MIN_PERCENT) {
-            fan_speed_percent = FAN_SPEED_MIN_PERCENT;
-        }
-        if (fan_speed_percent > FAN_SPEED_MAX_PERCENT) {
-            fan_speed_percent = FAN_SPEED_MAX_PERCENT;
-        }
-        lvgl_port_lock(0);
-        update_main_ui();
-        lvgl_port_unlock();
-        apply_fan_pwm(fan_speed_percent);
-        return;
-    }
-
-    if (ui_screen == UI_SCREEN_SETTINGS) {
-        settings_index += direction;
-        if (settings_index < 0) {
-            settings_index = 1;
-        }
-        if (settings_index > 1) {
-            settings_index = 0;
-        }
-        lvgl_port_lock(0);
-        update_settings_selection();
-        lvgl_port_unlock();
-        return;
-    }
-
-    if (ui_screen == UI_SCREEN_LANGUAGE && roller_language) {
-        int selected = lv_roller_get_selected(roller_language);
-        selected += direction;
-        if (selected < 0) {
-            selected = LANG_COUNT - 1;
-        }
-        if (selected >= LANG_COUNT) {
-            selected = 0;
-        }
-        lvgl_port_lock(0);
-        lv_roller_set_selected(roller_language, selected, LV_ANIM_ON);
-        lvgl_port_unlock();
-        return;
-    }
-
-    if (ui_screen == UI_SCREEN_OWNER && roller_owner) {
-        int selected = lv_roller_get_selected(roller_owner);
-        selected += direction;
-        if (selected < 0) {
-            selected = lv_roller_get_option_cnt(roller_owner) - 1;
-        }
-        if (selected >= lv_roller_get_option_cnt(roller_owner)) {
-            selected = 0;
-        }
-        lvgl_port_lock(0);
-        lv_roller_set_selected(roller_owner, selected, LV_ANIM_ON);
-        lvgl_port_unlock();
-    }
-}
-
-static void handle_owner_selection(void)
-{
-    if (!roller_owner || !label_owner_value) {
-        return;
-    }
-    char buf[16] = {0};
-    lv_roller_get_selected_str(roller_owner, buf, sizeof(buf));
-    if (strcmp(buf, "<-") == 0) {
-        if (owner_name_len > 0) {
-            owner_name[owner_name_len - 1] = '\0';
-            owner_name_len--;
-        }
-    } else if (strcmp(buf, "Save") == 0) {
-        save_owner_name();
-        ui_screen = UI_SCREEN_SETTINGS;
-        show_screen(settings_screen);
-        apply_language();
-        update_settings_selection();
-        return;
-    } else {
-        char ch = 0;
-        if (strcmp(buf, "space") == 0) {
-            ch = ' ';
-        } else {
-            ch = buf[0];
-        }
-        if (owner_name_len < OWNER_NAME_MAX_LEN) {
-            owner_name[owner_name_len] = ch;
-            owner_name_len++;
-            owner_name[owner_name_len] = '\0';
-        }
-    }
-    lv_label_set_text(label_owner_value, owner_name_len ? owner_name : "-");
-}
-
-static void handle_single_click(void)
-{
-    if (ui_screen == UI_SCREEN_SETTINGS) {
-        if (settings_index == 0) {
-            ui_screen = UI_SCREEN_LANGUAGE;
-            if (roller_language) {
-                lv_roller_set_selected(roller_language, current_lang, LV_ANIM_OFF);
-            }
-            show_screen(language_screen);
-        } else if (settings_index == 1) {
-            ui_screen = UI_SCREEN_OWNER;
-            if (label_owner_value) {
-                lv_label_set_text(label_owner_value, owner_name_len ? owner_name : "-");
-            }
-            show_screen(owner_screen);
-        }
-        return;
+    lvgl_port_lock(0);
+    esp_err_t ret = disp_flush_install(lvgl_disp, &flush_cfg);
+    if (ret == ESP_OK) {
+        lv_display_add_event_cb(lvgl_disp, rounder_event_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+        ret = flush_rows_match(lvgl_disp) ? ESP_OK : ESP_ERR_INVALID_STATE;
     }
-
-    if (ui_screen == UI_SCREEN_LANGUAGE && roller_language) {
-        int selected = lv_roller_get_selected(roller_language);
-        if (selected >= 0 && selected < LANG_COUNT) {
-            current_lang = (ui_lang_t)selected;
-            apply_language();
-            save_language();
-        }
-        ui_screen = UI_SCREEN_SETTINGS;
-        show_screen(settings_screen);
-        return;
+    if (ret == ESP_OK) {
+        latency_trace_attach(lvgl_disp);
+        ret = disp_flush_add_frame_observer(latency_trace_frame_done, NULL);
     }
+    lvgl_port_unlock();
+    ESP_RETURN_ON_ERROR(ret, TAG, "Display flush install failed");
 
-    if (ui_screen == UI_SCREEN_OWNER) {
-        handle_owner_selection();
+    /* Add touch input; read here rather than by the port so the INT line stays ours */
+    lvgl_port_lock(0);
+    lvgl_touch_indev = lv_indev_create();
+    if (lvgl_touch_indev) {
+        lv_indev_set_type(lvgl_touch_indev, LV_INDEV_TYPE_POINTER);
+        lv_indev_set_read_cb(lvgl_touch_indev, touch_read_cb);
+        lv_indev_set_display(lvgl_touch_indev, lvgl_disp);
     }
-}
+    lvgl_port_unlock();
+    ESP_RETURN_ON_FALSE(lvgl_touch_indev, ESP_ERR_NO_MEM, TAG, "Add touch input failed");
 
-static void handle_long_press(void)
-{
-    if (ui_screen == UI_SCREEN_LANGUAGE || ui_screen == UI_SCREEN_OWNER) {
-        ui_screen = UI_SCREEN_SETTINGS;
-        show_screen(settings_screen);
-        apply_language();
-        update_settings_selection();
-        return;
-    }
-    if (ui_screen == UI_SCREEN_SETTINGS) {
-        ui_screen = UI_SCREEN_MAIN;
-        show_screen(main_screen);
-        set_lock_overlay(ui_locked);
-        update_main_ui();
-    }
+    return ESP_OK;
 }
 
 static const sh8601_lcd_init_cmd_t lcd_init_cmds[] = {
@@ -942,11 +492,16 @@ const char *knob_event_table[] = {
 
 static void knob_event_cb(void *arg, void *data)
 {
+    latency_trace_input();
     ESP_LOGI(TAG, "knob event %s, %d", knob_event_table[(knob_event_t)data], iot_knob_get_count_value(knob));
+    /* A step that only woke the display is not a speed change */
+    if (display_idle_activity()) {
+        return;
+    }
     if ((knob_event_t)data == KNOB_LEFT) {
-        handle_knob_move(-1);
+        ui_knob_move(-1);
     } else if ((knob_event_t)data == KNOB_RIGHT) {
-        handle_knob_move(1);
+        ui_knob_move(1);
     }
     LVGL_knob_event(data);
 }
@@ -997,18 +552,25 @@ static void button_event_cb(void *arg, void *data)
 {
     button_event_t event = (button_event_t)data;
     ESP_LOGI(TAG, "Button event %s", button_event_table[event]);
-    if (event == BUTTON_PRESS_UP) {
+    if (event == BUTTON_PRESS_DOWN) {
+        /* The whole press that woke the display is swallowed */
+        wake_press = display_idle_activity();
+    } else if (event == BUTTON_PRESS_UP) {
+        if (wake_press) {
+            wake_press = false;
+            return;
+        }
         if (suppress_click) {
             suppress_click = false;
             return;
         }
-        click_count++;
-        start_click_timer();
+        ui_button_click();
     } else if (event == BUTTON_LONG_PRESS_START) {
+        if (wake_press) {
+            return;
+        }
         suppress_click = true;
-        lvgl_port_lock(0);
-        handle_long_press();
-        lvgl_port_unlock();
+        ui_button_long_press();
     }
     LVGL_button_event(data);
 }
@@ -1026,7 +588,8 @@ void button_init(uint32_t button_num)
     };
     button_handle_t btn = iot_button_create(&btn_cfg);
     assert(btn);
-    esp_err_t err = iot_button_register_cb(btn, BUTTON_PRESS_UP, button_event_cb, (void *)BUTTON_PRESS_UP);
+    esp_err_t err = iot_button_register_cb(btn, BUTTON_PRESS_DOWN, button_event_cb, (void *)BUTTON_PRESS_DOWN);
+    err |= iot_button_register_cb(btn, BUTTON_PRESS_UP, button_event_cb, (void *)BUTTON_PRESS_UP);
     err |= iot_button_register_cb(btn, BUTTON_LONG_PRESS_START, button_event_cb, (void *)BUTTON_LONG_PRESS_START);
 
 #if CONFIG_ENTER_LIGHT_SLEEP_MODE_MANUALLY
@@ -1045,14 +608,38 @@ void button_init(uint32_t button_num)
  * ============================================================================ */
 void app_main(void)
 {
+#if CONFIG_EXAMPLE_PERF_JOURNAL
+    const perf_journal_config_t journal_cfg = {
+        .flush_ms = CONFIG_EXAMPLE_PERF_JOURNAL_FLUSH_S * 1000,
+    };
+    ESP_ERROR_CHECK_WITHOUT_ABORT(perf_journal_init(&journal_cfg));
+#endif
     esp_err_t ret = nvs_flash_init();
     if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
         ESP_ERROR_CHECK(nvs_flash_erase());
         ESP_ERROR_CHECK(nvs_flash_init());
     }
-    load_settings();
-    init_pwm_fan();
-    apply_fan_pwm(fan_speed_percent);
+    ui_load_settings();
+#if CONFIG_EXAMPLE_UI_ASSETS
+    /* Without a valid pack the UI falls back to the LVGL default font */
+    ESP_ERROR_CHECK_WITHOUT_ABORT(assets_init());
+#endif
+    perf_journal_boot_stage(PERF_JOURNAL_STAGE_STORAGE);
+    ESP_ERROR_CHECK(fan_init(fan_zones, sizeof(fan_zones) / sizeof(fan_zones[0])));
+    int fan_speeds[FAN_ZONE_MAX];
+    for (int i = 0; i < fan_zone_count(); i++) {
+        fan_speeds[i] = ui_get_fan_speed(i);
+    }
+    fan_set_all(fan_speeds);
+#if CONFIG_EXAMPLE_FAN_CALIBRATION
+    const fan_cal_config_t fan_cal_cfg = {
+        .zone = CONFIG_EXAMPLE_FAN_SENSE_ZONE - 1,
+        .channel = CONFIG_EXAMPLE_FAN_SENSE_ADC_CHANNEL,
+        .divider_x1000 = CONFIG_EXAMPLE_FAN_SENSE_DIVIDER_X1000,
+    };
+    ESP_ERROR_CHECK_WITHOUT_ABORT(fan_cal_init(&fan_cal_cfg));
+#endif
+    perf_journal_boot_stage(PERF_JOURNAL_STAGE_FAN);
 
     if (EXAMPLE_PIN_NUM_BK_LIGHT >= 0)
     {
@@ -1071,7 +658,7 @@ void app_main(void)
     const spi_bus_config_t buscfg =
         SH8601_PANEL_BUS_QSPI_CONFIG(EXAMPLE_PIN_NUM_LCD_PCLK, EXAMPLE_PIN_NUM_LCD_DATA0,
                                      EXAMPLE_PIN_NUM_LCD_DATA1, EXAMPLE_PIN_NUM_LCD_DATA2,
-                                     EXAMPLE_PIN_NUM_LCD_DATA3, EXAMPLE_LCD_H_RES * EXAMPLE_LCD_V_RES * LCD_BIT_PER_PIXEL / 8);
+                                     EXAMPLE_PIN_NUM_LCD_DATA3, EXAMPLE_LCD_H_RES * QSPI_BENCH_MAX_ROWS * LCD_BIT_PER_PIXEL / 8);
 
     ESP_ERROR_CHECK(spi_bus_initialize(EXAMPLE_LCD_HOST, &buscfg, SPI_DMA_CH_AUTO));
 
@@ -1079,7 +666,7 @@ void app_main(void)
     const esp_lcd_panel_io_spi_config_t io_config = {
         .dc_gpio_num = -1,                     // EXAMPLE_PIN_NUM_LCD_CS,
         .cs_gpio_num = EXAMPLE_PIN_NUM_LCD_CS, //-1,
-        .pclk_hz = 80 * 1000 * 1000,
+        .pclk_hz = EXAMPLE_LCD_PCLK_HZ,
         .trans_queue_depth = 20,
         .lcd_cmd_bits = 32,
         .lcd_param_bits = 8,
@@ -1114,8 +701,27 @@ void app_main(void)
     ESP_ERROR_CHECK(esp_lcd_panel_init(lcd_panel));
     // user can flush pre-defined pattern to the screen before we turn on the screen or backlight
     ESP_ERROR_CHECK(esp_lcd_panel_disp_on_off(lcd_panel, true));
+    perf_journal_boot_stage(PERF_JOURNAL_STAGE_PANEL);
 
     app_touch_init();
+    perf_journal_boot_stage(PERF_JOURNAL_STAGE_TOUCH);
+
+    lcd_draw_buff_rows = qspi_bench_load_strip_rows(EXAMPLE_LCD_DRAW_BUFF_HEIGHT);
+#if CONFIG_EXAMPLE_QSPI_BENCH
+    const qspi_bench_config_t bench_cfg = {
+        .panel = lcd_panel,
+        .io = lcd_io,
+        .h_res = EXAMPLE_LCD_H_RES,
+        .v_res = EXAMPLE_LCD_V_RES,
+        .pclk_hz = EXAMPLE_LCD_PCLK_HZ,
+        .data_lines = 4,
+    };
+    int best_rows = 0;
+    if (qspi_bench_run(&bench_cfg, &best_rows) == ESP_OK && qspi_bench_save_strip_rows(best_rows) == ESP_OK) {
+        lcd_draw_buff_rows = best_rows;
+    }
+#endif
+    ESP_LOGI(TAG, "LVGL draw buffer: %d rows", lcd_draw_buff_rows);
 
     if (EXAMPLE_PIN_NUM_BK_LIGHT >= 0)
     {
@@ -1125,12 +731,93 @@ void app_main(void)
 
     app_lvgl_init();
 
+    const power_mgmt_config_t pm_cfg = {
+        .disp = lvgl_disp,
+        .touch_int_gpio = EXAMPLE_PIN_NUM_TOUCH_INT,
+#if CONFIG_EXAMPLE_DISPLAY_IDLE
+        /* Without display idle the display never goes off: no light sleep, and nothing would wake the touch again */
+        .light_sleep = true,
+        .touch = touch_handle,
+        .touch_auto_sleep_s = CONFIG_EXAMPLE_TOUCH_AUTO_SLEEP_S,
+#if CONFIG_EXAMPLE_TOUCH_DEEP_SLEEP
+        .touch_deep_sleep = true,
+#endif
+#endif
+    };
+    ESP_ERROR_CHECK(power_mgmt_init(&pm_cfg));
+#if CONFIG_EXAMPLE_SCREEN_CACHE
+    const screen_cache_config_t cache_cfg = {
+        .disp = lvgl_disp,
+        .h_res = EXAMPLE_LCD_H_RES,
+        .v_res = EXAMPLE_LCD_V_RES,
+#if CONFIG_EXAMPLE_SCREEN_CACHE_SLIDE
+        .slide = true,
+#endif
+    };
+    /* Without it every load renders the screen, as before */
+    ESP_ERROR_CHECK_WITHOUT_ABORT(screen_cache_init(&cache_cfg));
+#endif
+    perf_journal_boot_stage(PERF_JOURNAL_STAGE_LVGL);
+
     knob_init(BSP_ENCODER_A, BSP_ENCODER_B);
     button_init(BSP_BTN_PRESS);
 
     // Lock the mutex due to the LVGL APIs are not thread-safe
     lvgl_port_lock(0);
+#if CONFIG_EXAMPLE_LVGL_BENCHMARK
+    /* The demo logs its summary through LV_LOG at the end */
+    lv_log_register_print_cb(my_print);
+    lv_demo_benchmark();
+#else
     ui_init();
+#endif
     // Release the mutex
     lvgl_port_unlock();
+    perf_journal_boot_stage(PERF_JOURNAL_STAGE_UI);
+
+#if CONFIG_EXAMPLE_DISPLAY_IDLE
+    const display_idle_config_t idle_cfg = {
+        .io = lcd_io,
+        .panel = lcd_panel,
+        .dim_after_ms = CONFIG_EXAMPLE_DISPLAY_DIM_TIMEOUT_S * 1000,
+        .off_after_ms = CONFIG_EXAMPLE_DISPLAY_OFF_TIMEOUT_S * 1000,
+        .sleep_after_ms = CONFIG_EXAMPLE_DISPLAY_SLEEP_TIMEOUT_S * 1000,
+        .full_brightness = 0xFF,
+        .dim_brightness = CONFIG_EXAMPLE_DISPLAY_DIM_BRIGHTNESS,
+        .on_transition = power_mgmt_display_transition,
+    };
+    ESP_ERROR_CHECK(display_idle_init(&idle_cfg));
+#endif
+
+#if CONFIG_EXAMPLE_FRAME_WATCH
+    const frame_watch_config_t frame_watch_cfg = {
+        .disp = lvgl_disp,
+        .budget_us = CONFIG_EXAMPLE_FRAME_BUDGET_MS * 1000,
+    };
+    ESP_ERROR_CHECK(frame_watch_init(&frame_watch_cfg));
+#endif
+
+#if CONFIG_EXAMPLE_PERF_CONSOLE
+    const perf_console_config_t perf_cfg = {
+        .disp = lvgl_disp,
+        .lvgl_task_stack = TASK_LVGL_STACK,
+    };
+    ESP_ERROR_CHECK(perf_console_init(&perf_cfg));
+#if CONFIG_EXAMPLE_FAN_CALIBRATION
+    ESP_ERROR_CHECK(fan_cal_register_console());
+#endif
+#if CONFIG_EXAMPLE_CTL_LINK
+    ESP_ERROR_CHECK(ctl_link_register_console());
+#endif
+#if CONFIG_EXAMPLE_FRAME_WATCH
+    ESP_ERROR_CHECK(frame_watch_register_console());
+#endif
+#if CONFIG_EXAMPLE_PERF_JOURNAL
+    ESP_ERROR_CHECK(perf_journal_register_console());
+#endif
+#endif
+    perf_journal_boot_stage(PERF_JOURNAL_STAGE_SERVICES);
+#if CONFIG_EXAMPLE_PERF_CONSOLE
+    perf_console_main_done();
+#endif
 }
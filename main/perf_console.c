@@ -0,0 +1,472 @@
+/**
+ * @file perf_console.c
+ * @brief Performance console on USB-Serial-JTAG
+ */
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/usb_serial_jtag.h"
+#include "esp_check.h"
+#include "esp_console.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_lvgl_port.h"
+
+#include "disp_flush.h"
+#include "latency_trace.h"
+#include "perf_console.h"
+#include "power_mgmt.h"
+#include "screen_cache.h"
+#include "task_topology.h"
+
+#define PERF_CONSOLE_MAX_TASKS 32
+#define PERF_CONSOLE_CORES 2
+#define PERF_STREAM_DEFAULT_MS 100
+#define PERF_STREAM_MIN_MS 20
+#define PERF_STREAM_SYNC0 0xA5
+#define PERF_STREAM_SYNC1 0x5A
+#define PERF_JITTER_PERIOD_MS 10
+#define PERF_JITTER_DEFAULT_S 5
+
+static const char *TAG = "perf_console";
+
+/* Counter snapshot; the difference of two gives the rates over a window */
+typedef struct {
+    int64_t t_us;
+    uint32_t total_rt;
+    uint32_t idle_rt[PERF_CONSOLE_CORES];
+    disp_flush_stats_t flush;
+    uint32_t render_frames;
+    uint64_t render_us;
+    uint32_t i2c_reads;
+} perf_window_t;
+
+typedef struct {
+    uint32_t ms;
+    uint32_t frames;
+    uint32_t fps_x10;
+    uint32_t render_us;
+    uint32_t flush_us;
+    uint8_t cpu_pct[PERF_CONSOLE_CORES];
+    uint64_t qspi_bytes;
+    uint64_t skipped_bytes;
+    uint32_t i2c_reads;
+} perf_delta_t;
+
+static struct {
+    lv_display_t *disp;
+    uint32_t lvgl_task_stack;
+    uint32_t main_stack_hwm;
+    /* Refreshes that flushed something; LVGL task */
+    int64_t refr_start_us;
+    uint32_t refr_flushes;
+    uint32_t render_frames;
+    uint64_t render_us;
+    volatile uint32_t i2c_reads;
+    volatile uint32_t i2c_errors;
+    /* One window per consumer so "perf" and the stream do not disturb each other */
+    perf_window_t console_win;
+    perf_window_t stream_win;
+    TaskHandle_t stream_task;
+    volatile uint32_t stream_period_ms;
+    vprintf_like_t log_vprintf; /* Log output while streaming is held back */
+    uint16_t stream_seq;
+} s_perf;
+
+void perf_console_count_i2c(esp_err_t err)
+{
+    s_perf.i2c_reads++;
+    if (err != ESP_OK) {
+        s_perf.i2c_errors++;
+    }
+}
+
+void perf_console_main_done(void)
+{
+    s_perf.main_stack_hwm = uxTaskGetStackHighWaterMark(NULL);
+}
+
+static void refr_event_cb(lv_event_t *e)
+{
+    disp_flush_stats_t flush;
+    disp_flush_get_stats(&flush);
+    if (lv_event_get_code(e) == LV_EVENT_REFR_START) {
+        s_perf.refr_start_us = esp_timer_get_time();
+        s_perf.refr_flushes = flush.flushes;
+        return;
+    }
+    /* Refreshes with nothing invalidated would drag the average to zero */
+    if (flush.flushes != s_perf.refr_flushes) {
+        s_perf.render_frames++;
+        s_perf.render_us += esp_timer_get_time() - s_perf.refr_start_us;
+    }
+}
+
+/* Task list and total run time; returns the number of tasks filled in */
+static UBaseType_t get_tasks(TaskStatus_t *tasks, uint32_t *total_rt)
+{
+    configRUN_TIME_COUNTER_TYPE total = 0;
+    UBaseType_t n = uxTaskGetSystemState(tasks, PERF_CONSOLE_MAX_TASKS, &total);
+    *total_rt = (uint32_t)total;
+    return n;
+}
+
+static void take_window(perf_window_t *win)
+{
+    TaskStatus_t *tasks = malloc(PERF_CONSOLE_MAX_TASKS * sizeof(TaskStatus_t));
+    memset(win, 0, sizeof(*win));
+    win->t_us = esp_timer_get_time();
+    if (tasks) {
+        UBaseType_t n = get_tasks(tasks, &win->total_rt);
+        for (int core = 0; core < PERF_CONSOLE_CORES; core++) {
+            TaskHandle_t idle = xTaskGetIdleTaskHandleForCore(core);
+            for (UBaseType_t i = 0; i < n; i++) {
+                if (tasks[i].xHandle == idle) {
+                    win->idle_rt[core] = (uint32_t)tasks[i].ulRunTimeCounter;
+                }
+            }
+        }
+        free(tasks);
+    }
+    disp_flush_get_stats(&win->flush);
+    win->render_frames = s_perf.render_frames;
+    win->render_us = s_perf.render_us;
+    win->i2c_reads = s_perf.i2c_reads;
+}
+
+/* Rates since the previous call on the same window, which is then advanced */
+static void advance_window(perf_window_t *win, perf_delta_t *d)
+{
+    perf_window_t now;
+    take_window(&now);
+    memset(d, 0, sizeof(*d));
+
+    d->ms = (uint32_t)((now.t_us - win->t_us) / 1000);
+    d->frames = now.flush.frames - win->flush.frames;
+    if (d->ms) {
+        d->fps_x10 = d->frames * 10000 / d->ms;
+    }
+    uint32_t render_frames = now.render_frames - win->render_frames;
+    if (render_frames) {
+        d->render_us = (uint32_t)((now.render_us - win->render_us) / render_frames);
+    }
+    if (d->frames) {
+        d->flush_us = (uint32_t)((now.flush.flush_us - win->flush.flush_us) / d->frames);
+    }
+    uint32_t total = now.total_rt - win->total_rt;
+    for (int core = 0; core < PERF_CONSOLE_CORES; core++) {
+        uint32_t idle = now.idle_rt[core] - win->idle_rt[core];
+        d->cpu_pct[core] = total && idle < total ? 100 - (uint64_t)idle * 100 / total : 0;
+    }
+    d->qspi_bytes = now.flush.bytes - win->flush.bytes;
+    d->skipped_bytes = now.flush.skipped_bytes - win->flush.skipped_bytes;
+    d->i2c_reads = now.i2c_reads - win->i2c_reads;
+    *win = now;
+}
+
+static uint32_t lv_heap_free(lv_mem_monitor_t *mon)
+{
+    lvgl_port_lock(0);
+    lv_mem_monitor(mon);
+    lvgl_port_unlock();
+    return (uint32_t)mon->free_size;
+}
+
+static int cmd_perf(int argc, char **argv)
+{
+    perf_delta_t d;
+    advance_window(&s_perf.console_win, &d);
+    lv_mem_monitor_t mon;
+    lv_heap_free(&mon);
+    latency_trace_stats_t lat;
+    latency_trace_get_stats(&lat);
+
+    printf("window      %" PRIu32 " ms\n", d.ms);
+    printf("cpu         core0 %u%%  core1 %u%%\n", d.cpu_pct[0], d.cpu_pct[1]);
+    printf("fps         %" PRIu32 ".%" PRIu32 " (%" PRIu32 " frames)\n", d.fps_x10 / 10, d.fps_x10 % 10, d.frames);
+    printf("frame       render %" PRIu32 " us  flush %" PRIu32 " us\n", d.render_us, d.flush_us);
+    if (d.frames) {
+        printf("qspi/frame  sent %" PRIu64 " B  skipped %" PRIu64 " B unchanged\n", d.qspi_bytes / d.frames,
+               d.skipped_bytes / d.frames);
+    }
+    printf("lvgl heap   free %u of %u  largest %u  frag %u%%  used %u%%\n", (unsigned)mon.free_size,
+           (unsigned)mon.total_size, (unsigned)mon.free_biggest_size, mon.frag_pct, mon.used_pct);
+    printf("latency     n %" PRIu32 "  p50 %" PRIu32 "  p99 %" PRIu32 "  max %" PRIu32 " us\n", lat.count,
+           lat.p50_us, lat.p99_us, lat.max_us);
+    return 0;
+}
+
+static int cmd_tasks(int argc, char **argv)
+{
+    TaskStatus_t *tasks = malloc(PERF_CONSOLE_MAX_TASKS * sizeof(TaskStatus_t));
+    if (!tasks) {
+        printf("no memory\n");
+        return 1;
+    }
+    uint32_t total_rt = 0;
+    UBaseType_t n = get_tasks(tasks, &total_rt);
+    /* Run time counts per core, the sum over all tasks is cores x uptime */
+    uint64_t all = (uint64_t)total_rt * PERF_CONSOLE_CORES;
+
+    printf("%-16s %4s %4s %8s %6s\n", "task", "core", "prio", "free", "cpu%");
+    for (UBaseType_t i = 0; i < n; i++) {
+        BaseType_t core = xTaskGetCoreID(tasks[i].xHandle);
+        char core_str[4] = "-";
+        if (core != tskNO_AFFINITY) {
+            snprintf(core_str, sizeof(core_str), "%d", (int)core);
+        }
+        /* usStackHighWaterMark is in bytes on this port */
+        printf("%-16s %4s %4u %8u %5.1f", tasks[i].pcTaskName, core_str, (unsigned)tasks[i].uxCurrentPriority,
+               (unsigned)tasks[i].usStackHighWaterMark, all ? tasks[i].ulRunTimeCounter * 100.0 / all : 0.0);
+        if (strcmp(tasks[i].pcTaskName, "taskLVGL") == 0 && s_perf.lvgl_task_stack) {
+            printf("  of %" PRIu32, s_perf.lvgl_task_stack);
+        }
+        printf("\n");
+    }
+    if (s_perf.main_stack_hwm) {
+        printf("%-16s %4d %4s %8" PRIu32 "  of %d, at exit\n", "main", TASK_CORE_IO, "-", s_perf.main_stack_hwm,
+               CONFIG_ESP_MAIN_TASK_STACK_SIZE);
+    }
+    free(tasks);
+    return 0;
+}
+
+static int cmd_counters(int argc, char **argv)
+{
+    disp_flush_stats_t flush;
+    disp_flush_get_stats(&flush);
+    latency_trace_stats_t lat;
+    latency_trace_get_stats(&lat);
+
+    printf("qspi  frames %" PRIu32 "  flushes %" PRIu32 "  transfers %" PRIu32 "  errors %" PRIu32 "  bytes %" PRIu64
+           "  skipped %" PRIu64 "\n",
+           flush.frames, flush.flushes, flush.transfers, flush.errors, flush.bytes, flush.skipped_bytes);
+    printf("i2c   reads %" PRIu32 "  errors %" PRIu32 "\n", s_perf.i2c_reads, s_perf.i2c_errors);
+    screen_cache_stats_t cache;
+    screen_cache_get_stats(&cache);
+    printf("cache hits %" PRIu32 "  misses %" PRIu32 "  slides %" PRIu32 "  dropped %" PRIu32 "\n", cache.hits,
+           cache.misses, cache.slides, cache.dropped);
+    printf("input traced %" PRIu32 "  over range %" PRIu32 "  dropped %" PRIu32 "\n", lat.count, lat.overflow,
+           lat.dropped);
+    power_mgmt_wake_stats_t wake;
+    power_mgmt_get_wake_stats(&wake);
+    power_mgmt_wake_stats_t touch_wake;
+    power_mgmt_get_touch_wake_stats(&touch_wake);
+    printf("wake  display %" PRIu32 "  last %" PRIu32 "  max %" PRIu32 " us  touch %" PRIu32 "  last %" PRIu32
+           "  max %" PRIu32 " us\n",
+           wake.count, wake.last_us, wake.max_us, touch_wake.count, touch_wake.last_us, touch_wake.max_us);
+    return 0;
+}
+
+typedef struct {
+    BaseType_t core;
+    uint32_t periods;
+    TaskHandle_t owner;
+    uint32_t n;
+    uint64_t sum_us;
+    uint32_t max_us;
+} jitter_probe_t;
+
+/* Deviation of the wake-up interval from the period, at the priority of the core's main work */
+static void jitter_probe_task(void *arg)
+{
+    jitter_probe_t *probe = arg;
+    TickType_t last = xTaskGetTickCount();
+    int64_t prev = 0;
+    for (uint32_t i = 0; i <= probe->periods; i++) {
+        vTaskDelayUntil(&last, pdMS_TO_TICKS(PERF_JITTER_PERIOD_MS));
+        int64_t now = esp_timer_get_time();
+        if (prev) {
+            int64_t dev = now - prev - PERF_JITTER_PERIOD_MS * 1000;
+            uint32_t abs_dev = (uint32_t)(dev < 0 ? -dev : dev);
+            probe->sum_us += abs_dev;
+            probe->max_us = LV_MAX(probe->max_us, abs_dev);
+            probe->n++;
+        }
+        prev = now;
+    }
+    xTaskNotifyGive(probe->owner);
+    vTaskDelete(NULL);
+}
+
+static int cmd_jitter(int argc, char **argv)
+{
+    uint32_t seconds = argc > 1 ? strtoul(argv[1], NULL, 10) : PERF_JITTER_DEFAULT_S;
+    if (!seconds) {
+        printf("duration must be at least 1 s\n");
+        return 1;
+    }
+    jitter_probe_t probes[] = {
+        {.core = TASK_CORE_IO},
+        {.core = TASK_CORE_RENDER},
+    };
+    const UBaseType_t prio[] = {TASK_TOUCH_PRIORITY, TASK_LVGL_PRIORITY};
+    bool started[2] = {false, false};
+    for (int i = 0; i < 2; i++) {
+        probes[i].periods = seconds * 1000 / PERF_JITTER_PERIOD_MS;
+        probes[i].owner = xTaskGetCurrentTaskHandle();
+        started[i] = xTaskCreatePinnedToCore(jitter_probe_task, "jitter", 2048, &probes[i], prio[i], NULL,
+                                             probes[i].core) == pdPASS;
+    }
+    printf("probing %" PRIu32 " s, %d ms period...\n", seconds, PERF_JITTER_PERIOD_MS);
+    for (int i = 0; i < 2; i++) {
+        if (started[i]) {
+            ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+        }
+    }
+    for (int i = 0; i < 2; i++) {
+        if (!started[i]) {
+            printf("core %d: no memory for the probe\n", (int)probes[i].core);
+            continue;
+        }
+        printf("core %d prio %u  wakes %" PRIu32 "  mean %" PRIu32 " us  max %" PRIu32 " us\n", (int)probes[i].core,
+               (unsigned)prio[i], probes[i].n, probes[i].n ? (uint32_t)(probes[i].sum_us / probes[i].n) : 0,
+               probes[i].max_us);
+    }
+    return 0;
+}
+
+static uint16_t fletcher16(const uint8_t *data, size_t len)
+{
+    uint16_t a = 0;
+    uint16_t b = 0;
+    for (size_t i = 0; i < len; i++) {
+        a = (a + data[i]) % 255;
+        b = (b + a) % 255;
+    }
+    return (b << 8) | a;
+}
+
+static void stream_send(void)
+{
+    perf_delta_t d;
+    advance_window(&s_perf.stream_win, &d);
+    lv_mem_monitor_t mon;
+    latency_trace_stats_t lat;
+    latency_trace_get_stats(&lat);
+
+    const perf_console_sample_t sample = {
+        .seq = s_perf.stream_seq++,
+        .t_ms = (uint32_t)(esp_timer_get_time() / 1000),
+        .fps_x10 = (uint16_t)LV_MIN(d.fps_x10, UINT16_MAX),
+        .render_us = (uint16_t)LV_MIN(d.render_us, UINT16_MAX),
+        .flush_us = (uint16_t)LV_MIN(d.flush_us, UINT16_MAX),
+        .cpu_pct = {d.cpu_pct[0], d.cpu_pct[1]},
+        .lv_heap_free = lv_heap_free(&mon),
+        .qspi_bytes = (uint32_t)LV_MIN(d.qspi_bytes, UINT32_MAX),
+        .i2c_reads = (uint16_t)LV_MIN(d.i2c_reads, UINT16_MAX),
+        .latency_p99_us = (uint16_t)LV_MIN(lat.p99_us, UINT16_MAX),
+    };
+
+    uint8_t frame[3 + sizeof(sample) + 2];
+    frame[0] = PERF_STREAM_SYNC0;
+    frame[1] = PERF_STREAM_SYNC1;
+    frame[2] = sizeof(sample);
+    memcpy(&frame[3], &sample, sizeof(sample));
+    uint16_t sum = fletcher16(&frame[2], 1 + sizeof(sample));
+    frame[3 + sizeof(sample)] = sum & 0xFF;
+    frame[4 + sizeof(sample)] = sum >> 8;
+    /* Straight to the USB driver, stdout may be the UART console */
+    usb_serial_jtag_write_bytes(frame, sizeof(frame), pdMS_TO_TICKS(20));
+}
+
+static void stream_task(void *arg)
+{
+    TickType_t last = xTaskGetTickCount();
+    while (1) {
+        uint32_t period = s_perf.stream_period_ms;
+        if (!period) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            take_window(&s_perf.stream_win);
+            last = xTaskGetTickCount();
+            continue;
+        }
+        vTaskDelayUntil(&last, pdMS_TO_TICKS(period));
+        if (s_perf.stream_period_ms) {
+            stream_send();
+        }
+    }
+}
+
+static int log_discard(const char *fmt, va_list args)
+{
+    return 0;
+}
+
+static int cmd_stream(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "off") == 0) {
+        s_perf.stream_period_ms = 0;
+        if (s_perf.log_vprintf) {
+            esp_log_set_vprintf(s_perf.log_vprintf);
+            s_perf.log_vprintf = NULL;
+        }
+        printf("stream off\n");
+        return 0;
+    }
+    uint32_t period = argc > 1 ? strtoul(argv[1], NULL, 10) : PERF_STREAM_DEFAULT_MS;
+    if (period < PERF_STREAM_MIN_MS) {
+        printf("period must be at least %d ms\n", PERF_STREAM_MIN_MS);
+        return 1;
+    }
+    if (!s_perf.stream_task &&
+            xTaskCreatePinnedToCore(stream_task, "perf_stream", TASK_PERF_STREAM_STACK, NULL, TASK_PERF_STREAM_PRIORITY,
+                                    &s_perf.stream_task, TASK_PERF_STREAM_CORE) != pdPASS) {
+        printf("no memory\n");
+        return 1;
+    }
+    printf("stream every %" PRIu32 " ms, \"stream off\" to stop\n", period);
+    /* Text in between would only cost the host resyncs; swallowing it keeps
+     * per-tag levels, which setting "*" would wipe */
+    if (!s_perf.log_vprintf) {
+        s_perf.log_vprintf = esp_log_set_vprintf(log_discard);
+    }
+    bool was_off = !s_perf.stream_period_ms;
+    s_perf.stream_period_ms = period;
+    if (was_off) {
+        xTaskNotifyGive(s_perf.stream_task);
+    }
+    return 0;
+}
+
+esp_err_t perf_console_init(const perf_console_config_t *config)
+{
+    ESP_RETURN_ON_FALSE(config && config->disp, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+
+    s_perf.disp = config->disp;
+    s_perf.lvgl_task_stack = config->lvgl_task_stack;
+
+    lvgl_port_lock(0);
+    lv_display_add_event_cb(s_perf.disp, refr_event_cb, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(s_perf.disp, refr_event_cb, LV_EVENT_REFR_READY, NULL);
+    lvgl_port_unlock();
+    take_window(&s_perf.console_win);
+
+    esp_console_repl_t *repl = NULL;
+    esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+    repl_config.prompt = "knob>";
+    repl_config.task_core_id = TASK_CONSOLE_CORE;
+    repl_config.task_priority = TASK_CONSOLE_PRIORITY;
+    repl_config.task_stack_size = TASK_CONSOLE_STACK;
+    esp_console_dev_usb_serial_jtag_config_t usj_config = ESP_CONSOLE_DEV_USB_SERIAL_JTAG_CONFIG_DEFAULT();
+    ESP_RETURN_ON_ERROR(esp_console_new_repl_usb_serial_jtag(&usj_config, &repl_config, &repl), TAG, "REPL init failed");
+
+    const esp_console_cmd_t cmds[] = {
+        {.command = "perf", .help = "CPU load, FPS, frame times, LVGL heap since the last call", .func = cmd_perf},
+        {.command = "tasks", .help = "Stack high-water marks and CPU share per task", .func = cmd_tasks},
+        {.command = "jitter", .hint = "[seconds]", .help = "Wake-up jitter of a 10 ms probe on each core", .func = cmd_jitter},
+        {.command = "counters", .help = "QSPI, I2C and screen cache counters", .func = cmd_counters},
+        {.command = "stream", .hint = "[period_ms|off]", .help = "Binary samples for tools/perf_stream.py", .func = cmd_stream},
+    };
+    for (size_t i = 0; i < sizeof(cmds) / sizeof(cmds[0]); i++) {
+        ESP_RETURN_ON_ERROR(esp_console_cmd_register(&cmds[i]), TAG, "Register %s failed", cmds[i].command);
+    }
+
+    return esp_console_start_repl(repl);
+}
@@ -0,0 +1,64 @@
+/**
+ * @file perf_console.h
+ * @brief Performance console on USB-Serial-JTAG
+ * @details Takes over from the LVGL on-screen performance monitor, which
+ *          redrew part of the screen every refresh and so skewed the numbers
+ *          it displayed. Commands:
+ *
+ *          - perf      CPU load per core, FPS, render and flush time per frame,
+ *                      LVGL heap and input latency since the previous call
+ *          - tasks     core, stack high-water mark and CPU share of every task
+ *          - jitter    wake-up jitter of a 10 ms probe on each core, run at
+ *                      the priority of that core's main work
+ *          - counters  QSPI and I2C transaction counters
+ *          - stream    binary samples for tools/perf_stream.py
+ *
+ *          A stream sample is 0xA5 0x5A, a length byte, the little-endian
+ *          perf_console_sample_t and a Fletcher-16 over the length byte and
+ *          the sample. Log output is held back while streaming; the log
+ *          levels are left alone.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "lvgl.h"
+
+typedef struct {
+    lv_display_t *disp;
+    uint32_t lvgl_task_stack;   /*!< Configured size, shown next to the high-water mark */
+} perf_console_config_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t seq;
+    uint32_t t_ms;
+    uint16_t fps_x10;
+    uint16_t render_us;         /*!< Average per flushed frame */
+    uint16_t flush_us;          /*!< Average first flush to last transfer done */
+    uint8_t cpu_pct[2];
+    uint32_t lv_heap_free;
+    uint32_t qspi_bytes;        /*!< Since the previous sample */
+    uint16_t i2c_reads;         /*!< Since the previous sample */
+    uint16_t latency_p99_us;    /*!< Input-to-photon, cumulative */
+} perf_console_sample_t;
+
+/**
+ * @brief Start the console REPL on USB-Serial-JTAG
+ *
+ * @note Call from app_main once the services it reports on are up.
+ */
+esp_err_t perf_console_init(const perf_console_config_t *config);
+
+/**
+ * @brief Capture the main task stack high-water mark for "tasks"
+ *
+ * @note Call as the last thing in app_main; the task exits right after.
+ */
+void perf_console_main_done(void);
+
+/**
+ * @brief Count a touch controller read
+ */
+void perf_console_count_i2c(esp_err_t err);
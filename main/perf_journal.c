@@ -0,0 +1,316 @@
+/**
+ * @file perf_journal.c
+ * @brief Performance event journal in the "journal" flash partition
+ */
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_check.h"
+#include "esp_console.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+
+#include "frame_watch.h"
+#include "perf_journal.h"
+#include "task_topology.h"
+
+#define SECTOR_RECORDS ((PERF_JOURNAL_SECTOR_SIZE - sizeof(perf_journal_sector_t)) / sizeof(perf_journal_record_t))
+/* Records read at a time while looking for the end of the current sector */
+#define SCAN_CHUNK 16
+
+static const char *TAG = "perf_journal";
+
+/* Guards the ring and the counters, perf_journal_log() takes it */
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static struct {
+    const esp_partition_t *part;
+    TaskHandle_t writer;
+    uint16_t boot;
+    int64_t stage_us;
+    /* Under s_lock */
+    perf_journal_record_t ring[PERF_JOURNAL_RING];
+    int head;
+    int count;
+    uint32_t dropped_pending;
+    uint32_t dropped;
+    uint32_t written;
+    /* Under flash_lock */
+    SemaphoreHandle_t flash_lock;
+    perf_journal_record_t batch[PERF_JOURNAL_RING + 1];
+    uint16_t sectors;
+    uint16_t sector;
+    uint16_t used;
+    uint32_t seq;
+} s_pj;
+
+static uint32_t header_crc(const perf_journal_sector_t *hdr)
+{
+    return esp_rom_crc32_le(0, (const uint8_t *)hdr, offsetof(perf_journal_sector_t, crc32));
+}
+
+static uint8_t record_check(const perf_journal_record_t *rec)
+{
+    perf_journal_record_t tmp = *rec;
+    tmp.check = 0;
+    return esp_rom_crc32_le(0, (const uint8_t *)&tmp, sizeof(tmp));
+}
+
+static bool record_free(const perf_journal_record_t *rec)
+{
+    const uint8_t *p = (const uint8_t *)rec;
+    for (size_t i = 0; i < sizeof(*rec); i++) {
+        if (p[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static size_t record_offset(int sector, int slot)
+{
+    return sector * PERF_JOURNAL_SECTOR_SIZE + sizeof(perf_journal_sector_t) + slot * sizeof(perf_journal_record_t);
+}
+
+/* Erase a sector and make it current, with the next sequence number */
+static esp_err_t open_sector(int sector)
+{
+    perf_journal_sector_t hdr = {
+        .magic = PERF_JOURNAL_MAGIC,
+        .seq = s_pj.seq + 1,
+        .boot = s_pj.boot,
+        .version = PERF_JOURNAL_VERSION,
+    };
+    hdr.crc32 = header_crc(&hdr);
+    ESP_RETURN_ON_ERROR(esp_partition_erase_range(s_pj.part, sector * PERF_JOURNAL_SECTOR_SIZE,
+                        PERF_JOURNAL_SECTOR_SIZE), TAG, "erase failed");
+    ESP_RETURN_ON_ERROR(esp_partition_write(s_pj.part, sector * PERF_JOURNAL_SECTOR_SIZE, &hdr, sizeof(hdr)), TAG,
+                        "header write failed");
+    s_pj.sector = sector;
+    s_pj.seq = hdr.seq;
+    s_pj.used = 0;
+    return ESP_OK;
+}
+
+/* Find the current sector and its first free record, and number this boot */
+static esp_err_t mount(void)
+{
+    int current = -1;
+    uint16_t last_boot = 0;
+    for (int i = 0; i < s_pj.sectors; i++) {
+        perf_journal_sector_t hdr;
+        ESP_RETURN_ON_ERROR(esp_partition_read(s_pj.part, i * PERF_JOURNAL_SECTOR_SIZE, &hdr, sizeof(hdr)), TAG,
+                            "read failed");
+        if (hdr.magic != PERF_JOURNAL_MAGIC || hdr.version != PERF_JOURNAL_VERSION || hdr.crc32 != header_crc(&hdr)) {
+            continue;
+        }
+        if (current < 0 || hdr.seq > s_pj.seq) {
+            current = i;
+            s_pj.seq = hdr.seq;
+            last_boot = hdr.boot;
+        }
+    }
+    if (current < 0) {
+        ESP_LOGI(TAG, "empty, starting at sector 0");
+        s_pj.seq = 0;
+        s_pj.boot = 1;
+        return open_sector(0);
+    }
+
+    /* Everything up to the last record that is not erased counts as used */
+    perf_journal_record_t chunk[SCAN_CHUNK];
+    int used = 0;
+    for (int slot = 0; slot < SECTOR_RECORDS; slot += SCAN_CHUNK) {
+        int n = SECTOR_RECORDS - slot < SCAN_CHUNK ? SECTOR_RECORDS - slot : SCAN_CHUNK;
+        ESP_RETURN_ON_ERROR(esp_partition_read(s_pj.part, record_offset(current, slot), chunk, n * sizeof(chunk[0])),
+                            TAG, "read failed");
+        for (int i = 0; i < n; i++) {
+            if (record_free(&chunk[i])) {
+                continue;
+            }
+            used = slot + i + 1;
+            if (chunk[i].check == record_check(&chunk[i])) {
+                last_boot = chunk[i].boot;
+            }
+        }
+    }
+    s_pj.sector = current;
+    s_pj.used = used;
+    s_pj.boot = last_boot + 1;
+    return ESP_OK;
+}
+
+static void fill_record(perf_journal_record_t *rec, perf_journal_type_t type, uint32_t a, uint32_t b)
+{
+    rec->type = type;
+    rec->boot = s_pj.boot;
+    rec->t_ms = esp_timer_get_time() / 1000;
+    rec->a = a;
+    rec->b = b;
+    rec->check = record_check(rec);
+}
+
+void perf_journal_log(perf_journal_type_t type, uint32_t a, uint32_t b)
+{
+    if (!s_pj.writer) {
+        return;
+    }
+    perf_journal_record_t rec;
+    fill_record(&rec, type, a, b);
+
+    bool wake = false;
+    portENTER_CRITICAL(&s_lock);
+    if (s_pj.count < PERF_JOURNAL_RING) {
+        s_pj.ring[(s_pj.head + s_pj.count) % PERF_JOURNAL_RING] = rec;
+        s_pj.count++;
+        wake = s_pj.count == PERF_JOURNAL_RING / 2;
+    } else {
+        s_pj.dropped_pending++;
+        s_pj.dropped++;
+    }
+    portEXIT_CRITICAL(&s_lock);
+    if (wake) {
+        xTaskNotifyGive(s_pj.writer);
+    }
+}
+
+void perf_journal_boot_stage(perf_journal_stage_t stage)
+{
+    int64_t now = esp_timer_get_time();
+    perf_journal_log(PERF_JOURNAL_BOOT_STAGE, stage, now - s_pj.stage_us);
+    s_pj.stage_us = now;
+}
+
+esp_err_t perf_journal_flush(void)
+{
+    ESP_RETURN_ON_FALSE(s_pj.writer, ESP_ERR_INVALID_STATE, TAG, "Not initialized");
+    xSemaphoreTake(s_pj.flash_lock, portMAX_DELAY);
+
+    portENTER_CRITICAL(&s_lock);
+    int n = s_pj.count;
+    for (int i = 0; i < n; i++) {
+        s_pj.batch[i] = s_pj.ring[(s_pj.head + i) % PERF_JOURNAL_RING];
+    }
+    s_pj.head = (s_pj.head + n) % PERF_JOURNAL_RING;
+    s_pj.count = 0;
+    uint32_t dropped = s_pj.dropped_pending;
+    s_pj.dropped_pending = 0;
+    portEXIT_CRITICAL(&s_lock);
+    if (dropped) {
+        fill_record(&s_pj.batch[n++], PERF_JOURNAL_DROPPED, dropped, 0);
+    }
+
+    /* Flash writes stall the caches of both cores, so charge them to the frame */
+    esp_err_t ret = ESP_OK;
+    int64_t t = frame_watch_phase_begin();
+    for (int i = 0; i < n;) {
+        if (s_pj.used == SECTOR_RECORDS) {
+            ESP_GOTO_ON_ERROR(open_sector((s_pj.sector + 1) % s_pj.sectors), out, TAG, "cannot advance");
+        }
+        int len = SECTOR_RECORDS - s_pj.used;
+        if (len > n - i) {
+            len = n - i;
+        }
+        ret = esp_partition_write(s_pj.part, record_offset(s_pj.sector, s_pj.used), &s_pj.batch[i],
+                                  len * sizeof(s_pj.batch[0]));
+        /* A failed write may have left bits behind; never write those slots again */
+        s_pj.used += len;
+        i += len;
+        ESP_GOTO_ON_ERROR(ret, out, TAG, "write failed");
+        portENTER_CRITICAL(&s_lock);
+        s_pj.written += len;
+        portEXIT_CRITICAL(&s_lock);
+    }
+out:
+    frame_watch_phase_end(FRAME_PHASE_JOURNAL, t);
+    xSemaphoreGive(s_pj.flash_lock);
+    return ret;
+}
+
+static void writer_task(void *arg)
+{
+    TickType_t period = pdMS_TO_TICKS((uint32_t)(uintptr_t)arg);
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, period);
+        perf_journal_flush();
+    }
+}
+
+esp_err_t perf_journal_init(const perf_journal_config_t *config)
+{
+    ESP_RETURN_ON_FALSE(config && config->flush_ms, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(!s_pj.writer, ESP_ERR_INVALID_STATE, TAG, "Already initialized");
+
+    int64_t now = esp_timer_get_time();
+    s_pj.part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, PERF_JOURNAL_PARTITION_SUBTYPE, "journal");
+    ESP_RETURN_ON_FALSE(s_pj.part, ESP_ERR_NOT_FOUND, TAG, "no journal partition");
+    s_pj.sectors = s_pj.part->size / PERF_JOURNAL_SECTOR_SIZE;
+    ESP_RETURN_ON_FALSE(s_pj.sectors >= 2, ESP_ERR_INVALID_SIZE, TAG, "journal partition too small");
+    ESP_RETURN_ON_ERROR(mount(), TAG, "mount failed");
+
+    if (!s_pj.flash_lock) {
+        s_pj.flash_lock = xSemaphoreCreateMutex();
+        ESP_RETURN_ON_FALSE(s_pj.flash_lock, ESP_ERR_NO_MEM, TAG, "Create mutex failed");
+    }
+    BaseType_t res = xTaskCreatePinnedToCore(writer_task, "journal", TASK_JOURNAL_STACK,
+                                             (void *)(uintptr_t)config->flush_ms, TASK_JOURNAL_PRIORITY, &s_pj.writer,
+                                             TASK_JOURNAL_CORE);
+    ESP_RETURN_ON_FALSE(res == pdPASS, ESP_ERR_NO_MEM, TAG, "Create task failed");
+
+    ESP_LOGI(TAG, "boot %u, sector %u of %u, %u records in it", s_pj.boot, s_pj.sector, s_pj.sectors, s_pj.used);
+    s_pj.stage_us = esp_timer_get_time();
+    perf_journal_log(PERF_JOURNAL_BOOT, esp_reset_reason(), now);
+    return ESP_OK;
+}
+
+void perf_journal_get_stats(perf_journal_stats_t *stats)
+{
+    if (s_pj.flash_lock) {
+        xSemaphoreTake(s_pj.flash_lock, portMAX_DELAY);
+    }
+    stats->boot = s_pj.boot;
+    stats->sectors = s_pj.sectors;
+    stats->sector = s_pj.sector;
+    stats->used = s_pj.used;
+    if (s_pj.flash_lock) {
+        xSemaphoreGive(s_pj.flash_lock);
+    }
+    portENTER_CRITICAL(&s_lock);
+    stats->written = s_pj.written;
+    stats->dropped = s_pj.dropped;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+static int cmd_journal(int argc, char **argv)
+{
+    esp_err_t err = perf_journal_flush();
+    if (err != ESP_OK) {
+        printf("%s\n", esp_err_to_name(err));
+        return 1;
+    }
+    perf_journal_stats_t stats;
+    perf_journal_get_stats(&stats);
+    printf("boot %u, sector %u of %u with %u of %u records; this boot %" PRIu32 " written, %" PRIu32 " dropped\n",
+           stats.boot, stats.sector, stats.sectors, stats.used, (unsigned)SECTOR_RECORDS, stats.written,
+           stats.dropped);
+    return 0;
+}
+
+esp_err_t perf_journal_register_console(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "journal",
+        .help = "Write out the performance journal and show where it stands",
+        .func = cmd_journal,
+    };
+    return esp_console_cmd_register(&cmd);
+}
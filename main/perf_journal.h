@@ -0,0 +1,124 @@
+/**
+ * @file perf_journal.h
+ * @brief Performance event journal in the "journal" flash partition
+ * @details Events that explain a slowdown or a reset after the fact survive a
+ *          power cycle here: the reset reason and the duration of every boot
+ *          stage, frames over the budget and CST820 I2C failures.
+ *
+ *          perf_journal_log() only copies a record into a RAM ring. A
+ *          low-priority writer task on the I/O core appends the ring to
+ *          flash every flush_ms, or sooner once the ring is half full, so
+ *          the render and input paths never wait for flash. When the ring fills up anyway, new
+ *          records are dropped and a DROPPED record counts them.
+ *
+ *          The partition is a ring of 4 KB sectors, each starting with a
+ *          perf_journal_sector_t; the valid header with the highest
+ *          sequence number is the sector being written. Records are
+ *          appended until the sector is full, then the next sector, which
+ *          holds the oldest records, is erased and takes the next sequence
+ *          number, so every sector is erased once per lap. A record still
+ *          all 0xFF is free; a torn write fails the record check and is
+ *          skipped. tools/journal_dump.py decodes a partition read back
+ *          with parttool.py.
+ *
+ *          All values are little-endian.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#define PERF_JOURNAL_PARTITION_SUBTYPE 0x41
+#define PERF_JOURNAL_MAGIC 0x4A424E4B      /* "KNBJ" */
+#define PERF_JOURNAL_VERSION 1
+#define PERF_JOURNAL_SECTOR_SIZE 4096
+/* Records waiting in RAM for the writer task */
+#define PERF_JOURNAL_RING 64
+
+typedef enum {
+    PERF_JOURNAL_BOOT = 1,          /*!< a: esp_reset_reason_t, b: us from start-up to perf_journal_init() */
+    PERF_JOURNAL_BOOT_STAGE = 2,    /*!< a: perf_journal_stage_t, b: duration in us */
+    PERF_JOURNAL_FRAME_OVER = 3,    /*!< a: frame in us, b: longest frame_phase_t | its us << 8 */
+    PERF_JOURNAL_I2C_ERROR = 4,     /*!< a: esp_err_t of the first failed touch read */
+    PERF_JOURNAL_I2C_RECOVERED = 5, /*!< a: failed reads in a row, b: ms until a read worked again */
+    PERF_JOURNAL_DROPPED = 6,       /*!< a: records lost to a full ring */
+} perf_journal_type_t;
+
+typedef enum {
+    PERF_JOURNAL_STAGE_STORAGE = 0, /*!< NVS, settings and assets */
+    PERF_JOURNAL_STAGE_FAN,         /*!< LEDC and the fan calibration */
+    PERF_JOURNAL_STAGE_PANEL,       /*!< QSPI bus and SH8601 init */
+    PERF_JOURNAL_STAGE_TOUCH,       /*!< I2C bus and CST820 init */
+    PERF_JOURNAL_STAGE_LVGL,        /*!< Draw buffers, LVGL port and power management */
+    PERF_JOURNAL_STAGE_UI,          /*!< Input drivers and ui_init() */
+    PERF_JOURNAL_STAGE_SERVICES,    /*!< Display idle, frame watch and console */
+} perf_journal_stage_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;               /*!< Highest is the sector being written */
+    uint16_t boot;              /*!< Boot that opened the sector */
+    uint8_t version;
+    uint8_t reserved;
+    uint32_t crc32;             /*!< Over the 12 bytes above */
+} perf_journal_sector_t;
+
+typedef struct {
+    uint8_t type;               /*!< perf_journal_type_t, 0xFF free */
+    uint8_t check;              /*!< Low byte of the CRC-32 of the record with this byte 0 */
+    uint16_t boot;              /*!< Boot counter, one more than the last boot in the journal */
+    uint32_t t_ms;              /*!< Since start-up */
+    uint32_t a;
+    uint32_t b;
+} perf_journal_record_t;
+
+_Static_assert(sizeof(perf_journal_sector_t) == 16, "sector header layout");
+_Static_assert(sizeof(perf_journal_record_t) == 16, "record layout");
+
+typedef struct {
+    uint32_t flush_ms;          /*!< Longest a record waits in RAM */
+} perf_journal_config_t;
+
+typedef struct {
+    uint16_t boot;
+    uint16_t sectors;
+    uint16_t sector;            /*!< Being written */
+    uint16_t used;              /*!< Records in it */
+    uint32_t written;           /*!< Records written this boot */
+    uint32_t dropped;           /*!< Records lost this boot */
+} perf_journal_stats_t;
+
+/**
+ * @brief Find the current sector, log the reset reason and start the writer
+ *
+ * @note Call first in app_main(); boot stages are timed from here.
+ */
+esp_err_t perf_journal_init(const perf_journal_config_t *config);
+
+/**
+ * @brief Queue a record; any task, not ISRs
+ *
+ * Does nothing before perf_journal_init().
+ */
+void perf_journal_log(perf_journal_type_t type, uint32_t a, uint32_t b);
+
+/**
+ * @brief Log a BOOT_STAGE with the time since the previous stage or init
+ */
+void perf_journal_boot_stage(perf_journal_stage_t stage);
+
+/**
+ * @brief Write out everything queued now, from the calling task
+ */
+esp_err_t perf_journal_flush(void);
+
+void perf_journal_get_stats(perf_journal_stats_t *stats);
+
+/**
+ * @brief Add the "journal" command to the console
+ *
+ * @note Call once the console REPL exists.
+ */
+esp_err_t perf_journal_register_console(void);
@@ -0,0 +1,265 @@
+/**
+ * @file power_mgmt.c
+ * @brief Dynamic frequency scaling, automatic light sleep and wake latency
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "hal/gpio_ll.h"
+
+#include "esp_lcd_touch_cst820.h"
+#include "esp_lvgl_port.h"
+
+#include "disp_flush.h"
+#include "power_mgmt.h"
+
+/* XTAL frequency, the lowest DFS step that keeps the APB at 40 MHz */
+#define POWER_MGMT_MIN_FREQ_MHZ 40
+
+static const char *TAG = "power_mgmt";
+
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t s_ui_lock = NULL;
+static esp_pm_lock_handle_t s_render_lock = NULL;
+#endif
+static gpio_num_t s_touch_int = GPIO_NUM_NC;
+static bool s_ui_active = true;
+/* Touch INT is level triggered for the light sleep wake-up */
+static volatile bool s_touch_level = false;
+
+/* CST820 power mode, changed by the display idle task only */
+static esp_lcd_touch_handle_t s_touch = NULL;
+static uint8_t s_touch_auto_sleep_s = 0;
+static bool s_touch_deep_sleep = false;
+static esp_lcd_touch_cst820_power_t s_touch_mode = ESP_LCD_TOUCH_CST820_ACTIVE;
+
+/* Timestamp of the input that woke the display, 0 when not measuring */
+static volatile int64_t s_wake_start_us = 0;
+static power_mgmt_wake_stats_t s_wake;
+static power_mgmt_wake_stats_t s_touch_wake;
+static portMUX_TYPE s_wake_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Call with s_wake_lock held */
+static void IRAM_ATTR add_wake_sample(power_mgmt_wake_stats_t *stats, uint32_t latency)
+{
+    stats->last_us = latency;
+    if (!stats->count || latency < stats->min_us) {
+        stats->min_us = latency;
+    }
+    if (latency > stats->max_us) {
+        stats->max_us = latency;
+    }
+    stats->total_us += latency;
+    stats->count++;
+}
+
+static void IRAM_ATTR on_frame_done(int64_t done_us, void *arg)
+{
+    int64_t start = s_wake_start_us;
+    if (!start) {
+        return;
+    }
+    s_wake_start_us = 0;
+
+    portENTER_CRITICAL_SAFE(&s_wake_lock);
+    add_wake_sample(&s_wake, (uint32_t)(done_us - start));
+    portEXIT_CRITICAL_SAFE(&s_wake_lock);
+}
+
+#if CONFIG_PM_ENABLE
+/* Render at full speed, let DFS drop the clock between frames */
+static void refr_event_cb(lv_event_t *e)
+{
+    if (lv_event_get_code(e) == LV_EVENT_REFR_START) {
+        esp_pm_lock_acquire(s_render_lock);
+    } else {
+        esp_pm_lock_release(s_render_lock);
+    }
+}
+#endif
+
+/* Light sleep only wakes on GPIO levels, the INT edge interrupt is not enough */
+static void touch_wake_enable(bool enable)
+{
+    if (s_touch_int == GPIO_NUM_NC) {
+        return;
+    }
+    if (enable) {
+        gpio_wakeup_enable(s_touch_int, GPIO_INTR_LOW_LEVEL);
+        s_touch_level = true;
+    } else {
+        /* Not atomic with the ISR, which may have switched back already; both end up the same */
+        s_touch_level = false;
+        gpio_wakeup_disable(s_touch_int);
+        gpio_set_intr_type(s_touch_int, GPIO_INTR_NEGEDGE);
+    }
+}
+
+void IRAM_ATTR power_mgmt_touch_isr(void)
+{
+    if (!s_touch_level) {
+        return;
+    }
+    /* Awake now; the input wakes the display, which disarms the wake-up anyway. Until then a level
+     * interrupt would fire again for as long as the CST820 holds INT low. */
+    s_touch_level = false;
+    gpio_dev_t *hw = GPIO_LL_GET_HW(GPIO_PORT_0);
+    gpio_ll_wakeup_disable(hw, s_touch_int);
+    gpio_ll_set_intr_type(hw, s_touch_int, GPIO_INTR_NEGEDGE);
+}
+
+static esp_lcd_touch_cst820_power_t touch_mode_for(display_idle_state_t state)
+{
+    switch (state) {
+    case DISPLAY_IDLE_FULL:
+        return ESP_LCD_TOUCH_CST820_ACTIVE;
+    case DISPLAY_IDLE_DIM:
+        return s_touch_auto_sleep_s ? ESP_LCD_TOUCH_CST820_AUTO_SLEEP : ESP_LCD_TOUCH_CST820_ACTIVE;
+    case DISPLAY_IDLE_OFF:
+        return ESP_LCD_TOUCH_CST820_STANDBY;
+    default:
+        return s_touch_deep_sleep ? ESP_LCD_TOUCH_CST820_DEEP_SLEEP : ESP_LCD_TOUCH_CST820_STANDBY;
+    }
+}
+
+/* The touch task may be reading meanwhile; the I2C driver serialises the transactions */
+static void touch_follow(display_idle_state_t to)
+{
+    esp_lcd_touch_cst820_power_t mode = touch_mode_for(to);
+    if (!s_touch || mode == s_touch_mode) {
+        return;
+    }
+
+    /* Only full-rate scanning is sure to answer I2C */
+    if (s_touch_mode != ESP_LCD_TOUCH_CST820_ACTIVE) {
+        uint32_t wake_us = 0;
+        esp_err_t err = esp_lcd_touch_cst820_wake(s_touch, &wake_us);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Touch wake failed: %s", esp_err_to_name(err));
+            return;
+        }
+        if (mode < s_touch_mode) {
+            portENTER_CRITICAL(&s_wake_lock);
+            add_wake_sample(&s_touch_wake, wake_us);
+            portEXIT_CRITICAL(&s_wake_lock);
+        }
+        if (s_touch_mode == ESP_LCD_TOUCH_CST820_DEEP_SLEEP && s_touch_int != GPIO_NUM_NC) {
+            gpio_intr_enable(s_touch_int);
+        }
+        s_touch_mode = ESP_LCD_TOUCH_CST820_ACTIVE;
+    }
+    if (mode == ESP_LCD_TOUCH_CST820_DEEP_SLEEP && s_touch_int != GPIO_NUM_NC) {
+        /* Nothing drives INT in deep sleep, a floating line must not wake anything */
+        touch_wake_enable(false);
+        gpio_intr_disable(s_touch_int);
+    }
+    esp_err_t err = esp_lcd_touch_cst820_set_power(s_touch, mode, s_touch_auto_sleep_s);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Touch power mode %d failed: %s", mode, esp_err_to_name(err));
+        if (mode == ESP_LCD_TOUCH_CST820_DEEP_SLEEP && s_touch_int != GPIO_NUM_NC) {
+            touch_wake_enable(true);
+            gpio_intr_enable(s_touch_int);
+        }
+        return;
+    }
+    s_touch_mode = mode;
+}
+
+void power_mgmt_display_transition(display_idle_state_t from, display_idle_state_t to, int64_t activity_us)
+{
+    touch_follow(to);
+
+    bool active = to < DISPLAY_IDLE_OFF;
+    if (active == s_ui_active) {
+        return;
+    }
+    s_ui_active = active;
+
+    if (active) {
+        s_wake_start_us = activity_us;
+        touch_wake_enable(false);
+#if CONFIG_PM_ENABLE
+        if (s_ui_lock) {
+            esp_pm_lock_acquire(s_ui_lock);
+        }
+#endif
+    } else {
+        s_wake_start_us = 0;
+#if CONFIG_PM_ENABLE
+        if (s_ui_lock) {
+            esp_pm_lock_release(s_ui_lock);
+        }
+#endif
+        touch_wake_enable(true);
+    }
+}
+
+void power_mgmt_get_wake_stats(power_mgmt_wake_stats_t *stats)
+{
+    portENTER_CRITICAL(&s_wake_lock);
+    *stats = s_wake;
+    portEXIT_CRITICAL(&s_wake_lock);
+}
+
+void power_mgmt_get_touch_wake_stats(power_mgmt_wake_stats_t *stats)
+{
+    portENTER_CRITICAL(&s_wake_lock);
+    *stats = s_touch_wake;
+    portEXIT_CRITICAL(&s_wake_lock);
+}
+
+esp_err_t power_mgmt_init(const power_mgmt_config_t *config)
+{
+    ESP_RETURN_ON_FALSE(config && config->disp, ESP_ERR_INVALID_ARG, TAG, "Invalid config");
+
+    s_touch_int = config->touch_int_gpio;
+    ESP_RETURN_ON_ERROR(disp_flush_add_frame_observer(on_frame_done, NULL), TAG, "Frame observer failed");
+
+    if (config->touch) {
+        s_touch_auto_sleep_s = config->touch_auto_sleep_s;
+        s_touch_deep_sleep = config->touch_deep_sleep;
+        /* The UI is on screen: scan at full rate, whatever the chip defaults to after reset */
+        esp_err_t err = esp_lcd_touch_cst820_wake(config->touch, NULL);
+        if (err == ESP_OK) {
+            err = esp_lcd_touch_cst820_set_power(config->touch, ESP_LCD_TOUCH_CST820_ACTIVE, 0);
+        }
+        if (err == ESP_OK) {
+            s_touch_mode = ESP_LCD_TOUCH_CST820_ACTIVE;
+        } else {
+            /* Not fatal: touch works in the chip's own mode, and the next transition wakes it first */
+            ESP_LOGW(TAG, "Touch power mode failed: %s", esp_err_to_name(err));
+            s_touch_mode = ESP_LCD_TOUCH_CST820_AUTO_SLEEP;
+        }
+        s_touch = config->touch;
+    }
+
+#if CONFIG_PM_ENABLE
+    const esp_pm_config_t pm_cfg = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = POWER_MGMT_MIN_FREQ_MHZ,
+        .light_sleep_enable = config->light_sleep,
+    };
+    ESP_RETURN_ON_ERROR(esp_pm_configure(&pm_cfg), TAG, "PM configure failed");
+    ESP_RETURN_ON_ERROR(esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "render", &s_render_lock), TAG, "Render lock failed");
+    /* Without light sleep there is nothing to block, and nothing would ever release it */
+    if (config->light_sleep) {
+        ESP_RETURN_ON_ERROR(esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "ui", &s_ui_lock), TAG, "UI lock failed");
+        /* The UI is on screen at boot */
+        esp_pm_lock_acquire(s_ui_lock);
+    }
+
+    lvgl_port_lock(0);
+    lv_display_add_event_cb(config->disp, refr_event_cb, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(config->disp, refr_event_cb, LV_EVENT_REFR_READY, NULL);
+    lvgl_port_unlock();
+#endif
+
+    if (config->light_sleep) {
+        ESP_RETURN_ON_ERROR(esp_sleep_enable_gpio_wakeup(), TAG, "GPIO wakeup failed");
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file power_mgmt.h
+ * @brief Dynamic frequency scaling, automatic light sleep and wake latency
+ * @details The CPU runs at full speed only while LVGL refreshes a frame.
+ *          With light_sleep set, light sleep is blocked while the UI is on
+ *          screen and allowed once the display idle manager has switched the
+ *          display off; GPIO0, the encoder and the CST820 INT line wake the
+ *          chip. The time from the
+ *          waking input to the first complete frame on the panel is recorded.
+ *
+ *          The CST820 follows the display: full-rate scanning on FULL,
+ *          auto-sleep on DIM, standby once the display is off and
+ *          optionally deep sleep with the panel, where only the knob and
+ *          the button wake the device. Coming back, the controller is woken
+ *          before it is set to scan at full rate, and the time until it
+ *          answers is recorded as the touch wake latency.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "esp_lcd_touch.h"
+#include "lvgl.h"
+
+#include "display_idle.h"
+
+typedef struct {
+    lv_display_t *disp;
+    gpio_num_t touch_int_gpio;      /*!< GPIO_NUM_NC if touch should not wake */
+    bool light_sleep;               /*!< Display idle calls power_mgmt_display_transition(); otherwise DFS only */
+    esp_lcd_touch_handle_t touch;   /*!< CST820 to follow the display, NULL to leave it scanning */
+    uint8_t touch_auto_sleep_s;     /*!< Low-power scanning after this while dimmed, 0 for full rate */
+    bool touch_deep_sleep;          /*!< Deep sleep with the panel, touch no longer wakes */
+} power_mgmt_config_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t last_us;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t total_us;
+} power_mgmt_wake_stats_t;
+
+/**
+ * @brief Configure power management and hook into the display
+ *
+ * @note Call after disp_flush_install(), without the LVGL port lock held.
+ */
+esp_err_t power_mgmt_init(const power_mgmt_config_t *config);
+
+/**
+ * @brief display_idle transition hook
+ */
+void power_mgmt_display_transition(display_idle_state_t from, display_idle_state_t to, int64_t activity_us);
+
+/**
+ * @brief Call first thing from the touch INT handler
+ *
+ * The light sleep wake-up makes INT level triggered while the display is
+ * off; this puts it back to edge triggered once it has fired.
+ */
+void power_mgmt_touch_isr(void);
+
+/**
+ * @brief Wake-to-first-frame latency since boot
+ */
+void power_mgmt_get_wake_stats(power_mgmt_wake_stats_t *stats);
+
+/**
+ * @brief Time for the CST820 to answer again after low-power scanning or deep sleep, since boot
+ */
+void power_mgmt_get_touch_wake_stats(power_mgmt_wake_stats_t *stats);
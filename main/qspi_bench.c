@@ -0,0 +1,208 @@
+/**
+ * @file qspi_bench.c
+ * @brief QSPI flush throughput benchmark and strip height selection
+ */
+
+#include <inttypes.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+
+#include "qspi_bench.h"
+
+#define QSPI_BENCH_PASSES 4
+#define QSPI_BENCH_MAX_DEPTH 4
+/* Accept a smaller strip if it is this close to the best throughput */
+#define QSPI_BENCH_TOLERANCE_PCT 3
+
+static const char *TAG = "qspi_bench";
+
+static const int bench_rows[] = {2, 4, 8, 16, 32, 60, QSPI_BENCH_MAX_ROWS};
+static const int bench_depths[] = {1, 2, QSPI_BENCH_MAX_DEPTH};
+
+typedef struct {
+    SemaphoreHandle_t slots;
+    uint32_t wire_us;           /* Pure data time of one transfer on the bus */
+    volatile uint32_t done;
+    volatile int64_t last_done_us;
+    volatile int64_t idle_sum_us;
+    volatile int64_t idle_max_us;
+} bench_ctx_t;
+
+static bench_ctx_t s_bench;
+
+static bool IRAM_ATTR bench_trans_done(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx)
+{
+    BaseType_t need_yield = pdFALSE;
+    int64_t now = esp_timer_get_time();
+    if (s_bench.done) {
+        /* Whatever the interval holds beyond the data itself, the bus sat idle */
+        int64_t idle = now - s_bench.last_done_us - s_bench.wire_us;
+        if (idle > 0) {
+            s_bench.idle_sum_us += idle;
+            if (idle > s_bench.idle_max_us) {
+                s_bench.idle_max_us = idle;
+            }
+        }
+    }
+    s_bench.last_done_us = now;
+    s_bench.done++;
+    xSemaphoreGiveFromISR(s_bench.slots, &need_yield);
+    return need_yield == pdTRUE;
+}
+
+typedef struct {
+    uint32_t kbps;
+    uint32_t cpu_us;
+    uint32_t idle_avg_us;
+    uint32_t idle_max_us;
+    uint32_t bus_pct;
+} bench_result_t;
+
+static void bench_one(const qspi_bench_config_t *cfg, const uint8_t *buf, int rows, int32_t width, int depth,
+                      bench_result_t *res)
+{
+    const int32_t x1 = ((cfg->h_res - width) / 2) & ~1;
+    const int32_t y_end = cfg->v_res - cfg->v_res % rows;
+    const uint32_t bytes = width * rows * 2;
+
+    s_bench.wire_us = (uint32_t)((uint64_t)bytes * 8 * 1000000 / ((uint64_t)cfg->pclk_hz * cfg->data_lines));
+    s_bench.done = 0;
+    s_bench.idle_sum_us = 0;
+    s_bench.idle_max_us = 0;
+    while (xSemaphoreTake(s_bench.slots, 0) == pdTRUE) {
+    }
+    for (int i = 0; i < depth; i++) {
+        xSemaphoreGive(s_bench.slots);
+    }
+
+    uint32_t sent = 0;
+    int64_t cpu_us = 0;
+    int64_t start = esp_timer_get_time();
+    for (int pass = 0; pass < QSPI_BENCH_PASSES; pass++) {
+        for (int32_t y = 0; y < y_end; y += rows) {
+            xSemaphoreTake(s_bench.slots, portMAX_DELAY);
+            int64_t t0 = esp_timer_get_time();
+            esp_err_t err = esp_lcd_panel_draw_bitmap(cfg->panel, x1, y, x1 + width, y + rows, buf);
+            cpu_us += esp_timer_get_time() - t0;
+            if (err != ESP_OK) {
+                /* No completion will hand the slot back */
+                xSemaphoreGive(s_bench.slots);
+                continue;
+            }
+            sent++;
+        }
+    }
+    /* Drain: every slot back means every transfer completed */
+    for (int i = 0; i < depth; i++) {
+        xSemaphoreTake(s_bench.slots, portMAX_DELAY);
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+
+    if (!sent) {
+        memset(res, 0, sizeof(*res));
+        return;
+    }
+    uint64_t total = (uint64_t)bytes * sent;
+    res->kbps = (uint32_t)(total * 1000 / elapsed);
+    res->cpu_us = (uint32_t)(cpu_us / sent);
+    res->idle_avg_us = sent > 1 ? (uint32_t)(s_bench.idle_sum_us / (sent - 1)) : 0;
+    res->idle_max_us = (uint32_t)s_bench.idle_max_us;
+    res->bus_pct = (uint32_t)((uint64_t)s_bench.wire_us * sent * 100 / elapsed);
+}
+
+esp_err_t qspi_bench_run(const qspi_bench_config_t *config, int *best_rows)
+{
+    ESP_RETURN_ON_FALSE(config && best_rows, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+
+    esp_err_t ret = ESP_OK;
+    const size_t buf_size = config->h_res * QSPI_BENCH_MAX_ROWS * 2;
+    uint8_t *buf = heap_caps_malloc(buf_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    ESP_RETURN_ON_FALSE(buf, ESP_ERR_NO_MEM, TAG, "No memory for buffer");
+    s_bench.slots = xSemaphoreCreateCounting(QSPI_BENCH_MAX_DEPTH, 0);
+    ESP_GOTO_ON_FALSE(s_bench.slots, ESP_ERR_NO_MEM, err, TAG, "No memory for semaphore");
+
+    /* Dim grey stripes, bright enough to see the sweep progress */
+    for (size_t i = 0; i < buf_size; i += 2) {
+        buf[i] = (i / (config->h_res * 2)) & 1 ? 0x31 : 0x10;
+        buf[i + 1] = 0x86;
+    }
+
+    const esp_lcd_panel_io_callbacks_t cbs = {
+        .on_color_trans_done = bench_trans_done,
+    };
+    ESP_GOTO_ON_ERROR(esp_lcd_panel_io_register_event_callbacks(config->io, &cbs, NULL), err, TAG, "IO callbacks failed");
+
+    const int32_t widths[] = {config->h_res, config->h_res / 2};
+    uint32_t row_best_kbps[sizeof(bench_rows) / sizeof(bench_rows[0])] = {0};
+    uint32_t best_kbps = 0;
+
+    ESP_LOGI(TAG, "pclk %" PRIu32 " Hz x%d lines, %d passes per case", config->pclk_hz, config->data_lines, QSPI_BENCH_PASSES);
+    ESP_LOGI(TAG, " rows width depth    KB/s  cpu us/call  idle avg/max us  bus %%");
+    for (int r = 0; r < sizeof(bench_rows) / sizeof(bench_rows[0]); r++) {
+        for (int w = 0; w < sizeof(widths) / sizeof(widths[0]); w++) {
+            for (int d = 0; d < sizeof(bench_depths) / sizeof(bench_depths[0]); d++) {
+                bench_result_t res;
+                bench_one(config, buf, bench_rows[r], widths[w], bench_depths[d], &res);
+                ESP_LOGI(TAG, "%5d %5" PRId32 " %5d %7" PRIu32 " %12" PRIu32 " %8" PRIu32 "/%-6" PRIu32 " %5" PRIu32,
+                         bench_rows[r], widths[w], bench_depths[d], res.kbps, res.cpu_us,
+                         res.idle_avg_us, res.idle_max_us, res.bus_pct);
+                /* LVGL flushes full-width strips, those decide the height */
+                if (w == 0 && res.kbps > row_best_kbps[r]) {
+                    row_best_kbps[r] = res.kbps;
+                }
+            }
+        }
+        best_kbps = row_best_kbps[r] > best_kbps ? row_best_kbps[r] : best_kbps;
+    }
+
+    *best_rows = bench_rows[0];
+    for (int r = 0; r < sizeof(bench_rows) / sizeof(bench_rows[0]); r++) {
+        if (row_best_kbps[r] * 100 >= best_kbps * (100 - QSPI_BENCH_TOLERANCE_PCT)) {
+            *best_rows = bench_rows[r];
+            break;
+        }
+    }
+    ESP_LOGI(TAG, "best %" PRIu32 " KB/s, strip height %d rows", best_kbps, *best_rows);
+
+err:
+    if (s_bench.slots) {
+        vSemaphoreDelete(s_bench.slots);
+        s_bench.slots = NULL;
+    }
+    heap_caps_free(buf);
+    return ret;
+}
+
+int qspi_bench_load_strip_rows(int fallback)
+{
+    nvs_handle_t handle;
+    uint16_t rows = 0;
+    if (nvs_open("qspi", NVS_READONLY, &handle) == ESP_OK) {
+        nvs_get_u16(handle, "strip_rows", &rows);
+        nvs_close(handle);
+    }
+    if (rows < 2 || rows > QSPI_BENCH_MAX_ROWS || (rows & 1)) {
+        return fallback;
+    }
+    return rows;
+}
+
+esp_err_t qspi_bench_save_strip_rows(int rows)
+{
+    nvs_handle_t handle;
+    ESP_RETURN_ON_ERROR(nvs_open("qspi", NVS_READWRITE, &handle), TAG, "NVS open failed");
+    esp_err_t ret = nvs_set_u16(handle, "strip_rows", (uint16_t)rows);
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return ret;
+}
@@ -0,0 +1,47 @@
+/**
+ * @file qspi_bench.h
+ * @brief QSPI flush throughput benchmark and strip height selection
+ * @details Sweeps strip heights, area widths and the number of draw_bitmap
+ *          calls kept in flight, straight on the panel before LVGL starts.
+ *          Reports throughput, CPU time spent in esp_lcd_panel_draw_bitmap
+ *          and the idle time of the bus between transfers. The chosen strip
+ *          height is kept in NVS and sizes the LVGL draw buffers at boot.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_ops.h"
+
+/* Tallest strip the benchmark tries, also bounds the SPI max_transfer_sz */
+#define QSPI_BENCH_MAX_ROWS 96
+
+typedef struct {
+    esp_lcd_panel_handle_t panel;
+    esp_lcd_panel_io_handle_t io;
+    int32_t h_res;
+    int32_t v_res;
+    uint32_t pclk_hz;
+    uint8_t data_lines;     /*!< 4 for QSPI */
+} qspi_bench_config_t;
+
+/**
+ * @brief Run the sweep and log a result table
+ *
+ * @note Call before the LVGL display is added: the IO completion callback is
+ *       borrowed for the duration of the run.
+ *
+ * @param[out] best_rows Smallest strip height within a few percent of the
+ *                       best full-width throughput
+ */
+esp_err_t qspi_bench_run(const qspi_bench_config_t *config, int *best_rows);
+
+/**
+ * @brief Strip height stored by a previous run, or fallback
+ */
+int qspi_bench_load_strip_rows(int fallback);
+
+esp_err_t qspi_bench_save_strip_rows(int rows);
@@ -0,0 +1,204 @@
+/**
+ * @file ring_arc.c
+ * @brief Progress ring with a pre-rendered background
+ */
+
+#include <string.h>
+
+#include "esp_heap_caps.h"
+
+#include "ring_arc.h"
+
+#define RING_ARC_ROTATION 270
+
+typedef struct {
+    lv_draw_buf_t mask;
+    uint8_t *mask_data;
+    int32_t diameter;
+    int32_t width;
+    int32_t min;
+    int32_t max;
+    int32_t value;
+} ring_arc_t;
+
+static uint32_t isqrt32(uint32_t x)
+{
+    uint32_t res = 0;
+    uint32_t bit = 1UL << 30;
+    while (bit > x) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (x >= res + bit) {
+            x -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return res;
+}
+
+/* Anti-aliased annulus coverage, computed in 1/16 px to match the arc renderer */
+static void render_mask(ring_arc_t *ring)
+{
+    const int32_t d = ring->diameter;
+    const int32_t r_out = (d / 2) * 16;
+    const int32_t r_in = (d / 2 - ring->width) * 16;
+    const uint32_t stride = ring->mask.header.stride;
+
+    for (int32_t y = 0; y < d; y++) {
+        int32_t dy = (y * 16 + 8) - (d / 2) * 16;
+        uint8_t *row = ring->mask_data + y * stride;
+        for (int32_t x = 0; x < d; x++) {
+            int32_t dx = (x * 16 + 8) - (d / 2) * 16;
+            int32_t dist = (int32_t)isqrt32((uint32_t)(dx * dx + dy * dy));
+            int32_t outer = LV_CLAMP(0, r_out - dist + 8, 16);
+            int32_t inner = LV_CLAMP(0, dist - r_in + 8, 16);
+            row[x] = (uint8_t)((outer * inner * 255) / 256);
+        }
+    }
+}
+
+static int32_t value_to_angle(const ring_arc_t *ring, int32_t value)
+{
+    if (ring->max <= ring->min) {
+        return 0;
+    }
+    return lv_map(value, ring->min, ring->max, 0, 360);
+}
+
+static void draw_event_cb(lv_event_t *e)
+{
+    lv_obj_t *obj = lv_event_get_target(e);
+    ring_arc_t *ring = lv_event_get_user_data(e);
+    lv_layer_t *layer = lv_event_get_layer(e);
+
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+
+    lv_area_t ring_area = {
+        .x1 = coords.x1,
+        .y1 = coords.y1,
+        .x2 = coords.x1 + ring->diameter - 1,
+        .y2 = coords.y1 + ring->diameter - 1,
+    };
+    lv_draw_image_dsc_t track;
+    lv_draw_image_dsc_init(&track);
+    track.src = &ring->mask;
+    track.recolor = lv_obj_get_style_arc_color(obj, LV_PART_MAIN);
+    track.recolor_opa = LV_OPA_COVER;
+    track.opa = lv_obj_get_style_arc_opa(obj, LV_PART_MAIN);
+    lv_draw_image(layer, &track, &ring_area);
+
+    int32_t span = value_to_angle(ring, ring->value);
+    if (span <= 0) {
+        return;
+    }
+    lv_draw_arc_dsc_t indic;
+    lv_draw_arc_dsc_init(&indic);
+    indic.color = lv_obj_get_style_arc_color(obj, LV_PART_INDICATOR);
+    indic.opa = lv_obj_get_style_arc_opa(obj, LV_PART_INDICATOR);
+    indic.width = ring->width;
+    indic.rounded = span < 360;
+    indic.center.x = coords.x1 + ring->diameter / 2;
+    indic.center.y = coords.y1 + ring->diameter / 2;
+    indic.radius = ring->diameter / 2;
+    indic.start_angle = RING_ARC_ROTATION;
+    indic.end_angle = (RING_ARC_ROTATION + span) % 360;
+    if (span >= 360) {
+        indic.start_angle = 0;
+        indic.end_angle = 360;
+    }
+    lv_draw_arc(layer, &indic);
+}
+
+static void delete_event_cb(lv_event_t *e)
+{
+    ring_arc_t *ring = lv_event_get_user_data(e);
+    heap_caps_free(ring->mask_data);
+    lv_free(ring);
+}
+
+lv_obj_t *ring_arc_create(lv_obj_t *parent, int32_t diameter, int32_t width)
+{
+    ring_arc_t *ring = lv_malloc_zeroed(sizeof(ring_arc_t));
+    if (!ring) {
+        return NULL;
+    }
+    uint32_t stride = lv_draw_buf_width_to_stride(diameter, LV_COLOR_FORMAT_A8);
+    uint32_t size = stride * diameter;
+    /* The mask is read only in small clipped spans, PSRAM is fast enough for it */
+    ring->mask_data = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!ring->mask_data) {
+        ring->mask_data = heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    }
+    if (!ring->mask_data) {
+        lv_free(ring);
+        return NULL;
+    }
+    lv_draw_buf_init(&ring->mask, diameter, diameter, LV_COLOR_FORMAT_A8, stride, ring->mask_data, size);
+    ring->diameter = diameter;
+    ring->width = width;
+    ring->min = 0;
+    ring->max = 100;
+    render_mask(ring);
+
+    lv_obj_t *obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(obj);
+    lv_obj_set_size(obj, diameter, diameter);
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_arc_color(obj, lv_palette_lighten(LV_PALETTE_GREY, 2), LV_PART_MAIN);
+    lv_obj_set_style_arc_color(obj, lv_palette_main(LV_PALETTE_BLUE), LV_PART_INDICATOR);
+    lv_obj_add_event_cb(obj, draw_event_cb, LV_EVENT_DRAW_MAIN, ring);
+    lv_obj_add_event_cb(obj, delete_event_cb, LV_EVENT_DELETE, ring);
+    lv_obj_set_user_data(obj, ring);
+    return obj;
+}
+
+void ring_arc_set_range(lv_obj_t *obj, int32_t min, int32_t max)
+{
+    ring_arc_t *ring = lv_obj_get_user_data(obj);
+    ring->min = min;
+    ring->max = max;
+    ring->value = LV_CLAMP(min, ring->value, max);
+    lv_obj_invalidate(obj);
+}
+
+void ring_arc_set_value(lv_obj_t *obj, int32_t value)
+{
+    ring_arc_t *ring = lv_obj_get_user_data(obj);
+    value = LV_CLAMP(ring->min, value, ring->max);
+    if (value == ring->value) {
+        return;
+    }
+    int32_t old_span = value_to_angle(ring, ring->value);
+    int32_t new_span = value_to_angle(ring, value);
+    ring->value = value;
+    if (old_span == new_span) {
+        return;
+    }
+
+    /* Only the swept span changes: the track under it and the moving end cap */
+    int32_t from = LV_MIN(old_span, new_span);
+    int32_t to = LV_MAX(old_span, new_span);
+    if (from == 0 || to >= 360) {
+        /* The start cap appears or disappears as well */
+        lv_obj_invalidate(obj);
+        return;
+    }
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+    lv_area_t area;
+    lv_draw_arc_get_area(coords.x1 + ring->diameter / 2, coords.y1 + ring->diameter / 2, ring->diameter / 2,
+                         (RING_ARC_ROTATION + from) % 360, (RING_ARC_ROTATION + to) % 360,
+                         ring->width, true, &area);
+    lv_obj_invalidate_area(obj, &area);
+}
+
+int32_t ring_arc_get_value(lv_obj_t *obj)
+{
+    ring_arc_t *ring = lv_obj_get_user_data(obj);
+    return ring->value;
+}
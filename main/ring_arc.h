@@ -0,0 +1,32 @@
+/**
+ * @file ring_arc.h
+ * @brief Progress ring with a pre-rendered background
+ * @details Drop-in replacement for the full-circle lv_arc on the main screen.
+ *          The static 360° track is rasterised once into an A8 coverage mask
+ *          and blitted with the track colour; only the indicator is drawn
+ *          live, and a value change invalidates just the angular span that
+ *          moved.
+ *
+ *          The track width is fixed at creation, since it is baked into the
+ *          mask, and the indicator uses the same width. Colours come from the
+ *          usual arc style properties: arc_color/arc_opa on LV_PART_MAIN
+ *          (track) and LV_PART_INDICATOR; arc_width is ignored.
+ */
+
+#pragma once
+
+#include "lvgl.h"
+
+/**
+ * @brief Create a ring of the given outer diameter and track width
+ *
+ * The ring starts at 12 o'clock and grows clockwise, range defaults to 0..100.
+ * Returns NULL if the mask buffer cannot be allocated.
+ */
+lv_obj_t *ring_arc_create(lv_obj_t *parent, int32_t diameter, int32_t width);
+
+void ring_arc_set_range(lv_obj_t *obj, int32_t min, int32_t max);
+
+void ring_arc_set_value(lv_obj_t *obj, int32_t value);
+
+int32_t ring_arc_get_value(lv_obj_t *obj);
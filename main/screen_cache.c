@@ -0,0 +1,241 @@
+/**
+ * @file screen_cache.c
+ * @brief Rendered screens kept in PSRAM for instant switching
+ */
+
+#include <string.h>
+
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_lvgl_port.h"
+
+#include "disp_flush.h"
+#include "latency_trace.h"
+#include "screen_cache.h"
+
+static const char *TAG = "screen_cache";
+
+typedef struct {
+    lv_obj_t *screen;
+    uint8_t *pixels;            /*!< h_res x v_res, panel byte order */
+    bool valid;                 /*!< Complete and matching the widgets */
+    uint32_t used;              /*!< Last load, for eviction */
+} slot_t;
+
+/* Everything here is touched with the LVGL port lock held */
+static struct {
+    lv_display_t *disp;
+    int32_t h_res;
+    int32_t v_res;
+    bool slide;
+    slot_t slots[SCREEN_CACHE_SLOTS];
+    uint32_t loads;
+    /* Snapshot of the active screen, kept up to date by every flush */
+    slot_t *active;
+    /* Active screen loaded without a snapshot, not rendered in full yet */
+    bool filling;
+    /* Goes to the panel at the start of the next refresh */
+    slot_t *show;
+    slot_t *show_from;
+    screen_cache_transition_t transition;
+    /* Slide steps already on the panel, one per refresh */
+    int slide_step;
+    screen_cache_stats_t stats;
+} s_sc;
+
+static slot_t *find_slot(lv_obj_t *screen)
+{
+    for (int i = 0; i < SCREEN_CACHE_SLOTS; i++) {
+        if (s_sc.slots[i].screen == screen) {
+            return &s_sc.slots[i];
+        }
+    }
+    return NULL;
+}
+
+static slot_t *least_recent_slot(void)
+{
+    slot_t *lru = &s_sc.slots[0];
+    for (int i = 1; i < SCREEN_CACHE_SLOTS; i++) {
+        if (s_sc.slots[i].used < lru->used) {
+            lru = &s_sc.slots[i];
+        }
+    }
+    return lru;
+}
+
+/* LVGL task, inside flush_cb */
+static void capture(const lv_area_t *area, const uint8_t *px_map, void *arg)
+{
+    slot_t *slot = s_sc.active;
+    if (!slot) {
+        return;
+    }
+    const int32_t row_bytes = lv_area_get_width(area) * 2;
+    uint8_t *dst = slot->pixels + (area->y1 * s_sc.h_res + area->x1) * 2;
+    for (int32_t y = area->y1; y <= area->y2; y++) {
+        memcpy(dst, px_map, row_bytes);
+        dst += s_sc.h_res * 2;
+        px_map += row_bytes;
+    }
+}
+
+/* Eased out, so the slide starts fast and settles on the new screen */
+static int32_t slide_shift(int step)
+{
+    int32_t left = SCREEN_CACHE_SLIDE_STEPS - step;
+    return s_sc.h_res - s_sc.h_res * left * left * left / (SCREEN_CACHE_SLIDE_STEPS * SCREEN_CACHE_SLIDE_STEPS *
+                                                          SCREEN_CACHE_SLIDE_STEPS);
+}
+
+static void hold_panel(bool hold)
+{
+    disp_flush_set_hold(hold);
+    latency_trace_set_held(hold);
+}
+
+static void end_slide(void)
+{
+    s_sc.show = NULL;
+    s_sc.show_from = NULL;
+    s_sc.slide_step = 0;
+    hold_panel(false);
+}
+
+/* One blit per refresh, so input and timers keep running during a slide */
+static void present(void)
+{
+    slot_t *to = s_sc.show;
+    slot_t *from = s_sc.show_from;
+
+    if (!from) {
+        end_slide();
+        disp_flush_blit(to->pixels, NULL, 0);
+        return;
+    }
+    int32_t shift = slide_shift(++s_sc.slide_step);
+    if (s_sc.transition == SCREEN_CACHE_SLIDE_LEFT) {
+        disp_flush_blit(from->pixels, to->pixels, shift);
+    } else {
+        disp_flush_blit(to->pixels, from->pixels, s_sc.h_res - shift);
+    }
+    if (s_sc.slide_step < SCREEN_CACHE_SLIDE_STEPS) {
+        /* What LVGL renders meanwhile lands in the snapshot of the new
+         * screen, which the last step shows; keep it off the panel until then */
+        hold_panel(true);
+        lv_timer_resume(lv_display_get_refr_timer(s_sc.disp));
+        return;
+    }
+    end_slide();
+    s_sc.stats.slides++;
+}
+
+/* LVGL task */
+static void disp_event_cb(lv_event_t *e)
+{
+    switch (lv_event_get_code(e)) {
+    case LV_EVENT_REFR_START:
+        if (s_sc.show) {
+            present();
+        }
+        break;
+    case LV_EVENT_REFR_READY:
+        /* The load invalidated the whole screen, and this refresh drew it */
+        if (s_sc.filling) {
+            s_sc.active->valid = true;
+            s_sc.filling = false;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void screen_cache_load(lv_obj_t *screen, screen_cache_transition_t transition)
+{
+    if (!s_sc.disp) {
+        lv_screen_load(screen);
+        return;
+    }
+    if (screen == lv_screen_active()) {
+        return;
+    }
+
+    /* Complete, so it holds what the panel shows right now */
+    slot_t *from = s_sc.active && !s_sc.filling ? s_sc.active : NULL;
+    slot_t *to = find_slot(screen);
+    if (to && to->valid) {
+        lv_display_enable_invalidation(s_sc.disp, false);
+        lv_screen_load(screen);
+        lv_display_enable_invalidation(s_sc.disp, true);
+        /* A slide still running starts over from the complete outgoing frame */
+        end_slide();
+        s_sc.show = to;
+        s_sc.show_from = s_sc.slide && transition != SCREEN_CACHE_CUT ? from : NULL;
+        s_sc.transition = transition;
+        s_sc.filling = false;
+        s_sc.stats.hits++;
+        /* Nothing was invalidated, which is what normally wakes the refresh */
+        lv_timer_resume(lv_display_get_refr_timer(s_sc.disp));
+    } else {
+        lv_screen_load(screen);
+        if (!to) {
+            to = least_recent_slot();
+            to->screen = screen;
+        }
+        to->valid = false;
+        end_slide();
+        s_sc.filling = true;
+        s_sc.stats.misses++;
+    }
+    to->used = ++s_sc.loads;
+    s_sc.active = to;
+}
+
+void screen_cache_changed(lv_obj_t *screen)
+{
+    if (!s_sc.disp || screen == lv_screen_active()) {
+        return;
+    }
+    slot_t *slot = find_slot(screen);
+    if (slot && slot->valid) {
+        slot->valid = false;
+        s_sc.stats.dropped++;
+    }
+}
+
+esp_err_t screen_cache_init(const screen_cache_config_t *config)
+{
+    ESP_RETURN_ON_FALSE(config && config->disp && config->h_res > 0 && config->v_res > 0, ESP_ERR_INVALID_ARG, TAG,
+                        "Invalid argument");
+    ESP_RETURN_ON_FALSE(!s_sc.disp, ESP_ERR_INVALID_STATE, TAG, "Already initialized");
+
+    const size_t size = config->h_res * config->v_res * 2;
+    for (int i = 0; i < SCREEN_CACHE_SLOTS; i++) {
+        if (!s_sc.slots[i].pixels) {
+            /* Zeroed, so the corners never sent anywhere stay black */
+            s_sc.slots[i].pixels = heap_caps_calloc(1, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+            ESP_RETURN_ON_FALSE(s_sc.slots[i].pixels, ESP_ERR_NO_MEM, TAG, "No PSRAM for snapshot %d", i);
+        }
+    }
+    s_sc.h_res = config->h_res;
+    s_sc.v_res = config->v_res;
+    s_sc.slide = config->slide;
+
+    lvgl_port_lock(0);
+    lv_display_add_event_cb(config->disp, disp_event_cb, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(config->disp, disp_event_cb, LV_EVENT_REFR_READY, NULL);
+    disp_flush_set_capture(capture, NULL);
+    s_sc.disp = config->disp;
+    lvgl_port_unlock();
+    ESP_LOGI(TAG, "%d snapshots of %u KB in PSRAM", SCREEN_CACHE_SLOTS, (unsigned)(size / 1024));
+    return ESP_OK;
+}
+
+void screen_cache_get_stats(screen_cache_stats_t *stats)
+{
+    lvgl_port_lock(0);
+    *stats = s_sc.stats;
+    lvgl_port_unlock();
+}
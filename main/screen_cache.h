@@ -0,0 +1,80 @@
+/**
+ * @file screen_cache.h
+ * @brief Rendered screens kept in PSRAM for instant switching
+ * @details Loading a screen normally invalidates all of it: every widget is
+ *          rendered again and the whole 472x466 frame, about 440 KB, goes
+ *          over QSPI strip by strip. Instead, every flushed area is also
+ *          copied into a full-frame snapshot of the active screen in PSRAM.
+ *          Loading a screen whose snapshot is complete and still matches
+ *          its widgets skips the invalidation: at the start of the next
+ *          refresh the snapshot goes straight to the panel, and LVGL only
+ *          renders what was invalidated after the load.
+ *
+ *          A slide between two screens composes the outgoing frame and the
+ *          incoming snapshot band by band, one step per refresh for
+ *          SCREEN_CACHE_SLIDE_STEPS refreshes, without rendering the
+ *          widgets. Input keeps being handled in between. Whatever LVGL
+ *          renders meanwhile only goes into the new snapshot, and the last
+ *          step shows it.
+ *
+ *          LVGL ignores changes to the widgets of a screen that is not
+ *          shown, so the UI reports them with screen_cache_changed(); the
+ *          snapshot is dropped and the next load renders the screen in full.
+ *          The SCREEN_CACHE_SLOTS most recently shown screens are kept.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "lvgl.h"
+
+#define SCREEN_CACHE_SLOTS 4
+#define SCREEN_CACHE_SLIDE_STEPS 8
+
+typedef enum {
+    SCREEN_CACHE_CUT = 0,       /*!< Replace the screen at once */
+    SCREEN_CACHE_SLIDE_LEFT,    /*!< The new screen comes in from the right */
+    SCREEN_CACHE_SLIDE_RIGHT,   /*!< The new screen comes in from the left */
+} screen_cache_transition_t;
+
+typedef struct {
+    lv_display_t *disp;
+    int32_t h_res;
+    int32_t v_res;
+    bool slide;                 /*!< Slide where asked to, otherwise always cut */
+} screen_cache_config_t;
+
+typedef struct {
+    uint32_t hits;              /*!< Loads shown from a snapshot */
+    uint32_t misses;            /*!< Loads rendered from the widgets */
+    uint32_t slides;
+    uint32_t dropped;           /*!< Snapshots dropped because their hidden screen changed */
+} screen_cache_stats_t;
+
+/**
+ * @brief Allocate the snapshots and start capturing
+ *
+ * @note Takes the LVGL port lock itself. Call after disp_flush_install().
+ */
+esp_err_t screen_cache_init(const screen_cache_config_t *config);
+
+/**
+ * @brief Load a screen, from its snapshot when there is a good one
+ *
+ * Same as lv_screen_load() before screen_cache_init().
+ *
+ * @note Call with the LVGL port lock held.
+ */
+void screen_cache_load(lv_obj_t *screen, screen_cache_transition_t transition);
+
+/**
+ * @brief Report a change to the widgets of a screen; no-op for the active one
+ *
+ * @note Call with the LVGL port lock held.
+ */
+void screen_cache_changed(lv_obj_t *screen);
+
+void screen_cache_get_stats(screen_cache_stats_t *stats);
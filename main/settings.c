@@ -0,0 +1,49 @@
+/**
+ * @file settings.c
+ * @brief User settings kept in NVS
+ */
+
+#include "nvs.h"
+
+#include "frame_watch.h"
+#include "settings.h"
+
+#define SETTINGS_NAMESPACE "settings"
+
+void settings_save_owner(const char *owner)
+{
+    nvs_handle_t handle;
+    if (nvs_open(SETTINGS_NAMESPACE, NVS_READWRITE, &handle) == ESP_OK) {
+        int64_t t = frame_watch_phase_begin();
+        nvs_set_str(handle, "owner", owner);
+        nvs_commit(handle);
+        frame_watch_phase_end(FRAME_PHASE_NVS, t);
+        nvs_close(handle);
+    }
+}
+
+void settings_save_language(uint8_t lang)
+{
+    nvs_handle_t handle;
+    if (nvs_open(SETTINGS_NAMESPACE, NVS_READWRITE, &handle) == ESP_OK) {
+        int64_t t = frame_watch_phase_begin();
+        nvs_set_u8(handle, "lang", lang);
+        nvs_commit(handle);
+        frame_watch_phase_end(FRAME_PHASE_NVS, t);
+        nvs_close(handle);
+    }
+}
+
+void settings_load(uint8_t *lang, uint8_t lang_count, char *owner, size_t owner_size)
+{
+    nvs_handle_t handle;
+    if (nvs_open(SETTINGS_NAMESPACE, NVS_READONLY, &handle) == ESP_OK) {
+        uint8_t value = 0;
+        if (nvs_get_u8(handle, "lang", &value) == ESP_OK && value < lang_count) {
+            *lang = value;
+        }
+        size_t len = owner_size;
+        nvs_get_str(handle, "owner", owner, &len);
+        nvs_close(handle);
+    }
+}
@@ -0,0 +1,21 @@
+/**
+ * @file settings.h
+ * @brief User settings kept in NVS
+ * @details Namespace "settings": UI language index ("lang") and owner name
+ *          ("owner"). Missing or unreadable values leave the defaults alone.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @param[in,out] lang  Left untouched if not stored or not below lang_count
+ * @param[out]    owner Left untouched if not stored
+ */
+void settings_load(uint8_t *lang, uint8_t lang_count, char *owner, size_t owner_size);
+
+void settings_save_language(uint8_t lang);
+
+void settings_save_owner(const char *owner);
@@ -0,0 +1,58 @@
+/**
+ * @file spring_anim.c
+ * @brief Fixed-point spring and damper for animating a value towards a target
+ */
+
+#include <stdlib.h>
+
+#include "spring_anim.h"
+
+#define Q16(x) ((int32_t)(x) * 65536)
+/* Close enough to stop: 1/64 of a unit away and slower than 1/4 unit/s */
+#define SPRING_ANIM_POS_EPS (65536 / 64)
+#define SPRING_ANIM_VEL_EPS (65536 / 4)
+
+void spring_anim_init(spring_anim_t *spring, int32_t value, int32_t stiffness, int32_t damping)
+{
+    spring->pos = Q16(value);
+    spring->vel = 0;
+    spring->target = spring->pos;
+    spring->stiffness = stiffness;
+    spring->damping = damping;
+}
+
+void spring_anim_set_target(spring_anim_t *spring, int32_t value)
+{
+    spring->target = Q16(value);
+}
+
+bool spring_anim_settled(const spring_anim_t *spring)
+{
+    return spring->pos == spring->target && spring->vel == 0;
+}
+
+bool spring_anim_step(spring_anim_t *spring, uint32_t dt_ms)
+{
+    if (spring_anim_settled(spring)) {
+        return false;
+    }
+    while (dt_ms) {
+        int32_t dt = dt_ms < SPRING_ANIM_MAX_DT_MS ? dt_ms : SPRING_ANIM_MAX_DT_MS;
+        dt_ms -= dt;
+        int64_t accel = (int64_t)spring->stiffness * (spring->target - spring->pos)
+                        - (int64_t)spring->damping * spring->vel;
+        spring->vel += (int32_t)(accel * dt / 1000);
+        spring->pos += (int32_t)((int64_t)spring->vel * dt / 1000);
+    }
+    if (abs(spring->target - spring->pos) < SPRING_ANIM_POS_EPS && abs(spring->vel) < SPRING_ANIM_VEL_EPS) {
+        spring->pos = spring->target;
+        spring->vel = 0;
+        return false;
+    }
+    return true;
+}
+
+int32_t spring_anim_value(const spring_anim_t *spring)
+{
+    return (spring->pos + 32768) >> 16;
+}
@@ -0,0 +1,52 @@
+/**
+ * @file spring_anim.h
+ * @brief Fixed-point spring and damper for animating a value towards a target
+ * @details Input only moves the target; the owner advances the spring once per
+ *          rendered frame with the time elapsed since the previous step, and
+ *          stops stepping once spring_anim_step() reports it has settled.
+ *          Position and velocity are Q16.16, integration is semi-implicit
+ *          Euler in sub-steps of at most SPRING_ANIM_MAX_DT_MS, so a late
+ *          frame cannot make the spring overshoot wildly.
+ *
+ *          Pure logic with the time passed in: no timers, no RTOS.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SPRING_ANIM_MAX_DT_MS 16
+
+typedef struct {
+    int32_t pos;            /*!< Q16.16 */
+    int32_t vel;            /*!< Q16.16 per second */
+    int32_t target;         /*!< Q16.16 */
+    int32_t stiffness;      /*!< Per second squared */
+    int32_t damping;        /*!< Per second */
+} spring_anim_t;
+
+/**
+ * @param stiffness Square of the angular frequency; at 250 a step is
+ *                  visually complete in about 0.4 s
+ * @param damping   2 * sqrt(stiffness) for a critically damped spring, less
+ *                  to let it overshoot a little
+ */
+void spring_anim_init(spring_anim_t *spring, int32_t value, int32_t stiffness, int32_t damping);
+
+void spring_anim_set_target(spring_anim_t *spring, int32_t value);
+
+/**
+ * @brief Advance by dt_ms
+ *
+ * @return false once the value has settled on the target; it then stays put
+ *         until the next spring_anim_set_target()
+ */
+bool spring_anim_step(spring_anim_t *spring, uint32_t dt_ms);
+
+/**
+ * @brief Current value, rounded to an integer
+ */
+int32_t spring_anim_value(const spring_anim_t *spring);
+
+bool spring_anim_settled(const spring_anim_t *spring);
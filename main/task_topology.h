@@ -0,0 +1,71 @@
+/**
+ * @file task_topology.h
+ * @brief Core, priority and stack of every task in one place
+ * @details Core 1 renders: the LVGL task runs timers, rendering and
+ *          flush_cb, and nothing else is pinned there. With LV_OS_FREERTOS
+ *          and two draw units (the sdkconfig.defaults.draw_units overlay,
+ *          not the default), LVGL creates its draw threads itself,
+ *          unpinned at priority 3 (LV_THREAD_PRIO_HIGH). The second one
+ *          picks up core 0 whenever input and I/O leave it idle.
+ *
+ *          Core 0 does input and I/O:
+ *          - the esp_timer task, which runs the knob and button drivers and
+ *            with them ui_knob_move() and the fan (sdkconfig pins it with
+ *            ESP_TIMER_TASK_AFFINITY_CPU0)
+ *          - the touch task, which does the CST820 I2C reads
+ *          - display idle handling, the console, the control link, fan
+ *            calibration and the performance journal writer
+ *          - the GPIO, I2C and panel IO interrupts, allocated from app_main
+ *
+ *          Input must preempt housekeeping on core 0, and rendering owns
+ *          core 1, so the priorities below only order tasks sharing a core.
+ *          The console "tasks" and "jitter" commands check the layout.
+ */
+
+#pragma once
+
+#include "sdkconfig.h"
+
+#define TASK_CORE_IO 0
+#define TASK_CORE_RENDER 1
+
+/* Core 1 */
+#define TASK_LVGL_CORE TASK_CORE_RENDER
+#define TASK_LVGL_PRIORITY 4
+#define TASK_LVGL_STACK 7096
+
+/* Core 0; the esp_timer task sits above all of these at priority 22 */
+#define TASK_TOUCH_CORE TASK_CORE_IO
+#define TASK_TOUCH_PRIORITY 6
+#define TASK_TOUCH_STACK 3072
+
+#define TASK_DISP_IDLE_CORE TASK_CORE_IO
+#define TASK_DISP_IDLE_PRIORITY 5
+#define TASK_DISP_IDLE_STACK 3072
+
+#define TASK_CONSOLE_CORE TASK_CORE_IO
+#define TASK_CONSOLE_PRIORITY 2
+#define TASK_CONSOLE_STACK 4096
+
+#define TASK_PERF_STREAM_CORE TASK_CORE_IO
+#define TASK_PERF_STREAM_PRIORITY 2
+#define TASK_PERF_STREAM_STACK 3072
+
+/* Above the console, which reads the link requests, so telemetry keeps flowing */
+#define TASK_CTL_LINK_TX_CORE TASK_CORE_IO
+#define TASK_CTL_LINK_TX_PRIORITY 3
+#define TASK_CTL_LINK_TX_STACK 2048
+
+/* Below everything else: flushing the journal can wait */
+#define TASK_JOURNAL_CORE TASK_CORE_IO
+#define TASK_JOURNAL_PRIORITY 1
+#define TASK_JOURNAL_STACK 2560
+
+/* One-off, only while a fan calibration runs */
+#define TASK_FAN_CAL_CORE TASK_CORE_IO
+#define TASK_FAN_CAL_PRIORITY 1
+#define TASK_FAN_CAL_STACK 3072
+
+#if !CONFIG_ESP_TIMER_TASK_AFFINITY_CPU0 || !CONFIG_ESP_MAIN_TASK_AFFINITY_CPU0
+#error "Knob, button and start-up work are expected on core 0, see task_topology.h"
+#endif
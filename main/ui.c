@@ -0,0 +1,827 @@
+/**
+ * @file ui.c
+ * @brief Knob UI: screens, navigation and input handling
+ * @details Hardware independent apart from esp_timer and the esp_lvgl_port
+ *          lock, so the same file builds for the device and for the host
+ *          simulator in sim/.
+ */
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "lvgl.h"
+#include "esp_lvgl_port.h"
+
+#include "ui.h"
+#include "ui_fonts.h"
+#include "ring_arc.h"
+#include "digit_display.h"
+#include "item_picker.h"
+#include "fan.h"
+#include "settings.h"
+#include "latency_trace.h"
+#include "click_recognizer.h"
+#include "spring_anim.h"
+#include "zone_strip.h"
+#include "frame_watch.h"
+#include "screen_cache.h"
+
+#define FAN_SPEED_DEFAULT_PERCENT 65
+#define OWNER_NAME_MAX_LEN 16
+#define OWNER_KEY_COUNT 65
+#define OWNER_KEY_SPACE (OWNER_KEY_COUNT - 3)
+#define OWNER_KEY_BACKSPACE (OWNER_KEY_COUNT - 2)
+#define OWNER_KEY_SAVE (OWNER_KEY_COUNT - 1)
+/* Arc resolution per percent, so the spring moves it in fractions of a step */
+#define ARC_SCALE 10
+#define ARC_SPRING_STIFFNESS 250
+#define ARC_SPRING_DAMPING 30
+/* Longest pause between the clicks of a triple click */
+#define CLICK_GAP_US (500 * 1000)
+
+typedef enum {
+    UI_SCREEN_BOOT = 0,
+    UI_SCREEN_MAIN,
+    UI_SCREEN_SETTINGS,
+    UI_SCREEN_LANGUAGE,
+    UI_SCREEN_OWNER,
+} ui_screen_t;
+
+typedef enum {
+    LANG_EN = 0,
+    LANG_RU,
+    LANG_ET,
+    LANG_DE,
+    LANG_FI,
+    LANG_LV,
+    LANG_LT,
+    LANG_ES,
+    LANG_COUNT,
+} ui_lang_t;
+
+static ui_screen_t ui_screen = UI_SCREEN_BOOT;
+static ui_lang_t current_lang = LANG_EN;
+static bool ui_locked = false;
+/* The knob sets the selected zone; the ring and readout show it */
+static int zone_percent[FAN_ZONE_MAX];
+static int zone_count = 1;
+static int zone_selected = 0;
+static int settings_index = 0;
+static size_t owner_name_len = 0;
+static char owner_name[OWNER_NAME_MAX_LEN + 1] = "";
+static click_recognizer_t click_rec;
+/* The arc follows the selected zone through a spring stepped once per frame */
+static spring_anim_t arc_spring;
+static lv_timer_t *arc_timer = NULL;
+static uint32_t arc_last_tick = 0;
+
+static lv_obj_t *boot_screen = NULL;
+static lv_obj_t *main_screen = NULL;
+static lv_obj_t *settings_screen = NULL;
+static lv_obj_t *language_screen = NULL;
+static lv_obj_t *owner_screen = NULL;
+static lv_obj_t *label_speed = NULL;
+static lv_obj_t *label_speed_caption = NULL;
+static lv_obj_t *arc_speed = NULL;
+static lv_obj_t *zone_strip = NULL;
+static lv_obj_t *lock_overlay = NULL;
+static lv_obj_t *settings_items[2] = {0};
+static lv_obj_t *label_settings_title = NULL;
+static lv_obj_t *label_language_title = NULL;
+static lv_obj_t *label_owner_title = NULL;
+static lv_obj_t *picker_language = NULL;
+static lv_obj_t *label_owner_value = NULL;
+static lv_obj_t *picker_owner = NULL;
+
+/* ui-glyphs:begin text */
+static const char *language_names[LANG_COUNT] = {
+    "English",
+    "Русский",
+    "Eesti",
+    "Deutsch",
+    "Suomi",
+    "Latviešu",
+    "Lietuviu",
+    "Español",
+};
+
+/* Owner name keys: characters first, then the three commands */
+static const char *const owner_keys[] = {
+    "A", "B", "C", "D", "E", "F", "G", "H", "I", "J", "K", "L", "M",
+    "N", "O", "P", "Q", "R", "S", "T", "U", "V", "W", "X", "Y", "Z",
+    "a", "b", "c", "d", "e", "f", "g", "h", "i", "j", "k", "l", "m",
+    "n", "o", "p", "q", "r", "s", "t", "u", "v", "w", "x", "y", "z",
+    "0", "1", "2", "3", "4", "5", "6", "7", "8", "9",
+    "space", "<-", "Save",
+};
+static_assert(sizeof(owner_keys) / sizeof(owner_keys[0]) == OWNER_KEY_COUNT, "owner key table");
+
+typedef struct {
+    const char *fan_speed;
+    const char *settings;
+    const char *language;
+    const char *owner_name;
+    const char *locked;
+    const char *unlocked;
+} ui_strings_t;
+
+static const ui_strings_t ui_strings[LANG_COUNT] = {
+    [LANG_EN] = {
+        .fan_speed = "Fan speed",
+        .settings = "Settings",
+        .language = "Language",
+        .owner_name = "Owner name",
+        .locked = "Locked",
+        .unlocked = "Unlocked",
+    },
+    [LANG_RU] = {
+        .fan_speed = "Скорость",
+        .settings = "Настройки",
+        .language = "Язык",
+        .owner_name = "Имя владельца",
+        .locked = "Заблокировано",
+        .unlocked = "Разблокировано",
+    },
+    [LANG_ET] = {
+        .fan_speed = "Ventilaator",
+        .settings = "Seaded",
+        .language = "Keel",
+        .owner_name = "Omaniku nimi",
+        .locked = "Lukus",
+        .unlocked = "Avatud",
+    },
+    [LANG_DE] = {
+        .fan_speed = "Luefter",
+        .settings = "Einstellungen",
+        .language = "Sprache",
+        .owner_name = "Besitzername",
+        .locked = "Gesperrt",
+        .unlocked = "Entsperrt",
+    },
+    [LANG_FI] = {
+        .fan_speed = "Tuuletin",
+        .settings = "Asetukset",
+        .language = "Kieli",
+        .owner_name = "Omistaja",
+        .locked = "Lukittu",
+        .unlocked = "Avattu",
+    },
+    [LANG_LV] = {
+        .fan_speed = "Ventilators",
+        .settings = "Iestatījumi",
+        .language = "Valoda",
+        .owner_name = "Īpašnieks",
+        .locked = "Bloķēts",
+        .unlocked = "Atbloķēts",
+    },
+    [LANG_LT] = {
+        .fan_speed = "Ventiliatorius",
+        .settings = "Nustatymai",
+        .language = "Kalba",
+        .owner_name = "Savininko vardas",
+        .locked = "Užrakinta",
+        .unlocked = "Atrakinta",
+    },
+    [LANG_ES] = {
+        .fan_speed = "Ventilador",
+        .settings = "Ajustes",
+        .language = "Idioma",
+        .owner_name = "Propietario",
+        .locked = "Bloqueado",
+        .unlocked = "Desbloqueado",
+    },
+};
+/* ui-glyphs:end */
+
+static esp_timer_handle_t boot_timer = NULL;
+/* Changes from outside the knob, applied on the esp_timer task like the knob
+ * itself, so zone_percent and the lock have one writer; -1 for none */
+static esp_timer_handle_t remote_timer = NULL;
+static atomic_int remote_percent[FAN_ZONE_MAX];
+static atomic_int remote_locked = -1;
+
+/* Only a real change costs a redraw, or the snapshot of a hidden screen */
+static void set_label_text(lv_obj_t *label, const char *text)
+{
+    if (strcmp(lv_label_get_text(label), text) == 0) {
+        return;
+    }
+    lv_label_set_text(label, text);
+    screen_cache_changed(lv_obj_get_screen(label));
+}
+
+static void arc_timer_cb(lv_timer_t *timer)
+{
+    uint32_t now = lv_tick_get();
+    bool moving = spring_anim_step(&arc_spring, now - arc_last_tick);
+    arc_last_tick = now;
+    ring_arc_set_value(arc_speed, spring_anim_value(&arc_spring));
+    screen_cache_changed(main_screen);
+    if (!moving) {
+        lv_timer_pause(timer);
+    }
+}
+
+static void update_main_ui(void)
+{
+    if (!label_speed || !arc_speed) {
+        return;
+    }
+    screen_cache_changed(main_screen);
+    int percent = zone_percent[zone_selected];
+    digit_display_set_value(label_speed, percent);
+    if (zone_strip) {
+        zone_strip_set_value(zone_strip, zone_selected, percent);
+        zone_strip_set_selected(zone_strip, zone_selected);
+    }
+    /* However many detents arrive, the arc is redrawn at most once a frame */
+    bool idle = spring_anim_settled(&arc_spring);
+    spring_anim_set_target(&arc_spring, percent * ARC_SCALE);
+    if (idle && !spring_anim_settled(&arc_spring)) {
+        arc_last_tick = lv_tick_get();
+        lv_timer_resume(arc_timer);
+    }
+    if (label_speed_caption) {
+        set_label_text(label_speed_caption, ui_strings[current_lang].fan_speed);
+    }
+}
+
+static void apply_language(void)
+{
+    if (label_speed_caption) {
+        set_label_text(label_speed_caption, ui_strings[current_lang].fan_speed);
+    }
+    if (label_settings_title) {
+        set_label_text(label_settings_title, ui_strings[current_lang].settings);
+    }
+    if (label_language_title) {
+        set_label_text(label_language_title, ui_strings[current_lang].language);
+    }
+    if (label_owner_title) {
+        set_label_text(label_owner_title, ui_strings[current_lang].owner_name);
+    }
+    if (settings_items[0]) {
+        set_label_text(settings_items[0], ui_strings[current_lang].language);
+    }
+    if (settings_items[1]) {
+        set_label_text(settings_items[1], ui_strings[current_lang].owner_name);
+    }
+}
+
+/* Only while the overlay is on screen: a hidden main_screen must not change
+ * behind its snapshot. Restarting redraws the overlay over the snapshot. */
+static void set_lock_blink(bool on)
+{
+    if (!on) {
+        lv_anim_delete(lock_overlay, NULL);
+        return;
+    }
+    if (lv_anim_get(lock_overlay, NULL)) {
+        return;
+    }
+    lv_anim_t anim;
+    lv_anim_init(&anim);
+    lv_anim_set_var(&anim, lock_overlay);
+    lv_anim_set_exec_cb(&anim, (lv_anim_exec_xcb_t)lv_obj_set_style_opa);
+    lv_anim_set_values(&anim, 80, 255);
+    lv_anim_set_time(&anim, 1200);
+    lv_anim_set_playback_time(&anim, 1200);
+    lv_anim_set_repeat_count(&anim, LV_ANIM_REPEAT_INFINITE);
+    lv_anim_start(&anim);
+}
+
+static void set_lock_overlay(bool enabled)
+{
+    if (!lock_overlay) {
+        return;
+    }
+    screen_cache_changed(main_screen);
+    if (enabled) {
+        lv_obj_clear_flag(lock_overlay, LV_OBJ_FLAG_HIDDEN);
+    } else {
+        lv_obj_add_flag(lock_overlay, LV_OBJ_FLAG_HIDDEN);
+    }
+    set_lock_blink(enabled && lv_screen_active() == main_screen);
+}
+
+static void update_settings_selection(void)
+{
+    screen_cache_changed(settings_screen);
+    for (int i = 0; i < 2; ++i) {
+        if (!settings_items[i]) {
+            continue;
+        }
+        if (i == settings_index) {
+            lv_obj_set_style_text_color(settings_items[i], lv_color_white(), 0);
+            lv_obj_set_style_bg_opa(settings_items[i], LV_OPA_40, 0);
+        } else {
+            lv_obj_set_style_text_color(settings_items[i], lv_color_gray(), 0);
+            lv_obj_set_style_bg_opa(settings_items[i], LV_OPA_TRANSP, 0);
+        }
+    }
+}
+
+/* Going deeper slides left, going back slides right */
+static int screen_depth(lv_obj_t *screen)
+{
+    if (screen == main_screen) {
+        return 1;
+    }
+    if (screen == settings_screen) {
+        return 2;
+    }
+    if (screen == language_screen || screen == owner_screen) {
+        return 3;
+    }
+    return 0;
+}
+
+static void show_screen(lv_obj_t *screen)
+{
+    if (screen) {
+        int from = screen_depth(lv_screen_active());
+        int to = screen_depth(screen);
+        screen_cache_transition_t transition = to > from ? SCREEN_CACHE_SLIDE_LEFT :
+                                               to < from ? SCREEN_CACHE_SLIDE_RIGHT : SCREEN_CACHE_CUT;
+        int64_t t = frame_watch_phase_begin();
+        screen_cache_load(screen, transition);
+        frame_watch_phase_end(FRAME_PHASE_SCREEN_LOAD, t);
+        if (lock_overlay) {
+            set_lock_blink(ui_locked && screen == main_screen);
+        }
+    }
+}
+
+static void boot_timer_cb(void *arg)
+{
+    lvgl_port_lock(0);
+    ui_screen = UI_SCREEN_MAIN;
+    show_screen(main_screen);
+    set_lock_overlay(ui_locked);
+    update_main_ui();
+    lvgl_port_unlock();
+}
+
+static void create_boot_screen(void)
+{
+    boot_screen = lv_obj_create(NULL);
+    lv_obj_clear_flag(boot_screen, LV_OBJ_FLAG_SCROLLABLE);
+
+    lv_obj_set_style_text_font(boot_screen, UI_FONT(ui_font_16), 0);
+
+    lv_obj_t *logo = lv_label_create(boot_screen);
+    /* ui-glyphs:begin logo */
+    lv_label_set_text(logo, "Belom");
+    /* ui-glyphs:end */
+    lv_obj_set_style_text_font(logo, UI_FONT(ui_font_28), 0);
+    lv_obj_center(logo);
+
+    if (owner_name_len > 0) {
+        lv_obj_t *owner = lv_label_create(boot_screen);
+        char owner_text[32];
+        /* ui-glyphs:begin text */
+        snprintf(owner_text, sizeof(owner_text), "Owner: %s", owner_name);
+        /* ui-glyphs:end */
+        lv_label_set_text(owner, owner_text);
+        lv_obj_set_style_text_font(owner, UI_FONT(ui_font_12), 0);
+        lv_obj_align(owner, LV_ALIGN_BOTTOM_MID, 0, -12);
+    }
+}
+
+/* A tap on a zone cell; runs in the LVGL task with the port lock held */
+static void zone_strip_event_cb(lv_event_t *e)
+{
+    if (ui_locked) {
+        zone_strip_set_selected(zone_strip, zone_selected);
+        return;
+    }
+    zone_selected = zone_strip_get_selected(zone_strip);
+    update_main_ui();
+}
+
+static void create_main_screen(void)
+{
+    main_screen = lv_obj_create(NULL);
+    lv_obj_clear_flag(main_screen, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_text_font(main_screen, UI_FONT(ui_font_16), 0);
+
+    arc_speed = ring_arc_create(main_screen, 200, 12);
+    assert(arc_speed);
+    lv_obj_center(arc_speed);
+    ring_arc_set_range(arc_speed, 0, 100 * ARC_SCALE);
+    ring_arc_set_value(arc_speed, zone_percent[zone_selected] * ARC_SCALE);
+    spring_anim_init(&arc_spring, zone_percent[zone_selected] * ARC_SCALE, ARC_SPRING_STIFFNESS, ARC_SPRING_DAMPING);
+    /* Paced with the display refresh, paused while the arc is at rest */
+    arc_timer = lv_timer_create(arc_timer_cb, LV_DEF_REFR_PERIOD, NULL);
+    lv_timer_pause(arc_timer);
+
+    label_speed = digit_display_create(main_screen, UI_FONT(ui_font_36));
+    assert(label_speed);
+    lv_obj_center(label_speed);
+
+    label_speed_caption = lv_label_create(main_screen);
+    lv_obj_set_style_text_font(label_speed_caption, UI_FONT(ui_font_14), 0);
+    lv_obj_align(label_speed_caption, LV_ALIGN_CENTER, 0, 56);
+
+    zone_count = fan_zone_count();
+    if (zone_count > 1) {
+        zone_strip = zone_strip_create(main_screen, UI_FONT(ui_font_14), zone_count);
+        assert(zone_strip);
+        /* Two rows sit lower to clear the ring */
+        lv_obj_align(zone_strip, LV_ALIGN_BOTTOM_MID, 0, zone_count > ZONE_STRIP_COLUMNS ? -36 : -48);
+        for (int i = 0; i < zone_count; i++) {
+            zone_strip_set_value(zone_strip, i, zone_percent[i]);
+        }
+        lv_obj_add_event_cb(zone_strip, zone_strip_event_cb, LV_EVENT_VALUE_CHANGED, NULL);
+    }
+
+    lock_overlay = lv_label_create(main_screen);
+    /* ui-glyphs:begin logo */
+    lv_label_set_text(lock_overlay, "🔒");
+    /* ui-glyphs:end */
+    lv_obj_set_style_text_font(lock_overlay, UI_FONT(ui_font_28), 0);
+    lv_obj_align(lock_overlay, LV_ALIGN_TOP_RIGHT, -16, 16);
+    lv_obj_add_flag(lock_overlay, LV_OBJ_FLAG_HIDDEN);
+}
+
+static void create_settings_screen(void)
+{
+    settings_screen = lv_obj_create(NULL);
+    lv_obj_clear_flag(settings_screen, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_text_font(settings_screen, UI_FONT(ui_font_16), 0);
+
+    label_settings_title = lv_label_create(settings_screen);
+    lv_obj_set_style_text_font(label_settings_title, UI_FONT(ui_font_20), 0);
+    lv_obj_align(label_settings_title, LV_ALIGN_TOP_MID, 0, 12);
+
+    lv_obj_t *list = lv_obj_create(settings_screen);
+    lv_obj_set_size(list, 200, 140);
+    lv_obj_align(list, LV_ALIGN_CENTER, 0, 16);
+    lv_obj_set_style_pad_all(list, 8, 0);
+    lv_obj_set_style_bg_opa(list, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(list, 0, 0);
+
+    settings_items[0] = lv_label_create(list);
+    settings_items[1] = lv_label_create(list);
+    lv_obj_set_width(settings_items[0], 180);
+    lv_obj_set_width(settings_items[1], 180);
+    lv_obj_align(settings_items[0], LV_ALIGN_TOP_LEFT, 0, 0);
+    lv_obj_align(settings_items[1], LV_ALIGN_TOP_LEFT, 0, 40);
+    lv_obj_set_style_pad_all(settings_items[0], 6, 0);
+    lv_obj_set_style_pad_all(settings_items[1], 6, 0);
+
+    apply_language();
+    update_settings_selection();
+}
+
+static void create_language_screen(void)
+{
+    language_screen = lv_obj_create(NULL);
+    lv_obj_clear_flag(language_screen, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_text_font(language_screen, UI_FONT(ui_font_16), 0);
+
+    label_language_title = lv_label_create(language_screen);
+    lv_obj_set_style_text_font(label_language_title, UI_FONT(ui_font_20), 0);
+    lv_label_set_text(label_language_title, ui_strings[current_lang].language);
+    lv_obj_align(label_language_title, LV_ALIGN_TOP_MID, 0, 12);
+
+    picker_language = item_picker_create(language_screen, UI_FONT(ui_font_16), language_names, LANG_COUNT, 1, 4);
+    lv_obj_align(picker_language, LV_ALIGN_CENTER, 0, 20);
+    item_picker_set_selected(picker_language, current_lang);
+}
+
+static void create_owner_screen(void)
+{
+    owner_screen = lv_obj_create(NULL);
+    lv_obj_clear_flag(owner_screen, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_text_font(owner_screen, UI_FONT(ui_font_16), 0);
+
+    label_owner_title = lv_label_create(owner_screen);
+    lv_obj_set_style_text_font(label_owner_title, UI_FONT(ui_font_20), 0);
+    lv_label_set_text(label_owner_title, ui_strings[current_lang].owner_name);
+    lv_obj_align(label_owner_title, LV_ALIGN_TOP_MID, 0, 12);
+
+    label_owner_value = lv_label_create(owner_screen);
+    lv_label_set_text(label_owner_value, owner_name_len ? owner_name : "-");
+    lv_obj_set_style_text_font(label_owner_value, UI_FONT(ui_font_16), 0);
+    lv_obj_align(label_owner_value, LV_ALIGN_TOP_MID, 0, 46);
+
+    /* Six keys a row, five rows at a time */
+    picker_owner = item_picker_create(owner_screen, UI_FONT(ui_font_16), owner_keys, OWNER_KEY_COUNT, 6, 5);
+    lv_obj_align(picker_owner, LV_ALIGN_CENTER, 0, 30);
+}
+
+static void remote_timer_cb(void *arg)
+{
+    bool changed = false;
+    for (int zone = 0; zone < zone_count; zone++) {
+        int percent = atomic_exchange(&remote_percent[zone], -1);
+        if (percent >= 0 && percent != zone_percent[zone]) {
+            zone_percent[zone] = percent;
+            fan_set_percent(zone, percent);
+            changed = true;
+        }
+    }
+    int locked = atomic_exchange(&remote_locked, -1);
+    if (!changed && (locked < 0 || locked == ui_locked)) {
+        return;
+    }
+
+    lvgl_port_lock(0);
+    if (changed) {
+        if (zone_strip) {
+            for (int zone = 0; zone < zone_count; zone++) {
+                zone_strip_set_value(zone_strip, zone, zone_percent[zone]);
+            }
+        }
+        update_main_ui();
+    }
+    if (locked >= 0 && locked != ui_locked) {
+        ui_locked = locked;
+        set_lock_overlay(ui_locked);
+    }
+    lvgl_port_unlock();
+}
+
+void ui_init(void)
+{
+    click_recognizer_init(&click_rec, CLICK_GAP_US);
+    create_boot_screen();
+    create_main_screen();
+    create_settings_screen();
+    create_language_screen();
+    create_owner_screen();
+
+    show_screen(boot_screen);
+    update_main_ui();
+
+    if (!boot_timer) {
+        esp_timer_create_args_t timer_args = {
+            .callback = &boot_timer_cb,
+            .name = "boot_timer",
+        };
+        ESP_ERROR_CHECK(esp_timer_create(&timer_args, &boot_timer));
+    }
+    esp_timer_start_once(boot_timer, 2000 * 1000);
+
+    if (!remote_timer) {
+        for (int i = 0; i < FAN_ZONE_MAX; i++) {
+            atomic_store(&remote_percent[i], -1);
+        }
+        esp_timer_create_args_t timer_args = {
+            .callback = &remote_timer_cb,
+            .name = "ui_remote",
+        };
+        ESP_ERROR_CHECK(esp_timer_create(&timer_args, &remote_timer));
+    }
+}
+
+static void handle_knob_move(int direction)
+{
+    if (ui_screen == UI_SCREEN_MAIN) {
+        if (ui_locked) {
+            return;
+        }
+        /* A zone tap changes zone_selected in the LVGL task */
+        lvgl_port_lock(0);
+        int zone = zone_selected;
+        int min_percent, max_percent;
+        fan_zone_limits(zone, &min_percent, &max_percent);
+        int before = zone_percent[zone];
+        int percent = LV_CLAMP(min_percent, before + direction, max_percent);
+        /* Turning against a limit changes nothing; no frame, no latency */
+        if (percent == before) {
+            lvgl_port_unlock();
+            return;
+        }
+        zone_percent[zone] = percent;
+        update_main_ui();
+        latency_trace_commit();
+        lvgl_port_unlock();
+        fan_set_percent(zone, percent);
+        return;
+    }
+
+    if (ui_screen == UI_SCREEN_SETTINGS) {
+        settings_index += direction;
+        if (settings_index < 0) {
+            settings_index = 1;
+        }
+        if (settings_index > 1) {
+            settings_index = 0;
+        }
+        lvgl_port_lock(0);
+        update_settings_selection();
+        lvgl_port_unlock();
+        return;
+    }
+
+    if (ui_screen == UI_SCREEN_LANGUAGE && picker_language) {
+        lvgl_port_lock(0);
+        item_picker_step(picker_language, direction);
+        lvgl_port_unlock();
+        return;
+    }
+
+    if (ui_screen == UI_SCREEN_OWNER && picker_owner) {
+        lvgl_port_lock(0);
+        item_picker_step(picker_owner, direction);
+        lvgl_port_unlock();
+    }
+}
+
+static void handle_owner_selection(void)
+{
+    if (!picker_owner || !label_owner_value) {
+        return;
+    }
+    uint16_t key = item_picker_get_selected(picker_owner);
+    if (key == OWNER_KEY_BACKSPACE) {
+        if (owner_name_len > 0) {
+            owner_name[owner_name_len - 1] = '\0';
+            owner_name_len--;
+        }
+    } else if (key == OWNER_KEY_SAVE) {
+        settings_save_owner(owner_name);
+        ui_screen = UI_SCREEN_SETTINGS;
+        show_screen(settings_screen);
+        apply_language();
+        update_settings_selection();
+        return;
+    } else {
+        char ch = key == OWNER_KEY_SPACE ? ' ' : owner_keys[key][0];
+        if (owner_name_len < OWNER_NAME_MAX_LEN) {
+            owner_name[owner_name_len] = ch;
+            owner_name_len++;
+            owner_name[owner_name_len] = '\0';
+        }
+    }
+    set_label_text(label_owner_value, owner_name_len ? owner_name : "-");
+}
+
+static void handle_single_click(void)
+{
+    if (ui_screen == UI_SCREEN_SETTINGS) {
+        if (settings_index == 0) {
+            /* Changed once shown, so a cached screen only redraws the difference */
+            ui_screen = UI_SCREEN_LANGUAGE;
+            show_screen(language_screen);
+            if (picker_language) {
+                item_picker_set_selected(picker_language, current_lang);
+            }
+        } else if (settings_index == 1) {
+            ui_screen = UI_SCREEN_OWNER;
+            show_screen(owner_screen);
+            if (label_owner_value) {
+                set_label_text(label_owner_value, owner_name_len ? owner_name : "-");
+            }
+        }
+        return;
+    }
+
+    if (ui_screen == UI_SCREEN_LANGUAGE && picker_language) {
+        current_lang = (ui_lang_t)item_picker_get_selected(picker_language);
+        apply_language();
+        settings_save_language((uint8_t)current_lang);
+        ui_screen = UI_SCREEN_SETTINGS;
+        show_screen(settings_screen);
+        return;
+    }
+
+    if (ui_screen == UI_SCREEN_OWNER) {
+        handle_owner_selection();
+    }
+}
+
+static void handle_long_press(void)
+{
+    if (ui_screen == UI_SCREEN_LANGUAGE || ui_screen == UI_SCREEN_OWNER) {
+        ui_screen = UI_SCREEN_SETTINGS;
+        show_screen(settings_screen);
+        apply_language();
+        update_settings_selection();
+        return;
+    }
+    if (ui_screen == UI_SCREEN_SETTINGS) {
+        ui_screen = UI_SCREEN_MAIN;
+        show_screen(main_screen);
+        set_lock_overlay(ui_locked);
+        update_main_ui();
+        return;
+    }
+    if (ui_screen == UI_SCREEN_MAIN && !ui_locked && zone_count > 1) {
+        zone_selected = (zone_selected + 1) % zone_count;
+        update_main_ui();
+    }
+}
+
+void ui_load_settings(void)
+{
+    for (int i = 0; i < FAN_ZONE_MAX; i++) {
+        zone_percent[i] = FAN_SPEED_DEFAULT_PERCENT;
+    }
+    uint8_t lang = (uint8_t)current_lang;
+    settings_load(&lang, LANG_COUNT, owner_name, sizeof(owner_name));
+    current_lang = (ui_lang_t)lang;
+    owner_name_len = strnlen(owner_name, sizeof(owner_name) - 1);
+}
+
+int ui_get_fan_speed(int zone)
+{
+    return zone_percent[zone];
+}
+
+void ui_get_state(ui_state_t *state)
+{
+    state->screen = ui_screen;
+    state->locked = ui_locked;
+    state->zone_selected = zone_selected;
+    state->zone_count = zone_count;
+    for (int i = 0; i < FAN_ZONE_MAX; i++) {
+        /* A set that is still on its way counts as done */
+        int percent = atomic_load(&remote_percent[i]);
+        state->percent[i] = percent >= 0 ? percent : zone_percent[i];
+    }
+    int locked = atomic_load(&remote_locked);
+    if (locked >= 0) {
+        state->locked = locked;
+    }
+}
+
+esp_err_t ui_set_fan_speed(int zone, int percent)
+{
+    if (!remote_timer) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (zone < 0 || zone >= zone_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    int min_percent, max_percent;
+    fan_zone_limits(zone, &min_percent, &max_percent);
+    if (percent < min_percent || percent > max_percent) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    atomic_store(&remote_percent[zone], percent);
+    /* Already armed: the pending run picks this up as well */
+    esp_timer_start_once(remote_timer, 0);
+    return ESP_OK;
+}
+
+void ui_set_locked(bool locked)
+{
+    if (!remote_timer) {
+        return;
+    }
+    atomic_store(&remote_locked, locked);
+    esp_timer_start_once(remote_timer, 0);
+}
+
+void ui_knob_move(int direction)
+{
+    handle_knob_move(direction);
+}
+
+void ui_button_click(void)
+{
+    /* Only the main screen has a triple click; elsewhere every click confirms */
+    click_action_t action = click_recognizer_click(&click_rec, esp_timer_get_time(), ui_screen == UI_SCREEN_MAIN);
+    if (action == CLICK_ACTION_NONE) {
+        return;
+    }
+
+    lvgl_port_lock(0);
+    switch (action) {
+    case CLICK_ACTION_SINGLE:
+        if (ui_screen == UI_SCREEN_MAIN) {
+            ui_locked = !ui_locked;
+            set_lock_overlay(ui_locked);
+        } else {
+            handle_single_click();
+        }
+        break;
+    case CLICK_ACTION_UNDO_SINGLE:
+        /* The first click was the start of a triple click after all */
+        ui_locked = !ui_locked;
+        set_lock_overlay(ui_locked);
+        break;
+    case CLICK_ACTION_TRIPLE:
+        ui_screen = UI_SCREEN_SETTINGS;
+        show_screen(settings_screen);
+        update_settings_selection();
+        break;
+    default:
+        break;
+    }
+    lvgl_port_unlock();
+}
+
+void ui_button_long_press(void)
+{
+    lvgl_port_lock(0);
+    handle_long_press();
+    lvgl_port_unlock();
+}
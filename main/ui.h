@@ -0,0 +1,82 @@
+/**
+ * @file ui.h
+ * @brief Knob UI: screens, navigation and input handling
+ * @details Boot splash, then the fan speed screen. One click toggles the
+ *          lock on the main screen and confirms elsewhere, three clicks open
+ *          the settings, a long press goes back. With several fan zones the
+ *          knob sets the selected zone, and a long press on the main screen
+ *          or a tap on the zone row selects another. Clicks act at once; see
+ *          click_recognizer.h for how a triple click is told apart. Input entry points may be
+ *          called from any task; they take the LVGL port lock themselves.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "fan.h"
+
+typedef struct {
+    uint8_t screen;                     /*!< 0 boot, 1 main, 2 settings, 3 language, 4 owner */
+    bool locked;
+    uint8_t zone_selected;
+    uint8_t zone_count;
+    uint8_t percent[FAN_ZONE_MAX];      /*!< Speed the UI asks for, per zone */
+} ui_state_t;
+
+/**
+ * @brief Read language and owner name from NVS, before ui_init()
+ */
+void ui_load_settings(void);
+
+/**
+ * @brief Fan speed the UI currently asks for in a zone, in percent
+ */
+int ui_get_fan_speed(int zone);
+
+/**
+ * @brief Copy of the UI state, without the LVGL port lock
+ *
+ * Every field is read once with a plain word access; a change in progress
+ * may show up in some fields and not yet in others.
+ */
+void ui_get_state(ui_state_t *state);
+
+/**
+ * @brief Set a zone from outside the knob, e.g. the control link
+ *
+ * Checks the value and hands it to the esp_timer task, which also runs the
+ * knob, so the two never race. That task sets the fan and then updates the
+ * screen under the port lock; the caller does not wait for it. ui_get_state()
+ * shows the new value right away. The lock on the main screen does not
+ * apply.
+ *
+ * @note Call after ui_init().
+ */
+esp_err_t ui_set_fan_speed(int zone, int percent);
+
+/**
+ * @brief Set the lock from outside the button, the same way as ui_set_fan_speed()
+ */
+void ui_set_locked(bool locked);
+
+/**
+ * @brief Build all screens and show the boot splash
+ *
+ * @note Call with the LVGL port lock held.
+ */
+void ui_init(void);
+
+/**
+ * @brief One encoder detent, direction -1 or +1
+ */
+void ui_knob_move(int direction);
+
+/**
+ * @brief Button released after a short press
+ */
+void ui_button_click(void);
+
+void ui_button_long_press(void);
@@ -0,0 +1,27 @@
+/**
+ * @file ui_fonts.h
+ * @brief Subsetted UI fonts
+ * @details Generated at build time by tools/gen_ui_fonts.py from the strings
+ *          tagged with ui-glyphs markers, see main/CMakeLists.txt. With
+ *          CONFIG_EXAMPLE_UI_ASSETS they are packed into the assets partition
+ *          instead of being linked, and UI_FONT() looks them up there.
+ */
+
+#pragma once
+
+#include "lvgl.h"
+
+#if UI_FONTS_IN_ASSETS
+#include "assets.h"
+
+#define UI_FONT(name) assets_font(#name)
+#else
+#define UI_FONT(name) (&name)
+
+LV_FONT_DECLARE(ui_font_12)
+LV_FONT_DECLARE(ui_font_14)
+LV_FONT_DECLARE(ui_font_16)
+LV_FONT_DECLARE(ui_font_20)
+LV_FONT_DECLARE(ui_font_28)
+LV_FONT_DECLARE(ui_font_36)
+#endif
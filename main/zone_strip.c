@@ -0,0 +1,90 @@
+/**
+ * @file zone_strip.c
+ * @brief Row of fan zone cells under the speed readout
+ */
+
+#include <stdio.h>
+
+#include "cell_grid.h"
+#include "zone_strip.h"
+
+#define ZONE_STRIP_PAD_HOR 6
+
+typedef struct {
+    cell_grid_t grid;
+    int16_t values[ZONE_STRIP_MAX];
+} zone_strip_t;
+
+static const char *zone_text(const cell_grid_t *grid, uint16_t index, char *buf, size_t size)
+{
+    const zone_strip_t *zs = (const zone_strip_t *)grid;
+    snprintf(buf, size, "%d\n%d%%", index + 1, zs->values[index]);
+    return buf;
+}
+
+static void clicked_event_cb(lv_event_t *e)
+{
+    lv_obj_t *obj = lv_event_get_target(e);
+    zone_strip_t *zs = lv_event_get_user_data(e);
+    lv_point_t point;
+    lv_indev_get_point(lv_indev_active(), &point);
+
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+    int32_t column = (point.x - coords.x1) / zs->grid.cell_w;
+    int32_t row = (point.y - coords.y1) / zs->grid.cell_h;
+    if (column < 0 || column >= zs->grid.columns || row < 0) {
+        return;
+    }
+    int32_t zone = row * zs->grid.columns + column;
+    if (zone >= zs->grid.count || zone == zs->grid.selected) {
+        return;
+    }
+    cell_grid_set_selected(obj, &zs->grid, zone);
+    lv_obj_send_event(obj, LV_EVENT_VALUE_CHANGED, NULL);
+}
+
+lv_obj_t *zone_strip_create(lv_obj_t *parent, const lv_font_t *font, uint8_t count)
+{
+    if (count == 0 || count > ZONE_STRIP_MAX) {
+        return NULL;
+    }
+    zone_strip_t *zs = lv_malloc_zeroed(sizeof(zone_strip_t));
+    if (!zs) {
+        return NULL;
+    }
+    zs->grid.font = font;
+    zs->grid.text_cb = zone_text;
+    zs->grid.count = count;
+    zs->grid.columns = LV_MIN(count, ZONE_STRIP_COLUMNS);
+    zs->grid.rows = (count + zs->grid.columns - 1) / zs->grid.columns;
+    zs->grid.cell_w = lv_text_get_width("100%", LV_TEXT_LEN_MAX, font, 0) + 2 * ZONE_STRIP_PAD_HOR;
+    zs->grid.cell_h = 2 * lv_font_get_line_height(font) + 2 * CELL_GRID_PAD_VER;
+
+    lv_obj_t *obj = cell_grid_create(parent, &zs->grid);
+    lv_obj_add_flag(obj, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(obj, clicked_event_cb, LV_EVENT_CLICKED, zs);
+    return obj;
+}
+
+void zone_strip_set_value(lv_obj_t *obj, uint8_t zone, int32_t percent)
+{
+    zone_strip_t *zs = lv_obj_get_user_data(obj);
+    if (zone >= zs->grid.count || zs->values[zone] == percent) {
+        return;
+    }
+    zs->values[zone] = percent;
+    cell_grid_invalidate_cell(obj, &zs->grid, zone);
+}
+
+void zone_strip_set_selected(lv_obj_t *obj, uint8_t zone)
+{
+    zone_strip_t *zs = lv_obj_get_user_data(obj);
+    cell_grid_set_selected(obj, &zs->grid, zone);
+}
+
+uint8_t zone_strip_get_selected(const lv_obj_t *obj)
+{
+    const zone_strip_t *zs = lv_obj_get_user_data((lv_obj_t *)obj);
+    return zs->grid.selected;
+}
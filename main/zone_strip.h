@@ -0,0 +1,35 @@
+/**
+ * @file zone_strip.h
+ * @brief Row of fan zone cells under the speed readout
+ * @details One cell per zone, the zone number over its speed, up to
+ *          ZONE_STRIP_COLUMNS cells per row; more zones wrap. The widget
+ *          keeps the numbers itself and formats them while drawing, so a
+ *          speed change invalidates only the cell of that zone and a new
+ *          selection only the old and the new selected cell; unchanged
+ *          values are not redrawn at all.
+ *
+ *          A tap on a cell selects it and sends LV_EVENT_VALUE_CHANGED.
+ *          Cells use the text_color of LV_PART_MAIN; the selected cell uses
+ *          the background and text colour of LV_PART_SELECTED.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "lvgl.h"
+
+#define ZONE_STRIP_MAX 8
+/* Four cells fit the round panel low on the main screen */
+#define ZONE_STRIP_COLUMNS 4
+
+/**
+ * @param count Zones, 1..ZONE_STRIP_MAX
+ */
+lv_obj_t *zone_strip_create(lv_obj_t *parent, const lv_font_t *font, uint8_t count);
+
+void zone_strip_set_value(lv_obj_t *obj, uint8_t zone, int32_t percent);
+
+void zone_strip_set_selected(lv_obj_t *obj, uint8_t zone);
+
+uint8_t zone_strip_get_selected(const lv_obj_t *obj);
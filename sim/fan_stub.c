@@ -0,0 +1,48 @@
+/**
+ * @file fan_stub.c
+ * @brief Host stand-in for the fan PWM outputs
+ */
+
+#include "esp_log.h"
+
+#include "fan.h"
+
+static const char *TAG = "fan";
+
+static fan_zone_config_t s_zones[FAN_ZONE_MAX];
+static int s_zone_count = 0;
+
+esp_err_t fan_init(const fan_zone_config_t *zones, int count)
+{
+    if (!zones || count < 1 || count > FAN_ZONE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < count; i++) {
+        s_zones[i] = zones[i];
+    }
+    s_zone_count = count;
+    return ESP_OK;
+}
+
+int fan_zone_count(void)
+{
+    return s_zone_count;
+}
+
+void fan_zone_limits(int zone, int *min_percent, int *max_percent)
+{
+    *min_percent = s_zones[zone].min_percent;
+    *max_percent = s_zones[zone].max_percent;
+}
+
+void fan_set_percent(int zone, int percent)
+{
+    ESP_LOGD(TAG, "zone %d duty %d%%", zone, percent);
+}
+
+void fan_set_all(const int *percent)
+{
+    for (int i = 0; i < s_zone_count; i++) {
+        fan_set_percent(i, percent[i]);
+    }
+}
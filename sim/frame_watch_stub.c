@@ -0,0 +1,15 @@
+/**
+ * @file frame_watch_stub.c
+ * @brief Host stand-in for the frame budget watchdog phase marks
+ */
+
+#include "frame_watch.h"
+
+int64_t frame_watch_phase_begin(void)
+{
+    return 0;
+}
+
+void frame_watch_phase_end(frame_phase_t phase, int64_t begin_us)
+{
+}
@@ -0,0 +1,43 @@
+/**
+ * @file lv_conf.h
+ * @brief LVGL configuration of the host simulator
+ * @details Mirrors the LVGL options in sdkconfig that change what gets
+ *          rendered (colour depth, refresh period, fonts, widgets). Memory
+ *          comes from the C library instead of the 128 KB builtin pool so
+ *          valgrind and heap profilers see individual allocations.
+ */
+
+#ifndef LV_CONF_H
+#define LV_CONF_H
+
+#define LV_COLOR_DEPTH 16
+
+#define LV_USE_STDLIB_MALLOC LV_STDLIB_CLIB
+#define LV_USE_STDLIB_STRING LV_STDLIB_CLIB
+#define LV_USE_STDLIB_SPRINTF LV_STDLIB_CLIB
+
+#define LV_USE_OS LV_OS_NONE
+#define LV_DEF_REFR_PERIOD 33
+#define LV_DPI_DEF 130
+#define LV_DRAW_SW_DRAW_UNIT_CNT 1
+
+#define LV_USE_LOG 1
+#define LV_LOG_LEVEL LV_LOG_LEVEL_WARN
+#define LV_LOG_PRINTF 1
+
+#define LV_FONT_MONTSERRAT_14 0
+#define LV_FONT_MONTSERRAT_16 1
+#define LV_FONT_DEFAULT &lv_font_montserrat_16
+#define LV_USE_FONT_COMPRESSED 1
+
+#define LV_USE_CANVAS 1
+#define LV_USE_ROLLER 1
+#define LV_USE_SNAPSHOT 1
+
+#define LV_USE_THEME_DEFAULT 1
+#define LV_THEME_DEFAULT_DARK 0
+
+#define LV_USE_SYSMON 0
+#define LV_BUILD_EXAMPLES 0
+
+#endif /* LV_CONF_H */
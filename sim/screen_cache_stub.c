@@ -0,0 +1,15 @@
+/**
+ * @file screen_cache_stub.c
+ * @brief Host stand-in for the screen snapshot cache: every load renders
+ */
+
+#include "screen_cache.h"
+
+void screen_cache_load(lv_obj_t *screen, screen_cache_transition_t transition)
+{
+    lv_screen_load(screen);
+}
+
+void screen_cache_changed(lv_obj_t *screen)
+{
+}
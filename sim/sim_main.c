@@ -0,0 +1,342 @@
+/**
+ * @file sim_main.c
+ * @brief Host simulator of the knob UI
+ * @details Renders main/ui.c with LVGL into a 472x466 RGB565 framebuffer in
+ *          memory, in the same partial-buffer mode and with the same even
+ *          area alignment as the device. Input comes from a script, time
+ *          from a virtual clock (1 ms steps), so two runs of one script
+ *          render the same frames. For every frame that drew anything the
+ *          wall-clock render time, the number of flushed areas and the
+ *          flushed pixel count are recorded.
+ *
+ *          Script commands, one per line, '#' starts a comment:
+ *            wait <ms>               let time pass
+ *            knob <steps> [<ms>]     encoder detents, sign is the direction,
+ *                                    <ms> apart (default 20)
+ *            click [<n>]             n short presses 150 ms apart (default 1)
+ *            long                    long press
+ *            shot <file.ppm>         dump the framebuffer
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "lvgl.h"
+#include "esp_timer.h"
+
+#include "fan.h"
+#include "ui.h"
+#include "latency_trace.h"
+
+#define SIM_H_RES 472
+#define SIM_V_RES 466
+#define SIM_DRAW_BUFF_ROWS 60
+#define SIM_CLICK_GAP_MS 150
+#define SIM_KNOB_GAP_MS 20
+#define SIM_MAX_FRAMES 100000
+
+typedef struct {
+    uint32_t t_ms;
+    uint32_t render_us;
+    uint32_t areas;
+    uint32_t pixels;
+} sim_frame_t;
+
+static uint16_t s_fb[SIM_H_RES * SIM_V_RES];
+static uint32_t s_now_ms = 0;
+
+static sim_frame_t *s_frames;
+static size_t s_frame_cnt = 0;
+static uint64_t s_refr_start_ns = 0;
+static uint32_t s_refr_areas = 0;
+static uint32_t s_refr_pixels = 0;
+
+static const char *s_default_script[] = {
+    "wait 2500",
+    "knob 10", "wait 500",
+    "knob -25", "wait 500",
+    "click", "wait 1000",
+    "click", "wait 1000",
+    "click 3", "wait 1000",
+    "knob 1", "wait 300",
+    "click", "wait 1000",
+    "knob 3", "wait 500",
+    "click", "wait 1000",
+    "long", "wait 500",
+    "long", "wait 1000",
+};
+
+static uint64_t mono_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static uint32_t sim_tick_get(void)
+{
+    return s_now_ms;
+}
+
+static void flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    const int32_t w = lv_area_get_width(area);
+    const uint16_t *src = (const uint16_t *)px_map;
+    for (int32_t y = area->y1; y <= area->y2; y++) {
+        memcpy(&s_fb[y * SIM_H_RES + area->x1], src, w * sizeof(uint16_t));
+        src += w;
+    }
+    s_refr_areas++;
+    s_refr_pixels += lv_area_get_size(area);
+    lv_display_flush_ready(disp);
+}
+
+/* Same alignment as the device rounder, the SH8601 wants even boundaries */
+static void rounder_cb(lv_event_t *e)
+{
+    lv_area_t *area = lv_event_get_invalidated_area(e);
+    area->x1 &= ~1;
+    area->y1 &= ~1;
+    area->x2 |= 1;
+    area->y2 |= 1;
+}
+
+static void refr_cb(lv_event_t *e)
+{
+    if (lv_event_get_code(e) == LV_EVENT_REFR_START) {
+        s_refr_start_ns = mono_ns();
+        s_refr_areas = 0;
+        s_refr_pixels = 0;
+        return;
+    }
+    if (!s_refr_pixels) {
+        return;
+    }
+    /* Flushing is synchronous here, the frame is on the "panel" now */
+    latency_trace_frame_done(esp_timer_get_time(), NULL);
+    if (s_frame_cnt == SIM_MAX_FRAMES) {
+        return;
+    }
+    sim_frame_t *f = &s_frames[s_frame_cnt++];
+    f->t_ms = s_now_ms;
+    f->render_us = (uint32_t)((mono_ns() - s_refr_start_ns) / 1000);
+    f->areas = s_refr_areas;
+    f->pixels = s_refr_pixels;
+}
+
+static void run_for(uint32_t ms)
+{
+    for (uint32_t i = 0; i < ms; i++) {
+        s_now_ms++;
+        esp_timer_sim_advance((int64_t)s_now_ms * 1000);
+        lv_timer_handler();
+    }
+}
+
+static int save_ppm(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", SIM_H_RES, SIM_V_RES);
+    for (int i = 0; i < SIM_H_RES * SIM_V_RES; i++) {
+        uint16_t c = s_fb[i];
+        uint8_t rgb[3] = {
+            (uint8_t)(((c >> 11) & 0x1F) * 255 / 31),
+            (uint8_t)(((c >> 5) & 0x3F) * 255 / 63),
+            (uint8_t)((c & 0x1F) * 255 / 31),
+        };
+        fwrite(rgb, 1, sizeof(rgb), f);
+    }
+    fclose(f);
+    return 0;
+}
+
+static int run_command(const char *line, int lineno)
+{
+    char cmd[16] = "";
+    char arg[256] = "";
+    long a = 0;
+    long b = 0;
+    int n = sscanf(line, " %15s %255s", cmd, arg);
+    if (n <= 0 || cmd[0] == '#') {
+        return 0;
+    }
+
+    if (strcmp(cmd, "wait") == 0 && n == 2) {
+        run_for((uint32_t)strtoul(arg, NULL, 10));
+    } else if (strcmp(cmd, "knob") == 0 && n == 2) {
+        b = SIM_KNOB_GAP_MS;
+        sscanf(line, " %*s %ld %ld", &a, &b);
+        for (long i = 0; i < labs(a); i++) {
+            latency_trace_input();
+            ui_knob_move(a < 0 ? -1 : 1);
+            run_for((uint32_t)b);
+        }
+    } else if (strcmp(cmd, "click") == 0) {
+        a = n == 2 ? strtol(arg, NULL, 10) : 1;
+        for (long i = 0; i < a; i++) {
+            ui_button_click();
+            run_for(SIM_CLICK_GAP_MS);
+        }
+    } else if (strcmp(cmd, "long") == 0) {
+        ui_button_long_press();
+    } else if (strcmp(cmd, "shot") == 0 && n == 2) {
+        return save_ppm(arg);
+    } else {
+        fprintf(stderr, "line %d: cannot parse \"%s\"\n", lineno, line);
+        return -1;
+    }
+    return 0;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void report(FILE *csv)
+{
+    if (csv) {
+        fprintf(csv, "t_ms,render_us,areas,pixels,screen_pct\n");
+        for (size_t i = 0; i < s_frame_cnt; i++) {
+            const sim_frame_t *f = &s_frames[i];
+            fprintf(csv, "%u,%u,%u,%u,%.1f\n", f->t_ms, f->render_us, f->areas, f->pixels,
+                    f->pixels * 100.0 / (SIM_H_RES * SIM_V_RES));
+        }
+    }
+
+    if (!s_frame_cnt) {
+        printf("no frames rendered\n");
+        return;
+    }
+    uint32_t *us = malloc(s_frame_cnt * sizeof(uint32_t));
+    uint64_t total_us = 0;
+    uint64_t total_px = 0;
+    for (size_t i = 0; i < s_frame_cnt; i++) {
+        us[i] = s_frames[i].render_us;
+        total_us += us[i];
+        total_px += s_frames[i].pixels;
+    }
+    qsort(us, s_frame_cnt, sizeof(uint32_t), cmp_u32);
+    printf("frames       %zu over %u ms of virtual time\n", s_frame_cnt, s_now_ms);
+    printf("render us    avg %llu  p50 %u  p95 %u  max %u\n", (unsigned long long)(total_us / s_frame_cnt),
+           us[s_frame_cnt / 2], us[s_frame_cnt * 95 / 100], us[s_frame_cnt - 1]);
+    printf("flushed px   total %llu  avg %llu per frame (%.1f%% of screen)\n", (unsigned long long)total_px,
+           (unsigned long long)(total_px / s_frame_cnt), total_px * 100.0 / s_frame_cnt / (SIM_H_RES * SIM_V_RES));
+    free(us);
+
+    /* Virtual time: refresh scheduling only, rendering itself takes no time here */
+    latency_trace_stats_t lat;
+    latency_trace_get_stats(&lat);
+    if (lat.count) {
+        printf("knob latency n %u  p50 %u  p99 %u  max %u us (virtual)\n", lat.count, lat.p50_us, lat.p99_us,
+               lat.max_us);
+    }
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-s script] [-c frames.csv] [-z zones]\n"
+            "  -s  input script (default: a built-in tour of all screens)\n"
+            "  -c  write one CSV row per rendered frame\n"
+            "  -z  fan zones, 1..%d (default 1)\n", prog, FAN_ZONE_MAX);
+}
+
+int main(int argc, char **argv)
+{
+    const char *script_path = NULL;
+    const char *csv_path = NULL;
+    int zones = 1;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:c:z:h")) != -1) {
+        switch (opt) {
+        case 's':
+            script_path = optarg;
+            break;
+        case 'c':
+            csv_path = optarg;
+            break;
+        case 'z':
+            zones = atoi(optarg);
+            if (zones < 1 || zones > FAN_ZONE_MAX) {
+                usage(argv[0]);
+                return 2;
+            }
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 2;
+        }
+    }
+
+    s_frames = calloc(SIM_MAX_FRAMES, sizeof(sim_frame_t));
+    if (!s_frames) {
+        return 1;
+    }
+
+    lv_init();
+    lv_tick_set_cb(sim_tick_get);
+
+    lv_display_t *disp = lv_display_create(SIM_H_RES, SIM_V_RES);
+    lv_display_set_color_format(disp, LV_COLOR_FORMAT_RGB565);
+    /* lv_display_set_buffers() asserts on misaligned buffers */
+    static _Alignas(LV_DRAW_BUF_ALIGN) uint8_t buf1[SIM_H_RES * SIM_DRAW_BUFF_ROWS * 2];
+    static _Alignas(LV_DRAW_BUF_ALIGN) uint8_t buf2[SIM_H_RES * SIM_DRAW_BUFF_ROWS * 2];
+    lv_display_set_buffers(disp, buf1, buf2, sizeof(buf1), LV_DISPLAY_RENDER_MODE_PARTIAL);
+    lv_display_set_flush_cb(disp, flush_cb);
+    lv_display_add_event_cb(disp, rounder_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+    lv_display_add_event_cb(disp, refr_cb, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(disp, refr_cb, LV_EVENT_REFR_READY, NULL);
+    latency_trace_attach(disp);
+
+    fan_zone_config_t fan_zones[FAN_ZONE_MAX];
+    for (int i = 0; i < zones; i++) {
+        fan_zones[i] = (fan_zone_config_t) {
+            .gpio_num = -1, .min_percent = 40, .max_percent = 80,
+        };
+    }
+    fan_init(fan_zones, zones);
+    ui_load_settings();
+    ui_init();
+
+    int ret = 0;
+    if (script_path) {
+        FILE *f = fopen(script_path, "r");
+        if (!f) {
+            fprintf(stderr, "%s: %s\n", script_path, strerror(errno));
+            return 1;
+        }
+        char line[512];
+        int lineno = 0;
+        while (!ret && fgets(line, sizeof(line), f)) {
+            line[strcspn(line, "\r\n")] = '\0';
+            ret = run_command(line, ++lineno);
+        }
+        fclose(f);
+    } else {
+        for (size_t i = 0; !ret && i < sizeof(s_default_script) / sizeof(s_default_script[0]); i++) {
+            ret = run_command(s_default_script[i], (int)i + 1);
+        }
+    }
+
+    FILE *csv = NULL;
+    if (csv_path && !(csv = fopen(csv_path, "w"))) {
+        fprintf(stderr, "%s: %s\n", csv_path, strerror(errno));
+    }
+    report(csv);
+    if (csv) {
+        fclose(csv);
+    }
+    free(s_frames);
+    return ret ? 1 : 0;
+}
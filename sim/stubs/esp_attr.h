@@ -0,0 +1,11 @@
+/**
+ * @file esp_attr.h
+ * @brief Host stand-in: memory placement attributes are no-ops
+ */
+
+#pragma once
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+#define EXT_RAM_BSS_ATTR
@@ -0,0 +1,34 @@
+/**
+ * @file esp_log.h
+ * @brief Host stand-in for ESP-IDF logging, to stderr
+ */
+
+#pragma once
+
+#include <inttypes.h>
+#include <stdio.h>
+
+typedef enum {
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE,
+} esp_log_level_t;
+
+#ifndef SIM_LOG_LEVEL
+#define SIM_LOG_LEVEL ESP_LOG_INFO
+#endif
+
+#define ESP_LOG_LEVEL(level, tag, format, ...) do {                             \
+        if ((level) <= SIM_LOG_LEVEL) {                                         \
+            fprintf(stderr, "%c (%s) " format "\n", "NEWIDV"[level], tag, ##__VA_ARGS__); \
+        }                                                                       \
+    } while (0)
+
+#define ESP_LOGE(tag, format, ...) ESP_LOG_LEVEL(ESP_LOG_ERROR, tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) ESP_LOG_LEVEL(ESP_LOG_WARN, tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ESP_LOG_LEVEL(ESP_LOG_INFO, tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) ESP_LOG_LEVEL(ESP_LOG_DEBUG, tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) ESP_LOG_LEVEL(ESP_LOG_VERBOSE, tag, format, ##__VA_ARGS__)
@@ -0,0 +1,18 @@
+/**
+ * @file esp_lvgl_port.h
+ * @brief Host stand-in: the simulator is single threaded, the lock is a no-op
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+static inline bool lvgl_port_lock(uint32_t timeout_ms)
+{
+    return true;
+}
+
+static inline void lvgl_port_unlock(void)
+{
+}
@@ -0,0 +1,131 @@
+/**
+ * @file esp_timer.c
+ * @brief Host stand-in for esp_timer on a virtual clock
+ */
+
+#include <stdlib.h>
+
+#include "esp_timer.h"
+
+#define SIM_TIMER_MAX 32
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void *arg;
+    int64_t expiry_us;
+    uint64_t period_us;
+    bool active;
+};
+
+static struct esp_timer *s_timers[SIM_TIMER_MAX];
+static int s_timer_cnt = 0;
+static int64_t s_now_us = 0;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle)
+{
+    if (!create_args || !create_args->callback || !out_handle) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_timer_cnt == SIM_TIMER_MAX) {
+        return ESP_ERR_NO_MEM;
+    }
+    struct esp_timer *t = calloc(1, sizeof(*t));
+    if (!t) {
+        return ESP_ERR_NO_MEM;
+    }
+    t->callback = create_args->callback;
+    t->arg = create_args->arg;
+    s_timers[s_timer_cnt++] = t;
+    *out_handle = t;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    if (timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->expiry_us = s_now_us + (int64_t)timeout_us;
+    timer->period_us = 0;
+    timer->active = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period)
+{
+    if (timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->expiry_us = s_now_us + (int64_t)period;
+    timer->period_us = period;
+    timer->active = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_restart(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    if (!timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->expiry_us = s_now_us + (int64_t)timeout_us;
+    if (timer->period_us) {
+        timer->period_us = timeout_us;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    if (!timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->active = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    for (int i = 0; i < s_timer_cnt; i++) {
+        if (s_timers[i] == timer) {
+            s_timers[i] = s_timers[--s_timer_cnt];
+            free(timer);
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_INVALID_ARG;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer)
+{
+    return timer->active;
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return s_now_us;
+}
+
+void esp_timer_sim_advance(int64_t now_us)
+{
+    for (;;) {
+        struct esp_timer *next = NULL;
+        for (int i = 0; i < s_timer_cnt; i++) {
+            struct esp_timer *t = s_timers[i];
+            if (t->active && t->expiry_us <= now_us && (!next || t->expiry_us < next->expiry_us)) {
+                next = t;
+            }
+        }
+        if (!next) {
+            break;
+        }
+        /* Callbacks see the time they were due at, as on the device */
+        s_now_us = next->expiry_us;
+        if (next->period_us) {
+            next->expiry_us += (int64_t)next->period_us;
+        } else {
+            next->active = false;
+        }
+        next->callback(next->arg);
+    }
+    s_now_us = now_us;
+}
@@ -0,0 +1,163 @@
+/**
+ * @file nvs.c
+ * @brief Host stand-in for NVS: an in-memory store, empty at start-up
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nvs.h"
+
+#define SIM_NVS_MAX_ENTRIES 64
+#define SIM_NVS_NAME_LEN 16
+
+typedef struct {
+    char ns[SIM_NVS_NAME_LEN];
+    char key[SIM_NVS_NAME_LEN];
+    void *data;
+    size_t len;
+} nvs_entry_t;
+
+static nvs_entry_t s_entries[SIM_NVS_MAX_ENTRIES];
+static char s_namespaces[SIM_NVS_MAX_ENTRIES][SIM_NVS_NAME_LEN];
+static int s_ns_cnt = 0;
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    for (int i = 0; i < s_ns_cnt; i++) {
+        if (strncmp(s_namespaces[i], name, SIM_NVS_NAME_LEN) == 0) {
+            *out_handle = i + 1;
+            return ESP_OK;
+        }
+    }
+    /* Like the real thing: a namespace exists only once written to */
+    if (open_mode == NVS_READONLY || s_ns_cnt == SIM_NVS_MAX_ENTRIES) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    strncpy(s_namespaces[s_ns_cnt], name, SIM_NVS_NAME_LEN - 1);
+    *out_handle = ++s_ns_cnt;
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    return ESP_OK;
+}
+
+static nvs_entry_t *find(nvs_handle_t handle, const char *key, bool create)
+{
+    const char *ns = s_namespaces[handle - 1];
+    nvs_entry_t *free_slot = NULL;
+    for (int i = 0; i < SIM_NVS_MAX_ENTRIES; i++) {
+        nvs_entry_t *e = &s_entries[i];
+        if (!e->data) {
+            free_slot = free_slot ? free_slot : e;
+            continue;
+        }
+        if (strcmp(e->ns, ns) == 0 && strncmp(e->key, key, SIM_NVS_NAME_LEN) == 0) {
+            return e;
+        }
+    }
+    if (create && free_slot) {
+        strncpy(free_slot->ns, ns, SIM_NVS_NAME_LEN - 1);
+        strncpy(free_slot->key, key, SIM_NVS_NAME_LEN - 1);
+        return free_slot;
+    }
+    return NULL;
+}
+
+static esp_err_t set_raw(nvs_handle_t handle, const char *key, const void *value, size_t len)
+{
+    nvs_entry_t *e = find(handle, key, true);
+    if (!e) {
+        return ESP_ERR_NO_MEM;
+    }
+    void *data = malloc(len ? len : 1);
+    if (!data) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(data, value, len);
+    free(e->data);
+    e->data = data;
+    e->len = len;
+    return ESP_OK;
+}
+
+static esp_err_t get_raw(nvs_handle_t handle, const char *key, void *out, size_t len)
+{
+    nvs_entry_t *e = find(handle, key, false);
+    if (!e) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (e->len != len) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    memcpy(out, e->data, len);
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_u8(nvs_handle_t handle, const char *key, uint8_t value)
+{
+    return set_raw(handle, key, &value, sizeof(value));
+}
+
+esp_err_t nvs_get_u8(nvs_handle_t handle, const char *key, uint8_t *out_value)
+{
+    return get_raw(handle, key, out_value, sizeof(*out_value));
+}
+
+esp_err_t nvs_set_u16(nvs_handle_t handle, const char *key, uint16_t value)
+{
+    return set_raw(handle, key, &value, sizeof(value));
+}
+
+esp_err_t nvs_get_u16(nvs_handle_t handle, const char *key, uint16_t *out_value)
+{
+    return get_raw(handle, key, out_value, sizeof(*out_value));
+}
+
+esp_err_t nvs_set_u32(nvs_handle_t handle, const char *key, uint32_t value)
+{
+    return set_raw(handle, key, &value, sizeof(value));
+}
+
+esp_err_t nvs_get_u32(nvs_handle_t handle, const char *key, uint32_t *out_value)
+{
+    return get_raw(handle, key, out_value, sizeof(*out_value));
+}
+
+esp_err_t nvs_set_str(nvs_handle_t handle, const char *key, const char *value)
+{
+    return set_raw(handle, key, value, strlen(value) + 1);
+}
+
+esp_err_t nvs_get_str(nvs_handle_t handle, const char *key, char *out_value, size_t *length)
+{
+    nvs_entry_t *e = find(handle, key, false);
+    if (!e) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (out_value) {
+        if (*length < e->len) {
+            return ESP_ERR_NVS_INVALID_LENGTH;
+        }
+        memcpy(out_value, e->data, e->len);
+    }
+    *length = e->len;
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    return set_raw(handle, key, value, length);
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    return nvs_get_str(handle, key, out_value, length);
+}
@@ -0,0 +1,117 @@
+/**
+ * @file test_click_recognizer.c
+ * @brief Host test of main/click_recognizer.c
+ * @details Feeds click timestamps to the recognizer and checks the action
+ *          for each, with the same gap as ui.c.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "click_recognizer.h"
+
+#define GAP_US (500 * 1000)
+#define MS(ms) ((int64_t)(ms) * 1000)
+
+static int s_failed = 0;
+
+static const char *action_name(click_action_t action)
+{
+    switch (action) {
+    case CLICK_ACTION_NONE:
+        return "NONE";
+    case CLICK_ACTION_SINGLE:
+        return "SINGLE";
+    case CLICK_ACTION_UNDO_SINGLE:
+        return "UNDO_SINGLE";
+    case CLICK_ACTION_TRIPLE:
+        return "TRIPLE";
+    }
+    return "?";
+}
+
+static void expect(click_recognizer_t *rec, int64_t now_us, bool multi, click_action_t want, const char *what)
+{
+    click_action_t got = click_recognizer_click(rec, now_us, multi);
+    if (got != want) {
+        printf("FAIL %s: click at %" PRId64 " us%s gave %s, want %s\n", what, now_us, multi ? "" : " (no multi)",
+               action_name(got), action_name(want));
+        s_failed++;
+    }
+}
+
+static void test_series(void)
+{
+    click_recognizer_t rec;
+    click_recognizer_init(&rec, GAP_US);
+    expect(&rec, MS(1000), true, CLICK_ACTION_SINGLE, "first click");
+    expect(&rec, MS(1150), true, CLICK_ACTION_UNDO_SINGLE, "second click");
+    expect(&rec, MS(1300), true, CLICK_ACTION_TRIPLE, "third click");
+    expect(&rec, MS(1450), true, CLICK_ACTION_NONE, "fourth click");
+    expect(&rec, MS(1600), true, CLICK_ACTION_NONE, "fifth click");
+}
+
+static void test_first_click_at_zero(void)
+{
+    click_recognizer_t rec;
+    click_recognizer_init(&rec, GAP_US);
+    expect(&rec, 0, true, CLICK_ACTION_SINGLE, "click at boot");
+    expect(&rec, MS(100), true, CLICK_ACTION_UNDO_SINGLE, "second click after boot");
+}
+
+static void test_gap_expiry(void)
+{
+    click_recognizer_t rec;
+    click_recognizer_init(&rec, GAP_US);
+    expect(&rec, MS(1000), true, CLICK_ACTION_SINGLE, "first click");
+    /* Exactly the gap still belongs to the series */
+    expect(&rec, MS(1000) + GAP_US, true, CLICK_ACTION_UNDO_SINGLE, "click at the gap");
+    /* The gap counts from the last click, not the first */
+    expect(&rec, MS(1000) + 2 * GAP_US, true, CLICK_ACTION_TRIPLE, "click at the gap again");
+
+    expect(&rec, MS(1000) + 3 * GAP_US + 1, true, CLICK_ACTION_SINGLE, "click after the gap");
+    expect(&rec, MS(5000), true, CLICK_ACTION_SINGLE, "lone click");
+    expect(&rec, MS(6000), true, CLICK_ACTION_SINGLE, "lone click");
+    expect(&rec, MS(6200), true, CLICK_ACTION_UNDO_SINGLE, "double click");
+    expect(&rec, MS(6200) + GAP_US + 1, true, CLICK_ACTION_SINGLE, "click after a double");
+}
+
+static void test_no_multi(void)
+{
+    click_recognizer_t rec;
+    click_recognizer_init(&rec, GAP_US);
+    expect(&rec, MS(1000), false, CLICK_ACTION_SINGLE, "no multi, first click");
+    expect(&rec, MS(1100), false, CLICK_ACTION_SINGLE, "no multi, fast click");
+    expect(&rec, MS(1200), false, CLICK_ACTION_SINGLE, "no multi, fast click");
+    expect(&rec, MS(1300), false, CLICK_ACTION_SINGLE, "no multi, fast click");
+    /* Clicks outside the multi context do not start a series */
+    expect(&rec, MS(1400), true, CLICK_ACTION_SINGLE, "multi after no multi");
+}
+
+static void test_leave_multi(void)
+{
+    click_recognizer_t rec;
+    click_recognizer_init(&rec, GAP_US);
+    expect(&rec, MS(1000), true, CLICK_ACTION_SINGLE, "first click");
+    expect(&rec, MS(1150), true, CLICK_ACTION_UNDO_SINGLE, "second click");
+    expect(&rec, MS(1300), true, CLICK_ACTION_TRIPLE, "third click");
+    /* The triple click switched screens; the rest of the series is swallowed */
+    expect(&rec, MS(1450), false, CLICK_ACTION_NONE, "tail of the series");
+    expect(&rec, MS(1600), false, CLICK_ACTION_NONE, "tail of the series");
+    expect(&rec, MS(1600) + GAP_US + 1, false, CLICK_ACTION_SINGLE, "click after the tail");
+}
+
+int main(void)
+{
+    test_series();
+    test_first_click_at_zero();
+    test_gap_expiry();
+    test_no_multi();
+    test_leave_multi();
+    if (s_failed) {
+        printf("%d check(s) failed\n", s_failed);
+        return 1;
+    }
+    printf("click_recognizer: all checks passed\n");
+    return 0;
+}
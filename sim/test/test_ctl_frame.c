@@ -0,0 +1,164 @@
+/**
+ * @file test_ctl_frame.c
+ * @brief Host test of main/ctl_frame.c
+ * @details Frames from tools/ctl_link.py must come out of the C encoder
+ *          byte for byte and decode back to their payload; random payloads
+ *          must survive a round trip, and damaged frames must be rejected.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ctl_frame.h"
+
+#define MAX_PAYLOAD 1024
+#define ROUND_TRIPS 2000
+
+typedef struct {
+    const char *name;
+    uint8_t payload[16];
+    size_t payload_len;
+    uint8_t frame[24];      /* pack_frame() of tools/ctl_link.py, delimiter included */
+    size_t frame_len;
+} vector_t;
+
+static const vector_t s_vectors[] = {
+    {
+        "ping", {0x01, 0x00}, 2,
+        {0x02, 0x01, 0x05, 0xBE, 0x23, 0xC2, 0x58, 0x00}, 8,
+    },
+    {
+        "set speed", {0x03, 0x07, 0x01, 0x46}, 4,
+        {0x09, 0x03, 0x07, 0x01, 0x46, 0x93, 0xB3, 0x1A, 0xB0, 0x00}, 10,
+    },
+    {
+        "state reply", {0x82, 0x09, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x32, 0x3C}, 10,
+        {0x03, 0x82, 0x09, 0x02, 0x01, 0x02, 0x02, 0x01, 0x07, 0x32, 0x3C, 0x33, 0x77, 0x71, 0xB3, 0x00}, 16,
+    },
+};
+
+static int s_failed = 0;
+
+static void fail(const char *what, const char *detail)
+{
+    printf("FAIL %s: %s\n", what, detail);
+    s_failed++;
+}
+
+/* Seal and encode like send_frame() in ctl_link.c; returns the frame length with the delimiter */
+static size_t pack(const uint8_t *payload, size_t len, uint8_t *frame)
+{
+    uint8_t sealed[MAX_PAYLOAD + CTL_FRAME_CRC_LEN];
+    memcpy(sealed, payload, len);
+    len = ctl_frame_seal(sealed, len);
+    size_t encoded = ctl_frame_encoded_len(sealed, len);
+    if (ctl_frame_encode(sealed, len, frame) != encoded) {
+        fail("encode", "length differs from ctl_frame_encoded_len()");
+    }
+    frame[encoded] = 0;
+    return encoded + 1;
+}
+
+static void test_vectors(void)
+{
+    for (size_t v = 0; v < sizeof(s_vectors) / sizeof(s_vectors[0]); v++) {
+        const vector_t *vec = &s_vectors[v];
+        uint8_t frame[64];
+        size_t len = pack(vec->payload, vec->payload_len, frame);
+        if (len != vec->frame_len || memcmp(frame, vec->frame, len) != 0) {
+            fail(vec->name, "encoding differs from tools/ctl_link.py");
+        }
+
+        memcpy(frame, vec->frame, vec->frame_len);
+        len = ctl_frame_open(frame, vec->frame_len - 1, 2);
+        if (len != vec->payload_len || memcmp(frame, vec->payload, len) != 0) {
+            fail(vec->name, "decoding does not give the payload back");
+        }
+    }
+}
+
+static void test_round_trips(void)
+{
+    static uint8_t payload[MAX_PAYLOAD];
+    static uint8_t frame[2 * MAX_PAYLOAD];
+    srand(1);
+    for (int n = 0; n < ROUND_TRIPS; n++) {
+        size_t len = 2 + rand() % (MAX_PAYLOAD - 1);
+        /* Mostly long non-zero runs, which is where COBS inserts code bytes */
+        int zero_every = n % 3 == 0 ? 2 : n % 3 == 1 ? 300 : 0;
+        for (size_t i = 0; i < len; i++) {
+            payload[i] = zero_every && rand() % zero_every == 0 ? 0 : 1 + rand() % 255;
+        }
+        size_t frame_len = pack(payload, len, frame);
+        if (memchr(frame, 0, frame_len - 1)) {
+            fail("round trip", "zero byte inside an encoded frame");
+            return;
+        }
+        size_t out = ctl_frame_open(frame, frame_len - 1, 2);
+        if (out != len || memcmp(frame, payload, len) != 0) {
+            fail("round trip", "payload changed");
+            return;
+        }
+    }
+
+    /* Exact multiples of a COBS block are the edge cases */
+    for (size_t len = 250; len <= 512; len++) {
+        memset(payload, 0x5A, len);
+        size_t frame_len = pack(payload, len, frame);
+        if (ctl_frame_open(frame, frame_len - 1, 2) != len || memcmp(frame, payload, len) != 0) {
+            fail("block edge", "payload changed");
+            return;
+        }
+    }
+}
+
+static void test_damage(void)
+{
+    const vector_t *vec = &s_vectors[2];
+    uint8_t frame[64];
+
+    for (size_t i = 0; i + 1 < vec->frame_len; i++) {
+        memcpy(frame, vec->frame, vec->frame_len);
+        frame[i] ^= 0x10;
+        if (ctl_frame_open(frame, vec->frame_len - 1, 2) != 0) {
+            fail("damaged frame", "accepted");
+        }
+    }
+
+    memcpy(frame, vec->frame, vec->frame_len);
+    if (ctl_frame_open(frame, vec->frame_len - 2, 2) != 0) {
+        fail("truncated frame", "accepted");
+    }
+
+    /* Code byte pointing past the end */
+    const uint8_t overrun[] = {0x09, 0x01, 0x02};
+    memcpy(frame, overrun, sizeof(overrun));
+    if (ctl_frame_open(frame, sizeof(overrun), 2) != 0) {
+        fail("overrun", "accepted");
+    }
+
+    /* A valid CRC over a payload shorter than asked for */
+    const uint8_t one[] = {0x01};
+    size_t len = pack(one, sizeof(one), frame);
+    if (ctl_frame_open(frame, len - 1, 2) != 0) {
+        fail("short payload", "accepted");
+    }
+
+    if (ctl_frame_open(frame, 0, 2) != 0) {
+        fail("empty frame", "accepted");
+    }
+}
+
+int main(void)
+{
+    test_vectors();
+    test_round_trips();
+    test_damage();
+    if (s_failed) {
+        printf("%d check(s) failed\n", s_failed);
+        return 1;
+    }
+    printf("ctl_frame: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,409 @@
+#!/usr/bin/env python3
+"""
+Host side of the knob binary control link (main/ctl_link.h).
+
+Talks to the device over USB-Serial-JTAG, where it first types "link" at the
+console, or to an in-process stand-in of the firmware with --loopback, which
+answers the same requests and streams the same telemetry frames:
+
+    tools/ctl_link.py --port /dev/ttyACM0 state
+    tools/ctl_link.py --port /dev/ttyACM0 set 1 70
+    tools/ctl_link.py --port /dev/ttyACM0 lock on
+    tools/ctl_link.py --port /dev/ttyACM0 stream --period-us 1000 --seconds 10 > telemetry.csv
+    tools/ctl_link.py --loopback --zones 3 check
+
+A frame is COBS(type, seq, body, CRC-32) followed by 0x00; the CRC is zlib's
+over type, seq and body, little-endian. "check" runs every request once and
+verifies the replies, against either end.
+
+The serial port needs pyserial.
+"""
+
+import argparse
+import queue
+import struct
+import sys
+import threading
+import time
+import zlib
+
+VERSION = 1
+IDLE_S = 3.0
+MIN_PERIOD_US = 1000
+
+PING = 0x01
+GET_STATE = 0x02
+SET_SPEED = 0x03
+SET_LOCK = 0x04
+GET_SETTINGS = 0x05
+STREAM = 0x06
+CLOSE = 0x07
+REPLY = 0x80
+TELEMETRY = 0xC0
+
+OK = 0
+ERR_ARG = 1
+ERR_LENGTH = 2
+ERR_TYPE = 3
+STATUS_NAMES = {OK: "ok", ERR_ARG: "bad argument", ERR_LENGTH: "bad length", ERR_TYPE: "unknown request"}
+
+
+def cobs_encode(data):
+    out = bytearray(b"\0")
+    code_pos = 0
+    code = 1
+    for byte in data:
+        if byte:
+            out.append(byte)
+            code += 1
+        if not byte or code == 0xFF:
+            out[code_pos] = code
+            code_pos = len(out)
+            out.append(0)
+            code = 1
+    out[code_pos] = code
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        i += 1
+        if code == 0 or i + code - 1 > len(data):
+            return None
+        out += data[i:i + code - 1]
+        i += code - 1
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def pack_frame(kind, seq, body=b""):
+    payload = bytes((kind, seq)) + body
+    return cobs_encode(payload + struct.pack("<I", zlib.crc32(payload))) + b"\0"
+
+
+class Deframer:
+    """Splits a byte stream at 0x00 and keeps the frames that pass the CRC."""
+
+    def __init__(self):
+        self.buf = bytearray()
+
+    def feed(self, chunk):
+        self.buf += chunk
+        while True:
+            end = self.buf.find(0)
+            if end < 0:
+                return
+            raw = bytes(self.buf[:end])
+            del self.buf[:end + 1]
+            payload = cobs_decode(raw)
+            if payload is None or len(payload) < 6:
+                continue
+            (crc,) = struct.unpack_from("<I", payload, len(payload) - 4)
+            if zlib.crc32(payload[:-4]) != crc:
+                continue
+            yield payload[0], payload[1], payload[2:-4]
+
+
+def parse_state(data):
+    screen, flags, selected, count = data[:4]
+    return {"screen": screen, "locked": bool(flags & 1), "zone_selected": selected, "zone_count": count,
+            "percent": list(data[4:4 + count])}
+
+
+def parse_telemetry(body):
+    seq, dropped, t_us = struct.unpack_from("<HHI", body)
+    state = parse_state(body[8:])
+    count = state["zone_count"]
+    duty = struct.unpack_from("<%dH" % count, body, 12 + count)
+    return seq, dropped, t_us, state, list(duty)
+
+
+class LoopbackDevice:
+    """Firmware stand-in: the same requests, replies and telemetry as ctl_link.c."""
+
+    def __init__(self, zones=1, min_percent=40, max_percent=80, max_duty=1023):
+        self.limits = (min_percent, max_percent)
+        self.max_duty = max_duty
+        self.percent = [65] * zones
+        self.locked = False
+        self.selected = 0
+        self.lang = 0
+        self.owner = b"Mark"
+        self.lock = threading.Lock()
+        self.rx = Deframer()
+        self.out = queue.Queue()
+        self.period = 0
+        self.seq = 0
+        self.closed = False
+        self.thread = threading.Thread(target=self._telemetry, daemon=True)
+        self.thread.start()
+
+    def _state(self):
+        return bytes((1, int(self.locked), self.selected, len(self.percent))) + bytes(self.percent)
+
+    def _telemetry(self):
+        start = time.monotonic()
+        next_t = start
+        while not self.closed:
+            period = self.period
+            if not period:
+                time.sleep(0.01)
+                next_t = time.monotonic()
+                continue
+            next_t += period / 1e6
+            time.sleep(max(0.0, next_t - time.monotonic()))
+            with self.lock:
+                duty = [p * self.max_duty // 100 for p in self.percent]
+                body = struct.pack("<HHI", self.seq & 0xFFFF, 0, int((time.monotonic() - start) * 1e6) & 0xFFFFFFFF)
+                body += self._state() + struct.pack("<%dH" % len(duty), *duty)
+                self.seq += 1
+            self.out.put(pack_frame(TELEMETRY, 0, body))
+
+    def _handle(self, kind, seq, body):
+        status = OK
+        data = b""
+        with self.lock:
+            if kind == PING:
+                data = bytes((VERSION, len(self.percent)))
+            elif kind == GET_STATE:
+                data = self._state()
+            elif kind == SET_SPEED:
+                if len(body) != 2:
+                    status = ERR_LENGTH
+                elif body[0] >= len(self.percent) or not self.limits[0] <= body[1] <= self.limits[1]:
+                    status = ERR_ARG
+                else:
+                    self.percent[body[0]] = body[1]
+            elif kind == SET_LOCK:
+                if len(body) != 1:
+                    status = ERR_LENGTH
+                elif body[0] > 1:
+                    status = ERR_ARG
+                else:
+                    self.locked = bool(body[0])
+            elif kind == GET_SETTINGS:
+                data = bytes((self.lang, len(self.owner))) + self.owner
+            elif kind == STREAM:
+                if len(body) != 4:
+                    status = ERR_LENGTH
+                else:
+                    (period,) = struct.unpack("<I", body)
+                    if period and period < MIN_PERIOD_US:
+                        self.period = 0
+                        status = ERR_ARG
+                    else:
+                        self.seq = 0
+                        self.period = period
+            elif kind == CLOSE:
+                self.period = 0
+            else:
+                status = ERR_TYPE
+        self.out.put(pack_frame(kind | REPLY, seq, bytes((status,)) + data))
+
+    # Transport interface
+    def write(self, data):
+        for kind, seq, body in self.rx.feed(data):
+            self._handle(kind, seq, body)
+
+    def read(self, timeout):
+        try:
+            return self.out.get(timeout=timeout)
+        except queue.Empty:
+            return b""
+
+    def close(self):
+        self.closed = True
+
+
+class SerialTransport:
+    def __init__(self, port):
+        import serial
+        self.port = serial.Serial(port, 115200, timeout=0.05)
+        # Leave whatever half-typed line there is, then hand the port to the link
+        self.port.write(b"\r\nlink\r\n")
+
+    def write(self, data):
+        self.port.write(data)
+
+    def read(self, timeout):
+        self.port.timeout = timeout
+        first = self.port.read(1)
+        return first + self.port.read(self.port.in_waiting) if first else b""
+
+    def close(self):
+        self.port.close()
+
+
+class Link:
+    def __init__(self, transport):
+        self.transport = transport
+        self.rx = Deframer()
+        self.seq = 0
+        self.telemetry = queue.Queue()
+        self.last_tx = 0.0
+
+    def _poll(self, timeout):
+        for frame in self.rx.feed(self.transport.read(timeout)):
+            yield frame
+
+    def request(self, kind, body=b"", timeout=1.0, retries=3):
+        for _ in range(retries):
+            self.seq = (self.seq + 1) & 0xFF
+            self.transport.write(pack_frame(kind, self.seq, body))
+            self.last_tx = time.monotonic()
+            deadline = self.last_tx + timeout
+            while time.monotonic() < deadline:
+                for rkind, rseq, rbody in self._poll(0.05):
+                    if rkind == TELEMETRY:
+                        self.telemetry.put(rbody)
+                    elif rkind == kind | REPLY and rseq == self.seq:
+                        return rbody[0], rbody[1:]
+        raise TimeoutError("no reply to request 0x%02x" % kind)
+
+    def checked(self, kind, body=b""):
+        status, data = self.request(kind, body)
+        if status != OK:
+            raise RuntimeError("request 0x%02x: %s" % (kind, STATUS_NAMES.get(status, status)))
+        return data
+
+    def ping(self):
+        data = self.checked(PING)
+        return data[0], data[1]
+
+    def state(self):
+        return parse_state(self.checked(GET_STATE))
+
+    def set_speed(self, zone, percent):
+        self.checked(SET_SPEED, bytes((zone, percent)))
+
+    def set_lock(self, locked):
+        self.checked(SET_LOCK, bytes((int(locked),)))
+
+    def settings(self):
+        data = self.checked(GET_SETTINGS)
+        return data[0], data[2:2 + data[1]].decode("utf-8", "replace")
+
+    def stream(self, period_us):
+        self.checked(STREAM, struct.pack("<I", period_us))
+
+    def samples(self, seconds):
+        """Yield telemetry until the time is up, keeping the link alive."""
+        end = time.monotonic() + seconds
+        while time.monotonic() < end:
+            while not self.telemetry.empty():
+                yield parse_telemetry(self.telemetry.get())
+            if time.monotonic() - self.last_tx > IDLE_S / 3:
+                self.ping()
+                continue
+            for kind, _, body in self._poll(0.05):
+                if kind == TELEMETRY:
+                    yield parse_telemetry(body)
+
+    def close(self):
+        try:
+            self.request(CLOSE, retries=1)
+        except TimeoutError:
+            pass
+        self.transport.close()
+
+
+def run_check(link):
+    version, zones = link.ping()
+    assert version == VERSION, "protocol version %d" % version
+    before = link.state()
+    assert before["zone_count"] == zones
+    for zone in range(zones):
+        link.set_speed(zone, 50 + zone)
+    after = link.state()
+    assert after["percent"] == [50 + z for z in range(zones)], after
+    assert link.request(SET_SPEED, bytes((zones, 50)))[0] == ERR_ARG
+    assert link.request(SET_SPEED, bytes((0, 101)))[0] == ERR_ARG
+    assert link.request(SET_SPEED, b"\0")[0] == ERR_LENGTH
+    assert link.request(0x7F)[0] == ERR_TYPE
+    link.set_lock(True)
+    assert link.state()["locked"]
+    link.set_lock(before["locked"])
+    link.settings()
+    link.stream(1000)
+    got = list(link.samples(0.5))
+    link.stream(0)
+    assert got, "no telemetry"
+    seqs = [s[0] for s in got]
+    assert seqs == sorted(seqs), "telemetry out of order"
+    for zone, percent in enumerate(before["percent"]):
+        link.set_speed(zone, percent)
+    return len(got)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    target = parser.add_mutually_exclusive_group(required=True)
+    target.add_argument("--port", help="serial port of the device console")
+    target.add_argument("--loopback", action="store_true", help="talk to the in-process firmware stand-in")
+    parser.add_argument("--zones", type=int, default=1, help="zones of the loopback device (default 1)")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+    sub.add_parser("ping")
+    sub.add_parser("state")
+    sub.add_parser("settings")
+    p = sub.add_parser("set", help="set the speed of a zone (zones count from 1)")
+    p.add_argument("zone", type=int)
+    p.add_argument("percent", type=int)
+    p = sub.add_parser("lock")
+    p.add_argument("on", choices=("on", "off"))
+    p = sub.add_parser("stream", help="telemetry as CSV on stdout")
+    p.add_argument("--period-us", type=int, default=1000)
+    p.add_argument("--seconds", type=float, default=10.0)
+    sub.add_parser("check", help="run every request once and verify the replies")
+    args = parser.parse_args()
+
+    transport = LoopbackDevice(args.zones) if args.loopback else SerialTransport(args.port)
+    link = Link(transport)
+    try:
+        if args.cmd == "ping":
+            version, zones = link.ping()
+            print("protocol %d, %d zone(s)" % (version, zones))
+        elif args.cmd == "state":
+            s = link.state()
+            print("screen %d, %s, zone %d of %d selected, speeds %s" % (
+                s["screen"], "locked" if s["locked"] else "unlocked", s["zone_selected"] + 1, s["zone_count"],
+                " ".join("%d%%" % p for p in s["percent"])))
+        elif args.cmd == "settings":
+            lang, owner = link.settings()
+            print("language %d, owner %r" % (lang, owner))
+        elif args.cmd == "set":
+            link.set_speed(args.zone - 1, args.percent)
+        elif args.cmd == "lock":
+            link.set_lock(args.on == "on")
+        elif args.cmd == "stream":
+            link.stream(args.period_us)
+            print("seq,dropped,t_us,screen,locked,zone_selected," +
+                  ",".join("percent%d,duty%d" % (z + 1, z + 1) for z in range(link.ping()[1])))
+            last = None
+            try:
+                for seq, dropped, t_us, s, duty in link.samples(args.seconds):
+                    if last is not None and seq != (last + 1) & 0xFFFF:
+                        print("lost %d samples before seq %d" % ((seq - last - 1) & 0xFFFF, seq), file=sys.stderr)
+                    last = seq
+                    zones = ",".join("%d,%d" % pd for pd in zip(s["percent"], duty))
+                    print("%d,%d,%d,%d,%d,%d,%s" % (seq, dropped, t_us, s["screen"], s["locked"], s["zone_selected"],
+                                                    zones), flush=True)
+            except KeyboardInterrupt:
+                pass
+            link.stream(0)
+        elif args.cmd == "check":
+            n = run_check(link)
+            print("check passed, %d telemetry samples" % n)
+    except (RuntimeError, TimeoutError, AssertionError) as e:
+        print("ctl_link: %s" % e, file=sys.stderr)
+        return 1
+    finally:
+        link.close()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
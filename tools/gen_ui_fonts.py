@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+"""
+Generate subsetted LVGL fonts for the knob UI.
+
+The UI strings in main/*.c that need glyphs are wrapped in marker comments:
+
+    /* ui-glyphs:begin <tag> */
+    ...string literals...
+    /* ui-glyphs:end */
+
+Every string literal between the markers is decoded and its characters are
+added to the glyph set of <tag>.  Each generated font pulls the union of the
+tags listed for it in FONTS below, so a size only carries the glyphs that
+are actually drawn with it.
+
+Fonts are produced with lv_font_conv (https://github.com/lvgl/lv_font_conv),
+taken from $LV_FONT_CONV, PATH or `npx lv_font_conv`.
+"""
+
+import argparse
+import os
+import re
+import shlex
+import shutil
+import subprocess
+import sys
+
+# name, pixel size, bpp, compressed bitmaps, kerning, glyph tags, extra text
+#
+# Small sizes stay uncompressed: RLE saves little on 12-16 px glyphs and
+# costs decode time on every draw.  The 28 px logo/lock font is drawn rarely
+# and compresses well.  Kerning is kept only where words are set large enough
+# for it to be visible; the 36 px speed readout is digits only.
+FONTS = [
+    ("ui_font_12", 12, 4, False, False, ("text",), ""),
+    ("ui_font_14", 14, 4, False, False, ("text",), ""),
+    ("ui_font_16", 16, 4, False, False, ("text",), ""),
+    ("ui_font_20", 20, 4, False, True, ("text",), ""),
+    ("ui_font_28", 28, 4, True, True, ("logo",), ""),
+    ("ui_font_36", 36, 4, False, False, (), "0123456789%"),
+]
+
+TEXT_FONT = "Montserrat-Medium.ttf"
+SYMBOL_FONT = "FontAwesome5-Solid+Brands+Regular.woff"
+
+# Codepoints Montserrat does not have, taken from the symbol font instead.
+SYMBOL_GLYPHS = {
+    0x1F512: 0xF023,  # lock
+}
+
+MARKER_RE = re.compile(r"/\*\s*ui-glyphs:begin\s+(\w+)\s*\*/(.*?)/\*\s*ui-glyphs:end\s*\*/", re.S)
+STRING_RE = re.compile(r'"((?:[^"\\\n]|\\.)*)"')
+
+
+def decode_c_string(body):
+    raw = bytearray()
+    i = 0
+    src = body.encode("utf-8")
+    while i < len(src):
+        c = src[i]
+        if c != 0x5C:  # backslash
+            raw.append(c)
+            i += 1
+            continue
+        i += 1
+        esc = chr(src[i])
+        if esc == "x":
+            m = re.match(rb"[0-9a-fA-F]+", src[i + 1:])
+            raw.append(int(m.group(0), 16) & 0xFF)
+            i += 1 + len(m.group(0))
+        elif esc in "01234567":
+            m = re.match(rb"[0-7]{1,3}", src[i:])
+            raw.append(int(m.group(0), 8) & 0xFF)
+            i += len(m.group(0))
+        else:
+            raw.extend({"n": b"\n", "t": b"\t", "r": b"\r"}.get(esc, esc.encode()))
+            i += 1
+    return raw.decode("utf-8")
+
+
+def scan_glyphs(sources):
+    tags = {}
+    for path in sources:
+        with open(path, encoding="utf-8") as f:
+            text = f.read()
+        for tag, block in MARKER_RE.findall(text):
+            chars = tags.setdefault(tag, set())
+            for literal in STRING_RE.findall(block):
+                chars.update(ch for ch in decode_c_string(literal) if ch >= " ")
+    return tags
+
+
+def font_conv_cmd():
+    env = os.environ.get("LV_FONT_CONV")
+    if env:
+        return shlex.split(env)
+    exe = shutil.which("lv_font_conv")
+    if exe:
+        return [exe]
+    return ["npx", "--yes", "lv_font_conv@1.5.2"]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--font-dir", required=True, help="directory holding %s and %s" % (TEXT_FONT, SYMBOL_FONT))
+    parser.add_argument("--out", required=True, help="output directory for ui_font_*.c")
+    parser.add_argument("--list", action="store_true", help="print the glyph set of every font and exit")
+    parser.add_argument("sources", nargs="+", help="C sources to scan")
+    args = parser.parse_args()
+
+    tags = scan_glyphs(args.sources)
+    os.makedirs(args.out, exist_ok=True)
+    conv = font_conv_cmd()
+
+    for name, size, bpp, compress, kerning, font_tags, extra in FONTS:
+        glyphs = set(extra)
+        for tag in font_tags:
+            if tag not in tags:
+                sys.exit("gen_ui_fonts: no strings tagged '%s' found" % tag)
+            glyphs |= tags[tag]
+        symbols = sorted(ord(ch) for ch in glyphs if ord(ch) in SYMBOL_GLYPHS)
+        text = "".join(sorted(ch for ch in glyphs if ord(ch) not in SYMBOL_GLYPHS))
+
+        if args.list:
+            print("%s: %d glyphs %r" % (name, len(glyphs), text))
+            continue
+
+        cmd = conv + ["--font", os.path.join(args.font_dir, TEXT_FONT), "--symbols", text]
+        if symbols:
+            cmd += ["--font", os.path.join(args.font_dir, SYMBOL_FONT)]
+            for cp in symbols:
+                src = SYMBOL_GLYPHS[cp]
+                cmd += ["--range", "0x%X-0x%X=>0x%X" % (src, src, cp)]
+        cmd += ["--size", str(size), "--bpp", str(bpp), "--format", "lvgl",
+                "--lv-include", "lvgl.h", "--lv-font-name", name,
+                "-o", os.path.join(args.out, name + ".c")]
+        if not compress:
+            cmd.append("--no-compress")
+        if not kerning:
+            cmd.append("--no-kerning")
+        subprocess.run(cmd, check=True)
+
+
+if __name__ == "__main__":
+    main()
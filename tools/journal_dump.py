@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""
+Decode the knob performance journal (main/perf_journal.h).
+
+Read the "journal" partition back from the device, then decode it:
+
+    parttool.py --port /dev/ttyACM0 read_partition --partition-name journal --output journal.bin
+    tools/journal_dump.py journal.bin
+    tools/journal_dump.py --last 3 journal.bin
+    tools/journal_dump.py --csv journal.bin > journal.csv
+
+Console command "journal" writes out the records still queued in RAM first.
+
+The partition is a ring of 4 KB sectors; each starts with a 16-byte header
+(magic "KNBJ", sequence number, boot, version, CRC-32) and holds 255 records
+of 16 bytes (type, check, boot, t_ms, a, b). Sectors are read oldest first by
+sequence number. Erased records are free; records failing the check are
+counted and skipped.
+"""
+
+import argparse
+import csv
+import struct
+import sys
+import zlib
+
+MAGIC = 0x4A424E4B
+VERSION = 1
+SECTOR_SIZE = 4096
+# Mirrors perf_journal_sector_t and perf_journal_record_t
+HEADER = struct.Struct("<IIHBBI")
+RECORD = struct.Struct("<BBHIII")
+
+BOOT = 1
+BOOT_STAGE = 2
+FRAME_OVER = 3
+I2C_ERROR = 4
+I2C_RECOVERED = 5
+DROPPED = 6
+
+TYPE_NAMES = {
+    BOOT: "boot",
+    BOOT_STAGE: "stage",
+    FRAME_OVER: "frame",
+    I2C_ERROR: "i2c_error",
+    I2C_RECOVERED: "i2c_ok",
+    DROPPED: "dropped",
+}
+
+# esp_reset_reason_t
+RESET_REASONS = ("unknown", "power-on", "external", "software", "panic", "interrupt watchdog", "task watchdog",
+                 "other watchdog", "deep sleep", "brownout", "sdio", "usb", "jtag", "efuse", "power glitch",
+                 "cpu lockup")
+# perf_journal_stage_t
+STAGES = ("storage", "fan", "panel", "touch", "lvgl", "ui", "services")
+# frame_phase_t, names as in the "frames" console command
+PHASES = ("render", "flush", "wait", "i2c", "nvs", "load", "jrnl")
+
+ESP_ERRORS = {
+    0x101: "ESP_ERR_NO_MEM",
+    0x102: "ESP_ERR_INVALID_ARG",
+    0x103: "ESP_ERR_INVALID_STATE",
+    0x107: "ESP_ERR_TIMEOUT",
+    -1: "ESP_FAIL",
+}
+
+
+def name(table, i):
+    return table[i] if 0 <= i < len(table) else "#%d" % i
+
+
+def read_journal(image):
+    """Records oldest first, and the number that failed the check."""
+    sectors = []
+    for off in range(0, len(image) - SECTOR_SIZE + 1, SECTOR_SIZE):
+        magic, seq, boot, version, _, crc = HEADER.unpack_from(image, off)
+        if magic == MAGIC and version == VERSION and crc == zlib.crc32(image[off:off + 12]):
+            sectors.append((seq, off))
+    sectors.sort()
+
+    records = []
+    bad = 0
+    for _, off in sectors:
+        for pos in range(off + HEADER.size, off + SECTOR_SIZE - RECORD.size + 1, RECORD.size):
+            raw = image[pos:pos + RECORD.size]
+            if raw == b"\xff" * RECORD.size:
+                continue
+            rtype, check, boot, t_ms, a, b = RECORD.unpack(raw)
+            if check != zlib.crc32(raw[:1] + b"\x00" + raw[2:]) & 0xFF:
+                bad += 1
+                continue
+            records.append({"boot": boot, "t_ms": t_ms, "type": rtype, "a": a, "b": b})
+    return records, bad
+
+
+def describe(rec):
+    a, b = rec["a"], rec["b"]
+    t = rec["type"]
+    if t == BOOT:
+        return "reset: %s, start-up %.1f ms" % (name(RESET_REASONS, a), b / 1000)
+    if t == BOOT_STAGE:
+        return "%s %.1f ms" % (name(STAGES, a), b / 1000)
+    if t == FRAME_OVER:
+        return "%.1f ms, longest %s %.1f ms" % (a / 1000, name(PHASES, b & 0xFF), (b >> 8) / 1000)
+    if t == I2C_ERROR:
+        err = struct.unpack("<i", struct.pack("<I", a))[0]
+        return "touch read failed: %s" % ESP_ERRORS.get(err, "0x%x" % a)
+    if t == I2C_RECOVERED:
+        return "touch back after %d failed reads, %d ms" % (a, b)
+    if t == DROPPED:
+        return "%d records lost, queue full" % a
+    return "a=%d b=%d" % (a, b)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("image", help="journal partition read back with parttool.py")
+    parser.add_argument("--last", type=int, metavar="N", help="only the last N boots")
+    parser.add_argument("--csv", action="store_true", help="one row per record instead of text")
+    args = parser.parse_args()
+
+    with open(args.image, "rb") as f:
+        records, bad = read_journal(f.read())
+    if args.last:
+        boots = []
+        for rec in records:
+            if not boots or boots[-1] != rec["boot"]:
+                boots.append(rec["boot"])
+        keep = set(boots[-args.last:])
+        records = [rec for rec in records if rec["boot"] in keep]
+
+    if args.csv:
+        out = csv.writer(sys.stdout)
+        out.writerow(("boot", "t_ms", "event", "a", "b", "detail"))
+        for rec in records:
+            out.writerow((rec["boot"], rec["t_ms"], TYPE_NAMES.get(rec["type"], rec["type"]), rec["a"], rec["b"],
+                          describe(rec)))
+    else:
+        boot = None
+        for rec in records:
+            if rec["boot"] != boot:
+                boot = rec["boot"]
+                print("boot %d" % boot)
+            print("%10.3f s  %-9s %s" % (rec["t_ms"] / 1000, TYPE_NAMES.get(rec["type"], rec["type"]), describe(rec)))
+    if bad:
+        print("%d damaged record(s) skipped" % bad, file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
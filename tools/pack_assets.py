@@ -0,0 +1,225 @@
+#!/usr/bin/env python3
+"""
+Build the image of the knob "assets" partition.
+
+Fonts are taken from the C files lv_font_conv writes (tools/gen_ui_fonts.py
+output) and repacked so that the firmware can hand their tables to LVGL
+straight from the memory-mapped partition, see main/assets.h. Images are
+converted with Pillow when given.
+
+    tools/pack_assets.py -o build/assets.bin build/esp-idf/main/ui_fonts/ui_font_*.c
+    tools/pack_assets.py -o assets.bin --image logo=logo.png:RGB565 fonts/*.c
+
+The build does this by itself when CONFIG_EXAMPLE_UI_ASSETS is set. To
+update the assets alone, without relinking or reflashing the app:
+
+    idf.py assets-flash
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+import zlib
+
+MAGIC = 0x41424E4B  # "KNBA"
+VERSION = 1
+NAME_LEN = 20
+
+TYPE_FONT = 1
+TYPE_IMAGE = 2
+
+HEADER = struct.Struct("<IHHII")
+ENTRY = struct.Struct("<%dsB3xII" % NAME_LEN)
+FONT = struct.Struct("<HHbbBBHBBIIII")
+CMAP = struct.Struct("<IHHIIHBx")
+KERN = struct.Struct("<IIIIBBBx")
+GLYPH_DSC = struct.Struct("<IBBbb")
+
+CMAP_TYPES = {
+    "LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL": 0,
+    "LV_FONT_FMT_TXT_CMAP_SPARSE_FULL": 1,
+    "LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY": 2,
+    "LV_FONT_FMT_TXT_CMAP_SPARSE_TINY": 3,
+}
+
+# lv_color_format_t value, bytes per pixel, Pillow mode
+IMAGE_FORMATS = {
+    "A8": (0x0E, 1, "L"),
+    "RGB565": (0x12, 2, "RGB"),
+    "ARGB8888": (0x10, 4, "RGBA"),
+}
+LV_IMAGE_HEADER_MAGIC = 0x19
+
+COMMENT_RE = re.compile(r"/\*.*?\*/|//[^\n]*", re.S)
+ARRAY_RE = re.compile(r"\b(u?int(8|16|32)_t)\s+(\w+)\s*\[\]\s*=\s*\{(.*?)\}\s*;", re.S)
+GLYPH_RE = re.compile(r"\{\s*(\.bitmap_index\s*=.*?)\}", re.S)
+CMAP_RE = re.compile(r"\{\s*(\.range_start\s*=.*?)\}", re.S)
+FIELD_RE = re.compile(r"\.(\w+)\s*=\s*([^,}\n]+)")
+FONT_NAME_RE = re.compile(r"\blv_font_t\s+(\w+)\s*=")
+
+
+def fields(text):
+    return {k: v.strip() for k, v in FIELD_RE.findall(text)}
+
+
+def c_int(value):
+    return int(value.rstrip("uUlL"), 0)
+
+
+def align4(buf):
+    buf.extend(b"\0" * (-len(buf) % 4))
+
+
+class Blob:
+    """Font blob under construction; tables are appended 4-byte aligned."""
+
+    def __init__(self):
+        self.data = bytearray(b"\0" * FONT.size)
+
+    def add(self, payload):
+        align4(self.data)
+        offset = len(self.data)
+        self.data += payload
+        return offset
+
+
+def pack_array(arrays, name):
+    ctype, values = arrays[name]
+    fmt = {"uint8_t": "B", "int8_t": "b", "uint16_t": "H", "int16_t": "h", "uint32_t": "I", "int32_t": "i"}[ctype]
+    return struct.pack("<%d%s" % (len(values), fmt), *values)
+
+
+def pack_font(path):
+    with open(path, encoding="utf-8") as f:
+        src = COMMENT_RE.sub("", f.read())
+
+    m = FONT_NAME_RE.search(src)
+    if not m:
+        sys.exit("%s: no lv_font_t found" % path)
+    name = m.group(1)
+
+    arrays = {}
+    for m in ARRAY_RE.finditer(src):
+        values = [c_int(v) for v in m.group(4).replace("\n", " ").split(",") if v.strip()]
+        arrays[m.group(3)] = (m.group(1), values)
+    props = fields(src[src.index("font_dsc"):])
+    props.update(fields(src[src.index("lv_font_t " + name):]))
+
+    blob = Blob()
+    glyph_bitmap = blob.add(pack_array(arrays, "glyph_bitmap"))
+
+    glyphs = bytearray()
+    for m in GLYPH_RE.finditer(src):
+        g = {k: c_int(v) for k, v in fields(m.group(1)).items()}
+        if g["bitmap_index"] >= 1 << 20 or g["adv_w"] >= 1 << 12:
+            sys.exit("%s: glyph does not fit the compact descriptor" % path)
+        glyphs += GLYPH_DSC.pack(g["bitmap_index"] | g["adv_w"] << 20, g["box_w"], g["box_h"], g["ofs_x"], g["ofs_y"])
+    glyph_dsc = blob.add(glyphs)
+
+    cmap_records = []
+    for m in CMAP_RE.finditer(src):
+        c = fields(m.group(1))
+        lists = []
+        for key in ("unicode_list", "glyph_id_ofs_list"):
+            lists.append(0 if c[key] == "NULL" else blob.add(pack_array(arrays, c[key])))
+        cmap_records.append(CMAP.pack(c_int(c["range_start"]), c_int(c["range_length"]), c_int(c["glyph_id_start"]),
+                                      lists[0], lists[1], c_int(c["list_length"]), CMAP_TYPES[c["type"]]))
+    cmaps = blob.add(b"".join(cmap_records))
+
+    kern_type = 0
+    kern = 0
+    kern_dsc = props.get("kern_dsc", "NULL")
+    if kern_dsc == "&kern_pairs":
+        kern_type = 1
+        p = fields(src[src.index("kern_pairs ="):])
+        ids = blob.add(pack_array(arrays, p["glyph_ids"]))
+        values = blob.add(pack_array(arrays, p["values"]))
+        kern = blob.add(KERN.pack(values, ids, 0, c_int(p["pair_cnt"]), 0, 0, c_int(p["glyph_ids_size"])))
+    elif kern_dsc == "&kern_classes":
+        kern_type = 2
+        k = fields(src[src.index("kern_classes ="):])
+        values = blob.add(pack_array(arrays, k["class_pair_values"]))
+        left = blob.add(pack_array(arrays, k["left_class_mapping"]))
+        right = blob.add(pack_array(arrays, k["right_class_mapping"]))
+        kern = blob.add(KERN.pack(values, left, right, 0, c_int(k["left_class_cnt"]), c_int(k["right_class_cnt"]), 0))
+    elif kern_dsc != "NULL":
+        sys.exit("%s: unknown kern_dsc %s" % (path, kern_dsc))
+
+    if len(cmap_records) != c_int(props["cmap_num"]):
+        sys.exit("%s: found %d of %s cmaps" % (path, len(cmap_records), props["cmap_num"]))
+    FONT.pack_into(blob.data, 0, c_int(props["line_height"]), c_int(props["base_line"]),
+                   c_int(props.get("underline_position", "0")), c_int(props.get("underline_thickness", "0")),
+                   c_int(props["bpp"]), c_int(props.get("bitmap_format", "0")), c_int(props.get("kern_scale", "0")),
+                   kern_type, len(cmap_records), glyph_bitmap, glyph_dsc, cmaps, kern)
+    return name, TYPE_FONT, bytes(blob.data)
+
+
+def pack_image(spec):
+    name, _, rest = spec.partition("=")
+    path, _, cf_name = rest.partition(":")
+    cf, bpp, mode = IMAGE_FORMATS[cf_name or "RGB565"]
+    from PIL import Image  # only needed for images
+    img = Image.open(path).convert(mode)
+    w, h = img.size
+    if mode == "RGB":
+        pixels = bytearray()
+        for r, g, b in img.getdata():
+            pixels += struct.pack("<H", (r >> 3) << 11 | (g >> 2) << 5 | b >> 3)
+    elif mode == "RGBA":
+        # LVGL stores ARGB8888 as B, G, R, A in memory
+        pixels = bytearray()
+        for r, g, b, a in img.getdata():
+            pixels += bytes((b, g, r, a))
+    else:
+        pixels = bytes(img.getdata())
+    header = struct.pack("<BBHHHHH", LV_IMAGE_HEADER_MAGIC, cf, 0, w, h, w * bpp, 0)
+    return name, TYPE_IMAGE, header + bytes(pixels)
+
+
+def build(assets):
+    assets.sort(key=lambda a: a[0].encode())
+    names = [a[0] for a in assets]
+    if len(set(names)) != len(names):
+        sys.exit("pack_assets: duplicate asset names")
+
+    offset = HEADER.size + ENTRY.size * len(assets)
+    table = bytearray()
+    body = bytearray()
+    for name, kind, data in assets:
+        if len(name.encode()) > NAME_LEN:
+            sys.exit("pack_assets: name '%s' longer than %d bytes" % (name, NAME_LEN))
+        pad = -(offset + len(body)) % 4
+        body += b"\0" * pad
+        table += ENTRY.pack(name.encode(), kind, offset + len(body), len(data))
+        body += data
+    payload = bytes(table + body)
+    return HEADER.pack(MAGIC, VERSION, len(assets), HEADER.size + len(payload), zlib.crc32(payload)) + payload
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-o", "--out", required=True, help="partition image to write")
+    parser.add_argument("--size", type=lambda v: int(v, 0), help="partition size; fail if the pack is larger")
+    parser.add_argument("--image", action="append", default=[], metavar="NAME=FILE[:CF]",
+                        help="add an image, CF is one of %s (default RGB565)" % ", ".join(IMAGE_FORMATS))
+    parser.add_argument("fonts", nargs="*", help="lv_font_conv C output")
+    args = parser.parse_args()
+
+    assets = [pack_font(path) for path in args.fonts] + [pack_image(spec) for spec in args.image]
+    image = build(assets)
+    if args.size is not None and len(image) > args.size:
+        sys.exit("pack_assets: %d bytes do not fit the %d byte partition" % (len(image), args.size))
+
+    os.makedirs(os.path.dirname(os.path.abspath(args.out)), exist_ok=True)
+    with open(args.out, "wb") as f:
+        f.write(image)
+    for name, _, data in assets:
+        print("  %-20s %8d" % (name, len(data)))
+    print("%s: %d assets, %d bytes" % (args.out, len(assets), len(image)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
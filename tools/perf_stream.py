@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""
+Decode the binary sample stream of the knob perf console into CSV.
+
+On the device console (USB-Serial-JTAG):
+
+    knob> stream 100
+
+then run this script on the same port, or on a capture of it:
+
+    tools/perf_stream.py --port /dev/ttyACM0 --start 100 > perf.csv
+    tools/perf_stream.py capture.bin > perf.csv
+
+A frame is 0xA5 0x5A, a length byte, the little-endian perf_console_sample_t
+(main/perf_console.h) and a Fletcher-16 over the length byte and the sample.
+Console text between frames is skipped. The CSV goes to any plotting tool.
+
+The serial port needs pyserial.
+"""
+
+import argparse
+import struct
+import sys
+
+SYNC = b"\xa5\x5a"
+# Mirrors perf_console_sample_t
+SAMPLE = struct.Struct("<HIHHHBBIIHH")
+FIELDS = ("seq", "t_ms", "fps", "render_us", "flush_us", "cpu0_pct", "cpu1_pct",
+          "lv_heap_free", "qspi_bytes", "i2c_reads", "latency_p99_us")
+
+
+def fletcher16(data):
+    a = b = 0
+    for byte in data:
+        a = (a + byte) % 255
+        b = (b + a) % 255
+    return (b << 8) | a
+
+
+def frames(read):
+    """Yield sample tuples from a byte source, resyncing on garbage."""
+    buf = bytearray()
+    while True:
+        chunk = read(256)
+        if not chunk:
+            return
+        buf += chunk
+        while True:
+            start = buf.find(SYNC)
+            if start < 0:
+                del buf[:-1]
+                break
+            del buf[:start]
+            if len(buf) < 3:
+                break
+            length = buf[2]
+            if length != SAMPLE.size:
+                del buf[:1]
+                continue
+            end = 3 + length + 2
+            if len(buf) < end:
+                break
+            body = bytes(buf[2:3 + length])
+            (check,) = struct.unpack_from("<H", buf, 3 + length)
+            if fletcher16(body) != check:
+                del buf[:1]
+                continue
+            yield SAMPLE.unpack(body[1:])
+            del buf[:end]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", nargs="?", help="raw capture file (default: stdin)")
+    parser.add_argument("--port", help="serial port of the device console")
+    parser.add_argument("--start", type=int, metavar="MS", help="send 'stream MS' first")
+    args = parser.parse_args()
+
+    if args.port:
+        import serial
+        src = serial.Serial(args.port, 115200)
+        if args.start:
+            src.write(b"stream %d\r\n" % args.start)
+
+        def read(size):
+            # Block for the first byte only, then take whatever has arrived
+            data = src.read(1)
+            return data + src.read(min(src.in_waiting, size))
+    elif args.capture:
+        read = open(args.capture, "rb").read
+    else:
+        read = sys.stdin.buffer.read1
+
+    print(",".join(FIELDS))
+    last_seq = None
+    try:
+        for sample in frames(read):
+            seq = sample[0]
+            if last_seq is not None and seq != (last_seq + 1) & 0xFFFF:
+                print(f"lost {(seq - last_seq - 1) & 0xFFFF} samples before seq {seq}", file=sys.stderr)
+            last_seq = seq
+            row = list(sample)
+            row[2] = f"{sample[2] / 10:.1f}"
+            print(",".join(str(v) for v in row), flush=True)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if args.port:
+            src.write(b"stream off\r\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
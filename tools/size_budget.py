@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+"""
+Size and IRAM budget report for the knob firmware.
+
+Reads the linker map of a build and prints:
+
+  - the size of the main output sections (IRAM, DRAM, flash)
+  - the largest IRAM users by archive
+  - the hot path placed by main/linker.lf and LV_ATTRIBUTE_FAST_MEM, that is
+    whatever libmain.a, the CST820 driver and LVGL put into IRAM
+
+and exits with 1 when the hot path or the IRAM total is over budget, so the
+placement cannot grow unnoticed:
+
+    tools/size_budget.py build/viewe_knob_touch.map
+    tools/size_budget.py --hot-budget 40960 --iram-budget 131072 build/viewe_knob_touch.map
+"""
+
+import argparse
+import collections
+import re
+import sys
+
+SECTIONS = (".iram0.vectors", ".iram0.text", ".dram0.data", ".dram0.bss", ".flash.text", ".flash.rodata",
+            ".ext_ram.bss")
+IRAM_SECTIONS = (".iram0.vectors", ".iram0.text")
+HOT_ARCHIVES = ("libmain.a", "libviewe__esp_lcd_touch_cst820.a", "liblvgl__lvgl.a")
+
+DEFAULT_HOT_BUDGET = 32 * 1024
+
+OUT_RE = re.compile(r"^(\.\S+)(?:\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+))?\s*$")
+IN_RE = re.compile(r"^ (\.\S+|COMMON)(?:\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(\S.*))?$")
+CONT_RE = re.compile(r"^\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(\S.*)$")
+OBJ_RE = re.compile(r"(?:.*/)?([^/(]+\.a)\(([^)]+)\)$")
+
+
+def parse_map(path):
+    """Return ({output section: size}, [(output section, archive, object, size)])."""
+    sections = {}
+    inputs = []
+    out_name = None
+    pending_in = None
+    pending_out = None
+    in_memory_map = False
+
+    with open(path, errors="replace") as f:
+        for line in f:
+            line = line.rstrip("\n")
+            if line.startswith("Linker script and memory map"):
+                in_memory_map = True
+                continue
+            if not in_memory_map:
+                continue
+
+            if pending_out:
+                m = CONT_RE.match(line) or re.match(r"^\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s*$", line)
+                if m:
+                    sections[pending_out] = int(m.group(2), 16)
+                pending_out = None
+                continue
+            if pending_in:
+                m = CONT_RE.match(line)
+                if m:
+                    inputs.append(make_input(out_name, int(m.group(2), 16), m.group(3)))
+                pending_in = None
+                continue
+
+            m = OUT_RE.match(line)
+            if m:
+                out_name = m.group(1)
+                if m.group(3):
+                    sections[out_name] = int(m.group(3), 16)
+                else:
+                    pending_out = out_name
+                continue
+
+            m = IN_RE.match(line)
+            if m and out_name:
+                if m.group(3):
+                    inputs.append(make_input(out_name, int(m.group(3), 16), m.group(4)))
+                else:
+                    pending_in = m.group(1)
+    return sections, inputs
+
+
+def make_input(out_name, size, obj):
+    m = OBJ_RE.match(obj.strip())
+    if m:
+        return out_name, m.group(1), m.group(2), size
+    return out_name, "(objects)", obj.strip().rsplit("/", 1)[-1], size
+
+
+def kib(n):
+    return f"{n / 1024:8.1f} KB"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("map", help="linker map, build/<project>.map")
+    parser.add_argument("--hot-budget", type=int, default=DEFAULT_HOT_BUDGET,
+                        help="bytes of IRAM the hot path may take (default %(default)s)")
+    parser.add_argument("--iram-budget", type=int, help="bytes of IRAM (vectors and text) allowed in total")
+    parser.add_argument("--top", type=int, default=12, help="archives to list (default %(default)s)")
+    args = parser.parse_args()
+
+    sections, inputs = parse_map(args.map)
+    if not sections:
+        print(f"{args.map}: no memory map found", file=sys.stderr)
+        return 2
+
+    print("Sections")
+    for name in SECTIONS:
+        if name in sections:
+            print(f"  {name:<16}{kib(sections[name])}")
+
+    iram = collections.Counter()
+    for out, archive, _, size in inputs:
+        if out in IRAM_SECTIONS:
+            iram[archive] += size
+    print(f"\nIRAM by archive (top {args.top})")
+    for archive, size in iram.most_common(args.top):
+        print(f"  {archive:<40}{kib(size)}")
+
+    hot = collections.Counter()
+    for out, archive, obj, size in inputs:
+        if out in IRAM_SECTIONS and archive in HOT_ARCHIVES:
+            hot[(archive, obj)] += size
+    hot_total = sum(hot.values())
+    print("\nHot path in IRAM")
+    for (archive, obj), size in sorted(hot.items(), key=lambda kv: -kv[1]):
+        print(f"  {archive + ':' + obj:<56}{kib(size)}")
+    print(f"  {'total':<56}{kib(hot_total)}  budget {kib(args.hot_budget).strip()}")
+
+    failed = False
+    if hot_total > args.hot_budget:
+        print(f"\nhot path over budget by {hot_total - args.hot_budget} bytes", file=sys.stderr)
+        failed = True
+    iram_total = sum(sections.get(name, 0) for name in IRAM_SECTIONS)
+    if args.iram_budget is not None and iram_total > args.iram_budget:
+        print(f"\nIRAM over budget by {iram_total - args.iram_budget} bytes", file=sys.stderr)
+        failed = True
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())